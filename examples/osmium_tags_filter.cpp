@@ -9,6 +9,7 @@
   * file types
   * Osmium buffers
   * Tags filter
+  * Object filter
 
   SIMPLER EXAMPLES you might want to understand first:
   * osmium_convert
@@ -22,6 +23,7 @@
 #include <exception> // for std::exception
 #include <iostream>  // for std::cout, std::cerr
 #include <string>    // for std::string
+#include <utility>   // for std::move
 
 // Allow any format of input files (XML, PBF, ...)
 #include <osmium/io/any_input.hpp>
@@ -29,7 +31,7 @@
 // Allow any format of output files (XML, PBF, ...)
 #include <osmium/io/any_output.hpp>
 
-#include <osmium/tags/taglist.hpp>
+#include <osmium/io/object_filter.hpp>
 #include <osmium/tags/tags_filter.hpp>
 
 void print_help() {
@@ -125,8 +127,23 @@ int main(int argc, char* argv[]) {
     }
 
     try {
+        // Match highway=primary or highway=secondary
+        osmium::TagsFilter filter1{false};
+        filter1.add_rule(true, "highway", "primary");
+        filter1.add_rule(true, "highway", "secondary");
+
+        // Match oneway=yes
+        osmium::TagsFilter filter2{false};
+        filter2.add_rule(true, "oneway", "yes");
+
+        // Get all objects matching both filters. The filters are applied
+        // by the parser while decoding the input, so objects not matching
+        // are never added to the buffers we get from the reader.
+        osmium::io::object_filter object_filter;
+        object_filter.tags(filter1).tags(filter2);
+
         // Initialize Reader
-        osmium::io::Reader reader{input_file};
+        osmium::io::Reader reader{input_file, object_filter};
 
         // Get header from input file and change the "generator" setting to
         // ourselves.
@@ -137,23 +154,9 @@ int main(int argc, char* argv[]) {
         // is allowed to overwrite a possibly existing file.
         osmium::io::Writer writer{output_file, header, osmium::io::overwrite::allow};
 
-        // Match highway=primary or highway=secondary
-        osmium::TagsFilter filter1{false};
-        filter1.add_rule(true, "highway", "primary");
-        filter1.add_rule(true, "highway", "secondary");
-
-        // Match oneway=yes
-        osmium::TagsFilter filter2{false};
-        filter2.add_rule(true, "oneway", "yes");
-
-        // Get all object matching both filters
+        // Write out all objects
         while (osmium::memory::Buffer buffer = reader.read()) { // NOLINT(bugprone-use-after-move) Bug in clang-tidy https://bugs.llvm.org/show_bug.cgi?id=36516
-            for (const auto& object : buffer.select<osmium::OSMObject>()) {
-                if (osmium::tags::match_any_of(object.tags(), filter1) &&
-                    osmium::tags::match_any_of(object.tags(), filter2)) {
-                    writer(object);
-                }
-            }
+            writer(std::move(buffer));
         }
 
         // Explicitly close the writer and reader. Will throw an exception if
@@ -36,10 +36,12 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/area/assembler_config.hpp>
 #include <osmium/area/detail/node_ref_segment.hpp>
 #include <osmium/area/detail/proto_ring.hpp>
+#include <osmium/area/detail/segment_index.hpp>
 #include <osmium/area/detail/segment_list.hpp>
 #include <osmium/area/problem_reporter.hpp>
 #include <osmium/area/stats.hpp>
 #include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/memory/arena.hpp>
 #include <osmium/osm/location.hpp>
 #include <osmium/osm/node_ref.hpp>
 #include <osmium/osm/types.hpp>
@@ -52,9 +54,11 @@ DEALINGS IN THE SOFTWARE.
 #include <cstdint>
 #include <cstdlib>
 #include <exception>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <list>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -66,7 +70,64 @@ namespace osmium {
 
         namespace detail {
 
-            using open_ring_its_type = std::list<std::list<ProtoRing>::iterator>;
+            using proto_ring_list_type = std::list<ProtoRing, osmium::memory::ArenaAllocator<ProtoRing>>;
+
+            using open_ring_its_type = std::list<proto_ring_list_type::iterator>;
+
+            /**
+             * Gives an assembler the use of an arena for its scratch data.
+             * Each thread has one arena which is reused by all assemblers
+             * running one after the other in this thread, so the memory for
+             * segments, rings, etc. doesn't have to be allocated from the
+             * heap again for each area. If the arena of this thread is
+             * already used by another assembler, a new arena is created.
+             * The arena is reset when the lease ends.
+             */
+            class arena_lease {
+
+                struct thread_arena {
+                    osmium::memory::Arena arena{};
+                    bool in_use = false;
+                };
+
+                static thread_arena& get_thread_arena() {
+                    static thread_local thread_arena arena;
+                    return arena;
+                }
+
+                thread_arena* m_thread_arena = nullptr;
+                std::unique_ptr<osmium::memory::Arena> m_own_arena{};
+
+            public:
+
+                arena_lease() {
+                    thread_arena& ta = get_thread_arena();
+                    if (ta.in_use) {
+                        m_own_arena.reset(new osmium::memory::Arena{});
+                    } else {
+                        ta.in_use = true;
+                        m_thread_arena = &ta;
+                    }
+                }
+
+                arena_lease(const arena_lease&) = delete;
+                arena_lease& operator=(const arena_lease&) = delete;
+
+                arena_lease(arena_lease&&) = delete;
+                arena_lease& operator=(arena_lease&&) = delete;
+
+                ~arena_lease() noexcept {
+                    if (m_thread_arena) {
+                        m_thread_arena->arena.reset();
+                        m_thread_arena->in_use = false;
+                    }
+                }
+
+                osmium::memory::Arena* get() const noexcept {
+                    return m_thread_arena ? &m_thread_arena->arena : m_own_arena.get();
+                }
+
+            }; // class arena_lease
 
             struct location_to_ring_map {
                 osmium::Location location;
@@ -106,6 +167,10 @@ namespace osmium {
 
                 static constexpr const std::size_t max_split_locations = 100ULL;
 
+                // Segment lists with at least this many segments use a
+                // SegmentIndex when looking for enclosing rings.
+                static constexpr const std::size_t min_segments_for_index = 256ULL;
+
                 // Maximum recursion depth, stops complex multipolygons from
                 // breaking everything.
                 enum : unsigned {
@@ -153,17 +218,25 @@ namespace osmium {
                 // Configuration settings for this Assembler
                 const AssemblerConfig& m_config;
 
+                // Arena for all the scratch data below. Must be declared
+                // before the containers using it.
+                arena_lease m_arena;
+
                 // List of segments (connection between two nodes)
                 SegmentList m_segment_list;
 
+                // Index over x ranges of segments, only used for large
+                // segment lists
+                SegmentIndex m_segment_index;
+
                 // The rings we are building from the segments
-                std::list<ProtoRing> m_rings;
+                proto_ring_list_type m_rings;
 
                 // All node locations
-                std::vector<slocation> m_locations;
+                std::vector<slocation, osmium::memory::ArenaAllocator<slocation>> m_locations;
 
                 // All locations where more than two segments start/end
-                std::vector<Location> m_split_locations;
+                std::vector<Location, osmium::memory::ArenaAllocator<Location>> m_split_locations;
 
                 // Statistics
                 area_stats m_stats;
@@ -185,8 +258,13 @@ namespace osmium {
                         std::cerr << "    Checking inner/outer roles\n";
                     }
 
-                    std::unordered_map<const osmium::Way*, const ProtoRing*> way_rings;
-                    std::unordered_set<const osmium::Way*> ways_in_multiple_rings;
+                    using way_rings_allocator = osmium::memory::ArenaAllocator<std::pair<const osmium::Way* const, const ProtoRing*>>;
+                    using ways_allocator = osmium::memory::ArenaAllocator<const osmium::Way*>;
+
+                    std::unordered_map<const osmium::Way*, const ProtoRing*, std::hash<const osmium::Way*>, std::equal_to<const osmium::Way*>, way_rings_allocator>
+                        way_rings{0, std::hash<const osmium::Way*>{}, std::equal_to<const osmium::Way*>{}, way_rings_allocator{m_arena.get()}};
+                    std::unordered_set<const osmium::Way*, std::hash<const osmium::Way*>, std::equal_to<const osmium::Way*>, ways_allocator>
+                        ways_in_multiple_rings{0, std::hash<const osmium::Way*>{}, std::equal_to<const osmium::Way*>{}, ways_allocator{m_arena.get()}};
 
                     for (const ProtoRing& ring : m_rings) {
                         for (const auto& segment : ring.segments()) {
@@ -278,7 +356,7 @@ namespace osmium {
 
                 }; // class rings_stack_element
 
-                using rings_stack = std::vector<rings_stack_element>;
+                using rings_stack = std::vector<rings_stack_element, osmium::memory::ArenaAllocator<rings_stack_element>>;
 
                 static void remove_duplicates(rings_stack& outer_rings) {
                     while (true) {
@@ -290,28 +368,49 @@ namespace osmium {
                     }
                 }
 
-                ProtoRing* find_enclosing_ring(NodeRefSegment* segment) {
+                /**
+                 * Call func for all segments from the given one back to the
+                 * first segment in the list in descending order. If the
+                 * segment index was built, segments ending left of x are
+                 * skipped.
+                 */
+                template <typename TFunc>
+                void for_each_segment_before(NodeRefSegment* segment, int32_t x, TFunc&& func) {
+                    const auto last = static_cast<std::size_t>(segment - &m_segment_list.front());
+
+                    if (m_segment_index.empty()) {
+                        for (std::size_t n = last + 1; n > 0; --n) {
+                            func(&m_segment_list[n - 1]);
+                        }
+                        return;
+                    }
+
+                    m_segment_index.for_each_reverse(last, x, [&](std::size_t n) {
+                        func(&m_segment_list[n]);
+                    });
+                }
+
+                ProtoRing* find_enclosing_ring(NodeRefSegment* start_segment) {
                     if (debug()) {
-                        std::cerr << "    Looking for ring enclosing " << *segment << "\n";
+                        std::cerr << "    Looking for ring enclosing " << *start_segment << "\n";
                     }
 
-                    const auto location = segment->first().location();
-                    const auto end_location = segment->second().location();
+                    const auto location = start_segment->first().location();
+                    const auto end_location = start_segment->second().location();
 
-                    while (segment->first().location() == location) {
-                        if (segment == &m_segment_list.back()) {
+                    while (start_segment->first().location() == location) {
+                        if (start_segment == &m_segment_list.back()) {
                             break;
                         }
-                        ++segment;
+                        ++start_segment;
                     }
 
                     int nesting = 0;
 
-                    rings_stack outer_rings;
-                    while (segment >= &m_segment_list.front()) {
+                    rings_stack outer_rings{osmium::memory::ArenaAllocator<rings_stack_element>{m_arena.get()}};
+                    for_each_segment_before(start_segment, location.x(), [&](NodeRefSegment* segment) {
                         if (!segment->is_direction_done()) {
-                            --segment;
-                            continue;
+                            return;
                         }
                         if (debug()) {
                             std::cerr << "      Checking against " << *segment << "\n";
@@ -370,8 +469,7 @@ namespace osmium {
                                 }
                             }
                         }
-                        --segment;
-                    }
+                    });
 
                     if (nesting % 2 == 0) {
                         if (debug()) {
@@ -427,7 +525,7 @@ namespace osmium {
                     }
                     segment->mark_direction_done();
 
-                    m_rings.emplace_back(segment);
+                    m_rings.emplace_back(segment, m_arena.get());
                     ProtoRing* ring = &m_rings.back();
                     if (outer_ring) {
                         if (debug()) {
@@ -478,7 +576,7 @@ namespace osmium {
                         segment->reverse();
                     }
 
-                    m_rings.emplace_back(segment);
+                    m_rings.emplace_back(segment, m_arena.get());
                     ProtoRing* ring = &m_rings.back();
 
                     const osmium::Location& first_location = node.location(m_segment_list);
@@ -522,8 +620,18 @@ namespace osmium {
                         m_locations.emplace_back(n, true);
                     }
 
-                    std::stable_sort(m_locations.begin(), m_locations.end(), [this](const slocation& lhs, const slocation& rhs) {
-                        return lhs.location(m_segment_list) < rhs.location(m_segment_list);
+                    // Same order as a stable sort by location, but without
+                    // the temporary buffer std::stable_sort() allocates.
+                    std::sort(m_locations.begin(), m_locations.end(), [this](const slocation& lhs, const slocation& rhs) {
+                        const auto lhs_location = lhs.location(m_segment_list);
+                        const auto rhs_location = rhs.location(m_segment_list);
+                        if (lhs_location != rhs_location) {
+                            return lhs_location < rhs_location;
+                        }
+                        if (lhs.item != rhs.item) {
+                            return lhs.item < rhs.item;
+                        }
+                        return lhs.reverse < rhs.reverse;
                     });
                 }
 
@@ -541,7 +649,7 @@ namespace osmium {
                     if (debug()) {
                         std::cerr << "  Finding inner/outer rings\n";
                     }
-                    std::vector<ProtoRing*> rings;
+                    std::vector<ProtoRing*, osmium::memory::ArenaAllocator<ProtoRing*>> rings{osmium::memory::ArenaAllocator<ProtoRing*>{m_arena.get()}};
                     rings.reserve(m_rings.size());
                     for (auto& ring : m_rings) {
                         if (ring.closed()) {
@@ -993,7 +1101,7 @@ namespace osmium {
 
             protected:
 
-                const std::list<ProtoRing>& rings() const noexcept {
+                const proto_ring_list_type& rings() const noexcept {
                     return m_rings;
                 }
 
@@ -1067,6 +1175,13 @@ namespace osmium {
                         return false;
                     }
 
+                    // For large multipolygons index the x ranges of all
+                    // segments so we don't have to look at all of them when
+                    // figuring out which rings are inside which other rings.
+                    if (m_segment_list.size() >= min_segments_for_index) {
+                        m_segment_index.build(m_segment_list);
+                    }
+
                     // This creates an ordered list of locations of both endpoints
                     // of all segments with pointers back to the segments. We will
                     // use this list later to quickly find which segment(s) fits
@@ -1189,7 +1304,10 @@ namespace osmium {
 
                 explicit BasicAssembler(const config_type& config) :
                     m_config(config),
-                    m_segment_list(config.debug_level > 1) {
+                    m_segment_list(config.debug_level > 1, m_arena.get()),
+                    m_rings(osmium::memory::ArenaAllocator<ProtoRing>{m_arena.get()}),
+                    m_locations(osmium::memory::ArenaAllocator<slocation>{m_arena.get()}),
+                    m_split_locations(osmium::memory::ArenaAllocator<Location>{m_arena.get()}) {
 #ifdef OSMIUM_WITH_TIMER
                     init_header();
 #endif
@@ -34,6 +34,7 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/area/detail/node_ref_segment.hpp>
+#include <osmium/memory/arena.hpp>
 #include <osmium/osm/location.hpp>
 #include <osmium/osm/node_ref.hpp>
 
@@ -59,16 +60,18 @@ namespace osmium {
 
             public:
 
-                using segments_type = std::vector<NodeRefSegment*>;
+                using segments_type = std::vector<NodeRefSegment*, osmium::memory::ArenaAllocator<NodeRefSegment*>>;
+
+                using inner_rings_type = std::vector<ProtoRing*, osmium::memory::ArenaAllocator<ProtoRing*>>;
 
             private:
 
                 // Segments in this ring.
-                segments_type m_segments{};
+                segments_type m_segments;
 
                 // If this is an outer ring, these point to it's inner rings
                 // (if any).
-                std::vector<ProtoRing*> m_inner{};
+                inner_rings_type m_inner;
 
                 // The smallest segment. Will be kept current whenever a new
                 // segment is added to the ring.
@@ -90,7 +93,16 @@ namespace osmium {
 
             public:
 
-                explicit ProtoRing(NodeRefSegment* segment) noexcept :
+                /**
+                 * Construct a ProtoRing starting with the given segment.
+                 *
+                 * @param segment First segment of the ring.
+                 * @param arena Optional arena to allocate the segment and
+                 *              inner ring lists from.
+                 */
+                explicit ProtoRing(NodeRefSegment* segment, osmium::memory::Arena* arena = nullptr) :
+                    m_segments(osmium::memory::ArenaAllocator<NodeRefSegment*>{arena}),
+                    m_inner(osmium::memory::ArenaAllocator<ProtoRing*>{arena}),
                     m_min_segment(segment)
 #ifdef OSMIUM_DEBUG_RING_NO
                     , m_num(next_num())
@@ -123,7 +135,7 @@ namespace osmium {
                     m_outer_ring = outer_ring;
                 }
 
-                const std::vector<ProtoRing*>& inner_rings() const noexcept {
+                const inner_rings_type& inner_rings() const noexcept {
                     return m_inner;
                 }
 
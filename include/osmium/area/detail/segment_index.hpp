@@ -0,0 +1,136 @@
+#ifndef OSMIUM_AREA_DETAIL_SEGMENT_INDEX_HPP
+#define OSMIUM_AREA_DETAIL_SEGMENT_INDEX_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/area/detail/segment_list.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace osmium {
+
+    namespace area {
+
+        namespace detail {
+
+            /**
+             * Index over the x ranges of the segments in a sorted
+             * SegmentList. It is a static segment tree storing the maximum
+             * x coordinate of the second location for each range of
+             * segments. Because the segments are sorted by their first
+             * location, this can be used to quickly find all segments
+             * before a given segment that might cross the vertical line
+             * through some location.
+             *
+             * The segment list must not be changed after the index was
+             * built. Reversing segments is fine, the first and second
+             * location of a segment never change.
+             */
+            class SegmentIndex {
+
+                // Maximum x of second location in each subtree. Leaves are
+                // at m_leaves ... 2 * m_leaves - 1.
+                std::vector<int32_t> m_max_x{};
+
+                std::size_t m_leaves = 0;
+
+                template <typename TFunc>
+                void visit(std::size_t node, std::size_t begin, std::size_t end, std::size_t last, int32_t x, TFunc& func) const {
+                    if (begin > last || m_max_x[node] < x) {
+                        return;
+                    }
+
+                    if (node >= m_leaves) {
+                        func(begin);
+                        return;
+                    }
+
+                    const std::size_t middle = begin + (end - begin) / 2;
+                    visit(node * 2 + 1, middle, end, last, x, func);
+                    visit(node * 2, begin, middle, last, x, func);
+                }
+
+            public:
+
+                SegmentIndex() = default;
+
+                /**
+                 * Build the index from the given segment list.
+                 *
+                 * @pre The segment list must be sorted.
+                 */
+                void build(const SegmentList& segments) {
+                    m_leaves = 1;
+                    while (m_leaves < segments.size()) {
+                        m_leaves *= 2;
+                    }
+
+                    m_max_x.assign(m_leaves * 2, std::numeric_limits<int32_t>::min());
+                    for (std::size_t n = 0; n < segments.size(); ++n) {
+                        m_max_x[m_leaves + n] = segments[n].second().location().x();
+                    }
+                    for (std::size_t n = m_leaves - 1; n > 0; --n) {
+                        m_max_x[n] = std::max(m_max_x[n * 2], m_max_x[n * 2 + 1]);
+                    }
+                }
+
+                bool empty() const noexcept {
+                    return m_leaves == 0;
+                }
+
+                /**
+                 * Call func with the index of each segment with index
+                 * <= last, which has a second location with an x coordinate
+                 * >= x. The segments are visited in descending order of
+                 * their index.
+                 */
+                template <typename TFunc>
+                void for_each_reverse(std::size_t last, int32_t x, TFunc&& func) const {
+                    if (!empty()) {
+                        visit(1, 0, m_leaves, last, x, func);
+                    }
+                }
+
+            }; // class SegmentIndex
+
+        } // namespace detail
+
+    } // namespace area
+
+} // namespace osmium
+
+#endif // OSMIUM_AREA_DETAIL_SEGMENT_INDEX_HPP
@@ -35,6 +35,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/area/detail/node_ref_segment.hpp>
 #include <osmium/area/problem_reporter.hpp>
+#include <osmium/memory/arena.hpp>
 #include <osmium/osm/item_type.hpp>
 #include <osmium/osm/location.hpp>
 #include <osmium/osm/node_ref.hpp>
@@ -44,12 +45,16 @@ DEALINGS IN THE SOFTWARE.
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <numeric>
+#include <tuple>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace osmium {
@@ -82,9 +87,9 @@ namespace osmium {
              */
             class SegmentList {
 
-                using slist_type = std::vector<NodeRefSegment>;
+                using slist_type = std::vector<NodeRefSegment, osmium::memory::ArenaAllocator<NodeRefSegment>>;
 
-                slist_type m_segments{};
+                slist_type m_segments;
 
                 bool m_debug;
 
@@ -143,7 +148,14 @@ namespace osmium {
 
             public:
 
-                explicit SegmentList(bool debug) noexcept :
+                /**
+                 * Construct a SegmentList.
+                 *
+                 * @param debug Enable debug output.
+                 * @param arena Optional arena to allocate the segments from.
+                 */
+                explicit SegmentList(bool debug, osmium::memory::Arena* arena = nullptr) noexcept :
+                    m_segments(osmium::memory::ArenaAllocator<NodeRefSegment>{arena}),
                     m_debug(debug) {
                 }
 
@@ -307,18 +319,28 @@ namespace osmium {
                     }
                 }
 
+            private:
+
                 /**
-                 * Find intersection between segments.
-                 *
-                 * @param problem_reporter Any intersections found are
-                 *                         reported to this object.
-                 * @returns true if there are intersections.
+                 * Segment lists with fewer segments than this are checked for
+                 * intersections with a simple nested loop, larger lists with
+                 * a sweep line over y buckets.
                  */
-                uint32_t find_intersections(ProblemReporter* problem_reporter) const {
-                    if (m_segments.empty()) {
-                        return 0;
+                enum {
+                    min_segments_for_sweep = 1024
+                };
+
+                void report_intersection(ProblemReporter* problem_reporter, const NodeRefSegment& s1, const NodeRefSegment& s2, const osmium::Location intersection) const {
+                    if (m_debug) {
+                        std::cerr << "  segments " << s1 << " and " << s2 << " intersecting at " << intersection << "\n";
+                    }
+                    if (problem_reporter) {
+                        problem_reporter->report_intersection(s1.way()->id(), s1.first().location(), s1.second().location(),
+                                                              s2.way()->id(), s2.first().location(), s2.second().location(), intersection);
                     }
+                }
 
+                uint32_t find_intersections_nested_loop(ProblemReporter* problem_reporter) const {
                     uint32_t found_intersections = 0;
 
                     for (auto it1 = m_segments.cbegin(); it1 != m_segments.cend() - 1; ++it1) {
@@ -336,13 +358,7 @@ namespace osmium {
                                 const osmium::Location intersection{calculate_intersection(s1, s2)};
                                 if (intersection) {
                                     ++found_intersections;
-                                    if (m_debug) {
-                                        std::cerr << "  segments " << s1 << " and " << s2 << " intersecting at " << intersection << "\n";
-                                    }
-                                    if (problem_reporter) {
-                                        problem_reporter->report_intersection(s1.way()->id(), s1.first().location(), s1.second().location(),
-                                                                              s2.way()->id(), s2.first().location(), s2.second().location(), intersection);
-                                    }
+                                    report_intersection(problem_reporter, s1, s2, intersection);
                                 }
                             }
                         }
@@ -351,6 +367,118 @@ namespace osmium {
                     return found_intersections;
                 }
 
+                /**
+                 * Sweep a vertical line from left to right over the (sorted)
+                 * segments. The segments the sweep line currently crosses are
+                 * kept in horizontal buckets by their y range, so each segment
+                 * is only compared with the active segments in the buckets
+                 * it overlaps instead of with all segments overlapping in x.
+                 *
+                 * This finds exactly the same segment pairs as the nested
+                 * loop. Intersections are reported in the same order.
+                 */
+                uint32_t find_intersections_sweep(ProblemReporter* problem_reporter) const {
+                    int32_t min_y = std::numeric_limits<int32_t>::max();
+                    int32_t max_y = std::numeric_limits<int32_t>::min();
+                    for (const auto& segment : m_segments) {
+                        min_y = std::min(min_y, std::min(segment.first().location().y(), segment.second().location().y()));
+                        max_y = std::max(max_y, std::max(segment.first().location().y(), segment.second().location().y()));
+                    }
+
+                    const std::size_t num_buckets = static_cast<std::size_t>(std::sqrt(static_cast<double>(m_segments.size()))) * 4;
+                    const int64_t bucket_height = (static_cast<int64_t>(max_y) - min_y) / static_cast<int64_t>(num_buckets) + 1;
+                    const auto bucket = [&](int32_t y) {
+                        return static_cast<std::size_t>((static_cast<int64_t>(y) - min_y) / bucket_height);
+                    };
+
+                    std::vector<std::vector<uint32_t>> buckets(num_buckets);
+
+                    struct found_intersection {
+                        uint32_t s1;
+                        uint32_t s2;
+                        osmium::Location location;
+
+                        bool operator<(const found_intersection& other) const noexcept {
+                            return std::tie(s1, s2) < std::tie(other.s1, other.s2);
+                        }
+                    };
+                    std::vector<found_intersection> intersections;
+
+                    for (uint32_t n = 0; n < m_segments.size(); ++n) {
+                        const NodeRefSegment& s2 = m_segments[n];
+                        const int32_t x = s2.first().location().x();
+                        const std::pair<int32_t, int32_t> y_range = std::minmax(s2.first().location().y(), s2.second().location().y());
+                        const std::size_t first_bucket = bucket(y_range.first);
+                        const std::size_t last_bucket = bucket(y_range.second);
+
+                        for (std::size_t b = first_bucket; b <= last_bucket; ++b) {
+                            auto& active = buckets[b];
+
+                            // Segments ending left of the sweep line can never
+                            // intersect this or any later segment.
+                            active.erase(std::remove_if(active.begin(), active.end(), [&](uint32_t m) {
+                                return m_segments[m].second().location().x() < x;
+                            }), active.end());
+
+                            for (const uint32_t m : active) {
+                                const NodeRefSegment& s1 = m_segments[m];
+
+                                // Segments spanning several buckets can meet
+                                // in more than one of them. Only check them
+                                // in the bucket where their y ranges start
+                                // to overlap.
+                                const int32_t s1_min_y = std::min(s1.first().location().y(), s1.second().location().y());
+                                if (!y_range_overlap(s1, s2) || bucket(std::max(s1_min_y, y_range.first)) != b) {
+                                    continue;
+                                }
+
+                                assert(s1 != s2); // erase_duplicate_segments() should have made sure of that
+
+                                const osmium::Location intersection{calculate_intersection(s1, s2)};
+                                if (intersection) {
+                                    intersections.push_back(found_intersection{m, n, intersection});
+                                }
+                            }
+
+                            active.push_back(n);
+                        }
+                    }
+
+                    std::sort(intersections.begin(), intersections.end());
+                    for (const auto& intersection : intersections) {
+                        report_intersection(problem_reporter, m_segments[intersection.s1], m_segments[intersection.s2], intersection.location);
+                    }
+
+                    return static_cast<uint32_t>(intersections.size());
+                }
+
+            public:
+
+                /**
+                 * Find intersection between segments.
+                 *
+                 * Small segment lists are checked with a nested loop over
+                 * the segments sorted by x. Larger lists use a sweep line
+                 * which only compares segments overlapping in both x and y.
+                 *
+                 * @pre The segment list must be sorted.
+                 *
+                 * @param problem_reporter Any intersections found are
+                 *                         reported to this object.
+                 * @returns true if there are intersections.
+                 */
+                uint32_t find_intersections(ProblemReporter* problem_reporter) const {
+                    if (m_segments.empty()) {
+                        return 0;
+                    }
+
+                    if (m_segments.size() < min_segments_for_sweep) {
+                        return find_intersections_nested_loop(problem_reporter);
+                    }
+
+                    return find_intersections_sweep(problem_reporter);
+                }
+
             }; // class SegmentList
 
         } // namespace detail
@@ -0,0 +1,474 @@
+#ifndef OSMIUM_AREA_INCREMENTAL_AREA_MANAGER_HPP
+#define OSMIUM_AREA_INCREMENTAL_AREA_MANAGER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/area/stats.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/index/map.hpp>
+#include <osmium/index/multimap/sparse_mem_multimap.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/storage/item_stash.hpp>
+#include <osmium/tags/taglist.hpp>
+#include <osmium/tags/tags_filter.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace area {
+
+        /**
+         * The result of IncrementalAreaManager::assemble_dirty().
+         */
+        struct area_changes {
+
+            /**
+             * Ids of all areas which might have changed, sorted. Remove
+             * the old versions of all these areas, then add the areas
+             * written to the output buffer. (Some of these areas may not
+             * have existed before and some will not exist any more.)
+             */
+            std::vector<osmium::object_id_type> dirty_area_ids;
+
+            /**
+             * Ids of multipolygon relations which could not be assembled
+             * because some member ways are not known. This happens when
+             * a relation gets a way as new member which was not stored
+             * before (because it is not closed and wasn't a member of any
+             * other multipolygon relation). Add those ways with way()
+             * and call assemble_dirty() again.
+             */
+            std::vector<osmium::object_id_type> incomplete_relations;
+
+        }; // struct area_changes
+
+        /**
+         * Keeps all data needed to re-assemble areas after changes to the
+         * OSM data, so that only the areas affected by some change need to
+         * be rebuilt. This is intended for keeping areas up to date with
+         * minutely or hourly change files.
+         *
+         * The manager keeps all closed ways which could be areas and all
+         * multipolygon and boundary relations with their member ways in an
+         * ItemStash. It also keeps an index from node ids to the ids of
+         * those ways and from way ids to relation ids. Node locations are
+         * stored in a location index supplied by the user.
+         *
+         * To fill the manager initially, first send it all relations, then
+         * all nodes and ways (as with the MultipolygonManager this needs two
+         * passes over the input file), then call assemble_dirty() which will
+         * build all areas.
+         *
+         * For each change file call apply_changes() with the changes (or
+         * send it all objects from the change file in the order relations,
+         * nodes, ways), then call assemble_dirty() again to get the changed
+         * areas.
+         *
+         * @tparam TAssembler Multipolygon Assembler class.
+         * @pre The location index must allow changing and looking up
+         *      locations in any order (for instance a SparseMemMap or
+         *      one of the dense indexes).
+         */
+        template <typename TAssembler>
+        class IncrementalAreaManager : public osmium::handler::Handler {
+
+        public:
+
+            using assembler_config_type = typename TAssembler::config_type;
+            using location_index_type = osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>;
+
+        private:
+
+            using id_type = osmium::unsigned_object_id_type;
+            using handle_map_type = std::unordered_map<id_type, osmium::ItemStash::handle_type>;
+            using multimap_type = osmium::index::multimap::SparseMemMultimap<id_type, id_type>;
+
+            const assembler_config_type m_assembler_config;
+
+            area_stats m_stats;
+
+            osmium::TagsFilter m_filter;
+
+            location_index_type& m_locations;
+
+            osmium::ItemStash m_stash;
+
+            handle_map_type m_ways;
+            handle_map_type m_relations;
+
+            multimap_type m_node_to_ways;
+            multimap_type m_way_to_relations;
+
+            std::vector<id_type> m_dirty_nodes;
+            std::vector<id_type> m_dirty_ways;
+            std::vector<id_type> m_dirty_relations;
+
+            static void sort_unique(std::vector<id_type>& ids) {
+                std::sort(ids.begin(), ids.end());
+                ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+            }
+
+            static bool has_way_members(const osmium::Relation& relation) noexcept {
+                return std::any_of(relation.members().cbegin(), relation.members().cend(), [](const osmium::RelationMember& member) {
+                    return member.type() == osmium::item_type::way;
+                });
+            }
+
+            // Same check as in MultipolygonManager::new_relation().
+            bool wanted_relation(const osmium::Relation& relation) const {
+                if (!relation.visible()) {
+                    return false;
+                }
+
+                const char* type = relation.tags().get_value_by_key("type");
+                if (type == nullptr) {
+                    return false;
+                }
+
+                return (!std::strcmp(type, "multipolygon") || !std::strcmp(type, "boundary")) &&
+                       osmium::tags::match_any_of(relation.tags(), m_filter) &&
+                       has_way_members(relation);
+            }
+
+            // Closed ways are checked again with their locations when
+            // assembling. This is only a first check on the node ids.
+            bool possibly_area(const osmium::Way& way) const {
+                return way.visible() &&
+                       way.nodes().size() > 3 &&
+                       way.nodes().front().ref() == way.nodes().back().ref() &&
+                       !way.tags().has_tag("area", "no") &&
+                       osmium::tags::match_any_of(way.tags(), m_filter);
+            }
+
+            bool has_parents(id_type way_id) const {
+                const auto range = m_way_to_relations.get_all(way_id);
+                return range.first != range.second;
+            }
+
+            void remove_way(id_type id) {
+                const auto it = m_ways.find(id);
+                if (it == m_ways.end()) {
+                    return;
+                }
+                const auto& way = m_stash.get<osmium::Way>(it->second);
+                for (const auto& node_ref : way.nodes()) {
+                    m_node_to_ways.remove(node_ref.positive_ref(), id);
+                }
+                m_stash.remove_item(it->second);
+                m_ways.erase(it);
+            }
+
+            void store_way(const osmium::Way& way) {
+                const id_type id = way.positive_id();
+                m_ways[id] = m_stash.add_item(way);
+                for (const auto& node_ref : way.nodes()) {
+                    m_node_to_ways.set(node_ref.positive_ref(), id);
+                }
+            }
+
+            // Remove relation and return ids of its member ways.
+            std::vector<id_type> remove_relation(id_type id) {
+                std::vector<id_type> way_ids;
+                const auto it = m_relations.find(id);
+                if (it == m_relations.end()) {
+                    return way_ids;
+                }
+                const auto& relation = m_stash.get<osmium::Relation>(it->second);
+                for (const auto& member : relation.members()) {
+                    if (member.type() == osmium::item_type::way) {
+                        m_way_to_relations.remove(member.positive_ref(), id);
+                        way_ids.push_back(member.positive_ref());
+                    }
+                }
+                m_stash.remove_item(it->second);
+                m_relations.erase(it);
+                return way_ids;
+            }
+
+            // Remove ways which are not needed any more.
+            void remove_unused_ways(const std::vector<id_type>& way_ids) {
+                for (const id_type way_id : way_ids) {
+                    const auto it = m_ways.find(way_id);
+                    if (it != m_ways.end() && !has_parents(way_id) &&
+                        !possibly_area(m_stash.get<osmium::Way>(it->second))) {
+                        remove_way(way_id);
+                    }
+                }
+            }
+
+            void store_relation(const osmium::Relation& relation) {
+                const id_type id = relation.positive_id();
+                m_relations[id] = m_stash.add_item(relation);
+                for (const auto& member : relation.members()) {
+                    if (member.type() == osmium::item_type::way) {
+                        m_way_to_relations.set(member.positive_ref(), id);
+                    }
+                }
+            }
+
+            // Get way from stash with current locations from the index.
+            osmium::Way* get_way_with_locations(id_type id) {
+                const auto it = m_ways.find(id);
+                if (it == m_ways.end()) {
+                    return nullptr;
+                }
+                auto& way = m_stash.get<osmium::Way>(it->second);
+                for (auto& node_ref : way.nodes()) {
+                    node_ref.set_location(m_locations.get_noexcept(node_ref.positive_ref()));
+                }
+                return &way;
+            }
+
+            // Same checks as in MultipolygonManager::after_way().
+            void assemble_way(id_type id, osmium::memory::Buffer& out_buffer) {
+                const auto it = m_ways.find(id);
+                if (it == m_ways.end() || !possibly_area(m_stash.get<osmium::Way>(it->second))) {
+                    return;
+                }
+
+                const osmium::Way& way = *get_way_with_locations(id);
+                try {
+                    if (!way.nodes().front().location() || !way.nodes().back().location()) {
+                        throw osmium::invalid_location{"invalid location"};
+                    }
+                    if (way.ends_have_same_location()) {
+                        TAssembler assembler{m_assembler_config};
+                        assembler(way, out_buffer);
+                        m_stats += assembler.stats();
+                    }
+                } catch (const osmium::invalid_location&) {
+                    // XXX ignore
+                }
+            }
+
+            // Returns false if some member ways are missing.
+            bool assemble_relation(id_type id, osmium::memory::Buffer& out_buffer) {
+                const auto it = m_relations.find(id);
+                if (it == m_relations.end()) {
+                    return true;
+                }
+                const osmium::Relation& relation = m_stash.get<osmium::Relation>(it->second);
+
+                std::vector<const osmium::Way*> ways;
+                ways.reserve(relation.members().size());
+                for (const auto& member : relation.members()) {
+                    if (member.type() == osmium::item_type::way) {
+                        const osmium::Way* way = get_way_with_locations(member.positive_ref());
+                        if (!way) {
+                            return false;
+                        }
+                        ways.push_back(way);
+                    }
+                }
+
+                try {
+                    TAssembler assembler{m_assembler_config};
+                    assembler(relation, ways, out_buffer);
+                    m_stats += assembler.stats();
+                } catch (const osmium::invalid_location&) {
+                    // XXX ignore
+                }
+
+                return true;
+            }
+
+        public:
+
+            /**
+             * Construct an IncrementalAreaManager.
+             *
+             * @param assembler_config The configuration for the assembler.
+             * @param locations Index for node locations. It is updated
+             *                  with all nodes given to the manager and must
+             *                  be available as long as the manager is used.
+             * @param filter Only relations and closed ways matching this
+             *               filter are assembled.
+             */
+            IncrementalAreaManager(const assembler_config_type& assembler_config, location_index_type& locations, osmium::TagsFilter filter = osmium::TagsFilter{true}) :
+                m_assembler_config(assembler_config),
+                m_filter(std::move(filter)),
+                m_locations(locations) {
+            }
+
+            /**
+             * Access the stash used for ways and relations. Use this for
+             * instance to spill it to disk.
+             */
+            osmium::ItemStash& stash() noexcept {
+                return m_stash;
+            }
+
+            /**
+             * Return the statistics generated by all assemblers so far.
+             */
+            const area_stats& stats() const noexcept {
+                return m_stats;
+            }
+
+            /**
+             * Add, change, or (if it is not visible) delete a relation.
+             */
+            void relation(const osmium::Relation& relation) {
+                const id_type id = relation.positive_id();
+                const bool stored = m_relations.count(id) > 0;
+                const auto old_way_ids = remove_relation(id);
+                if (wanted_relation(relation)) {
+                    store_relation(relation);
+                } else if (!stored) {
+                    return;
+                }
+                remove_unused_ways(old_way_ids);
+                m_dirty_relations.push_back(id);
+            }
+
+            /**
+             * Add, change, or (if it is not visible) delete a node. This
+             * updates the location index. The ways and relations using
+             * this node are re-assembled in the next assemble_dirty().
+             */
+            void node(const osmium::Node& node) {
+                const id_type id = node.positive_id();
+                m_locations.set(id, node.visible() ? node.location() : osmium::Location{});
+                const auto range = m_node_to_ways.get_all(id);
+                if (range.first != range.second) {
+                    m_dirty_nodes.push_back(id);
+                }
+            }
+
+            /**
+             * Add, change, or (if it is not visible) delete a way.
+             *
+             * Ways are only stored if they are possible areas or members
+             * of multipolygon relations already known.
+             */
+            void way(const osmium::Way& way) {
+                const id_type id = way.positive_id();
+                const bool stored = m_ways.count(id) > 0;
+                if (stored) {
+                    remove_way(id);
+                }
+                if (way.visible() && (possibly_area(way) || has_parents(id))) {
+                    store_way(way);
+                } else if (!stored) {
+                    return;
+                }
+                m_dirty_ways.push_back(id);
+            }
+
+            /**
+             * Apply all changes in the buffer, usually read from a change
+             * file. Relations are handled first, so that changed ways can
+             * be stored if they are now a member of a multipolygon
+             * relation.
+             */
+            void apply_changes(const osmium::memory::Buffer& changes) {
+                for (const auto& relation : changes.select<osmium::Relation>()) {
+                    this->relation(relation);
+                }
+                for (const auto& item : changes) {
+                    if (item.type() == osmium::item_type::node) {
+                        node(static_cast<const osmium::Node&>(item));
+                    } else if (item.type() == osmium::item_type::way) {
+                        way(static_cast<const osmium::Way&>(item));
+                    }
+                }
+            }
+
+            /**
+             * Assemble all areas which might have changed since the last
+             * call (or all areas on the first call) and add them to the
+             * output buffer.
+             *
+             * @param out_buffer The buffer the areas are written to.
+             * @returns Ids of the areas which might have changed and of
+             *          relations which could not be assembled.
+             */
+            area_changes assemble_dirty(osmium::memory::Buffer& out_buffer) {
+                area_changes changes;
+
+                sort_unique(m_dirty_nodes);
+                for (const id_type node_id : m_dirty_nodes) {
+                    const auto range = m_node_to_ways.get_all(node_id);
+                    for (auto it = range.first; it != range.second; ++it) {
+                        m_dirty_ways.push_back(it->second);
+                    }
+                }
+                m_dirty_nodes.clear();
+
+                sort_unique(m_dirty_ways);
+                for (const id_type way_id : m_dirty_ways) {
+                    const auto range = m_way_to_relations.get_all(way_id);
+                    for (auto it = range.first; it != range.second; ++it) {
+                        m_dirty_relations.push_back(it->second);
+                    }
+                }
+                sort_unique(m_dirty_relations);
+
+                for (const id_type way_id : m_dirty_ways) {
+                    changes.dirty_area_ids.push_back(osmium::object_id_to_area_id(static_cast<osmium::object_id_type>(way_id), osmium::item_type::way));
+                    assemble_way(way_id, out_buffer);
+                }
+
+                for (const id_type relation_id : m_dirty_relations) {
+                    changes.dirty_area_ids.push_back(osmium::object_id_to_area_id(static_cast<osmium::object_id_type>(relation_id), osmium::item_type::relation));
+                    if (!assemble_relation(relation_id, out_buffer)) {
+                        changes.incomplete_relations.push_back(static_cast<osmium::object_id_type>(relation_id));
+                    }
+                }
+
+                std::sort(changes.dirty_area_ids.begin(), changes.dirty_area_ids.end());
+                m_dirty_ways.clear();
+                m_dirty_relations.clear();
+
+                return changes;
+            }
+
+        }; // class IncrementalAreaManager
+
+    } // namespace area
+
+} // namespace osmium
+
+#endif // OSMIUM_AREA_INCREMENTAL_AREA_MANAGER_HPP
@@ -45,12 +45,17 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/storage/item_stash.hpp>
 #include <osmium/tags/taglist.hpp>
 #include <osmium/tags/tags_filter.hpp>
+#include <osmium/thread/pool.hpp>
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <deque>
+#include <future>
+#include <utility>
 #include <vector>
 
 namespace osmium {
@@ -60,6 +65,15 @@ namespace osmium {
      */
     namespace area {
 
+        /**
+         * Order in which areas assembled on a thread pool are delivered
+         * to the output of the MultipolygonManager.
+         */
+        enum class result_order {
+            ordered   = 0, ///< same order as without the pool
+            unordered = 1  ///< as soon as they are assembled
+        };
+
         /**
          * This class collects all data needed for creating areas from
          * relations tagged with type=multipolygon or type=boundary.
@@ -82,6 +96,140 @@ namespace osmium {
 
             osmium::TagsFilter m_filter;
 
+            struct assembler_result {
+                osmium::memory::Buffer buffer;
+                area_stats stats;
+            };
+
+            /**
+             * Assembles all areas from one batch of input objects. A batch
+             * contains relations, each followed by its member ways in
+             * member order, and closed ways on their own.
+             */
+            class assembler_task {
+
+                assembler_config_type m_config;
+                osmium::memory::Buffer m_input;
+
+            public:
+
+                assembler_task(const assembler_config_type& config, osmium::memory::Buffer&& input) :
+                    m_config(config),
+                    m_input(std::move(input)) {
+                }
+
+                assembler_result operator()() {
+                    assembler_result result{osmium::memory::Buffer{m_input.committed(), osmium::memory::Buffer::auto_grow::yes}, area_stats{}};
+
+                    std::vector<const osmium::Way*> ways;
+                    auto it = m_input.cbegin<osmium::OSMObject>();
+                    const auto end = m_input.cend<osmium::OSMObject>();
+                    while (it != end) {
+                        if (it->type() == osmium::item_type::relation) {
+                            const auto& relation = static_cast<const osmium::Relation&>(*it);
+                            ++it;
+                            ways.clear();
+                            for (const auto& member : relation.members()) {
+                                if (member.ref() != 0) {
+                                    assert(it != end && it->type() == osmium::item_type::way);
+                                    ways.push_back(static_cast<const osmium::Way*>(&*it));
+                                    ++it;
+                                }
+                            }
+                            try {
+                                TAssembler assembler{m_config};
+                                assembler(relation, ways, result.buffer);
+                                result.stats += assembler.stats();
+                            } catch (const osmium::invalid_location&) {
+                                // XXX ignore
+                            }
+                        } else {
+                            const auto& way = static_cast<const osmium::Way&>(*it);
+                            ++it;
+                            try {
+                                TAssembler assembler{m_config};
+                                assembler(way, result.buffer);
+                                result.stats += assembler.stats();
+                            } catch (const osmium::invalid_location&) {
+                                // XXX ignore
+                            }
+                        }
+                    }
+
+                    return result;
+                }
+
+            }; // class assembler_task
+
+            enum {
+                default_batch_size = 512UL * 1024UL
+            };
+
+            osmium::thread::Pool* m_pool = nullptr;
+            result_order m_order = result_order::ordered;
+            std::size_t m_max_pending = 0;
+            osmium::memory::Buffer m_batch{};
+            std::deque<std::future<assembler_result>> m_pending;
+
+            void add_to_batch(const osmium::memory::Item& item) {
+                if (!m_batch) {
+                    m_batch = osmium::memory::Buffer{default_batch_size, osmium::memory::Buffer::auto_grow::yes};
+                }
+                m_batch.add_item(item);
+                m_batch.commit();
+            }
+
+            void submit_batch() {
+                if (!m_batch || m_batch.committed() == 0) {
+                    return;
+                }
+
+                while (m_pending.size() >= m_max_pending) {
+                    deliver(m_pending.front().get());
+                    m_pending.pop_front();
+                }
+
+                m_pending.push_back(m_pool->submit(assembler_task{m_assembler_config, std::move(m_batch)}));
+                m_batch = osmium::memory::Buffer{};
+            }
+
+            void possibly_submit_batch() {
+                if (m_batch && m_batch.committed() >= default_batch_size) {
+                    submit_batch();
+                }
+                deliver_ready();
+            }
+
+            void deliver(assembler_result&& result) {
+                this->buffer().add_buffer(result.buffer);
+                this->buffer().commit();
+                m_stats += result.stats;
+                this->possibly_flush();
+            }
+
+            static bool is_ready(const std::future<assembler_result>& future) {
+                return future.wait_for(std::chrono::seconds{0}) == std::future_status::ready;
+            }
+
+            void deliver_ready() {
+                if (m_order == result_order::ordered) {
+                    while (!m_pending.empty() && is_ready(m_pending.front())) {
+                        deliver(m_pending.front().get());
+                        m_pending.pop_front();
+                    }
+                    return;
+                }
+
+                for (auto it = m_pending.begin(); it != m_pending.end();) {
+                    if (is_ready(*it)) {
+                        deliver(it->get());
+                        it = m_pending.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+
         public:
 
             /**
@@ -106,6 +254,54 @@ namespace osmium {
                 return m_stats;
             }
 
+            /**
+             * Assemble areas on the given thread pool instead of in the
+             * calling thread. Relations and closed ways are collected into
+             * batches which are assembled by the pool threads. Finished
+             * areas are added to the output buffer as they become
+             * available and are handed to the callback as usual. All
+             * pending areas are delivered when the output is flushed, ie.
+             * at the latest at the end of the second pass.
+             *
+             * Call this before the second pass. The pool must outlive the
+             * second pass. If a problem reporter is set in the assembler
+             * config it will be called from the pool threads, so it must
+             * be thread-safe. The statistics returned by stats() are only
+             * complete after the output was flushed.
+             *
+             * @param pool The thread pool to use.
+             * @param order Should the areas be delivered in the order they
+             *              would have without the pool (the default), or
+             *              as soon as they are ready?
+             */
+            void use_pool(osmium::thread::Pool& pool, result_order order = result_order::ordered) {
+                m_pool = &pool;
+                m_order = order;
+                m_max_pending = 2 * static_cast<std::size_t>(pool.num_threads());
+            }
+
+            /**
+             * Submit the current batch to the pool and wait for all pending
+             * areas and add them to the output buffer. Called from
+             * flush_output().
+             */
+            void before_flush() {
+                if (!m_pool) {
+                    return;
+                }
+
+                submit_batch();
+                while (!m_pending.empty()) {
+                    if (m_order == result_order::ordered) {
+                        deliver(m_pending.front().get());
+                        m_pending.pop_front();
+                    } else {
+                        m_pending.front().wait();
+                        deliver_ready();
+                    }
+                }
+            }
+
             /**
              * We are interested in all relations tagged with type=multipolygon
              * or type=boundary with at least one way member.
@@ -133,6 +329,19 @@ namespace osmium {
              * assembler.
              */
             void complete_relation(const osmium::Relation& relation) {
+                if (m_pool) {
+                    add_to_batch(relation);
+                    for (const auto& member : relation.members()) {
+                        if (member.ref() != 0) {
+                            const osmium::Way* way = this->get_member_way(member.ref());
+                            assert(way != nullptr);
+                            add_to_batch(*way);
+                        }
+                    }
+                    possibly_submit_batch();
+                    return;
+                }
+
                 std::vector<const osmium::Way*> ways;
                 ways.reserve(relation.members().size());
                 for (const auto& member : relation.members()) {
@@ -170,6 +379,12 @@ namespace osmium {
                             return;
                         }
 
+                        if (m_pool) {
+                            add_to_batch(way);
+                            possibly_submit_batch();
+                            return;
+                        }
+
                         TAssembler assembler{m_assembler_config};
                         assembler(way, this->buffer());
                         m_stats += assembler.stats();
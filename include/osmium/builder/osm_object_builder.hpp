@@ -41,6 +41,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/item_type.hpp>
 #include <osmium/osm/location.hpp>
 #include <osmium/osm/node.hpp>
+#include <osmium/osm/node_batch.hpp>
 #include <osmium/osm/node_ref.hpp>
 #include <osmium/osm/object.hpp>
 #include <osmium/osm/relation.hpp>
@@ -694,6 +695,116 @@ namespace osmium {
 
         }; // class ChangesetBuilder
 
+        /**
+         * Build an osmium::NodeBatch. The number of nodes in the batch must
+         * be known up front and add_node() must be called exactly that
+         * many times.
+         */
+        class NodeBatchBuilder : public Builder {
+
+            std::size_t m_added = 0;
+            uint32_t m_tag_bytes = 0;
+
+            void add_string(const char* str, const string_size_type length) {
+                const auto size = append_with_zero(str, length);
+                add_size(size);
+                m_tag_bytes += size;
+            }
+
+        public:
+
+            /**
+             * Constructor.
+             *
+             * @param buffer The buffer the NodeBatch is built in.
+             * @param count The number of nodes in the batch.
+             * @param with_tags Should the batch contain the tags?
+             */
+            NodeBatchBuilder(osmium::memory::Buffer& buffer, const std::size_t count, const bool with_tags = false) :
+                Builder(buffer, nullptr, static_cast<osmium::memory::item_size_type>(sizeof(NodeBatch) + NodeBatch::columns_size(count, with_tags))) {
+                new (&item()) NodeBatch{static_cast<uint32_t>(count), with_tags};
+                add_size(static_cast<osmium::memory::item_size_type>(NodeBatch::columns_size(count, with_tags)));
+                if (with_tags) {
+                    std::fill_n(object().mutable_tag_offsets(), count + 1, 0);
+                }
+            }
+
+            NodeBatchBuilder(const NodeBatchBuilder&) = delete;
+            NodeBatchBuilder& operator=(const NodeBatchBuilder&) = delete;
+
+            NodeBatchBuilder(NodeBatchBuilder&&) = delete;
+            NodeBatchBuilder& operator=(NodeBatchBuilder&&) = delete;
+
+            ~NodeBatchBuilder() {
+                add_padding(true);
+            }
+
+            /**
+             * Get a reference to the node batch being built.
+             *
+             * Note that this reference will be invalidated by every call
+             * to add_tag().
+             */
+            NodeBatch& object() noexcept {
+                return static_cast<NodeBatch&>(item());
+            }
+
+            /**
+             * Get a const reference to the node batch being built.
+             *
+             * Note that this reference will be invalidated by every call
+             * to add_tag().
+             */
+            const NodeBatch& cobject() const noexcept {
+                return static_cast<const NodeBatch&>(item());
+            }
+
+            /**
+             * Add the next node to the batch.
+             *
+             * @pre Less than the number of nodes given in the constructor
+             *      have been added so far.
+             */
+            void add_node(const osmium::object_id_type id, const osmium::Location& location) noexcept {
+                NodeBatch& batch = object();
+                assert(m_added < batch.size());
+                batch.mutable_ids()[m_added] = id;
+                batch.mutable_x()[m_added] = location.x();
+                batch.mutable_y()[m_added] = location.y();
+                ++m_added;
+                if (batch.has_tags()) {
+                    batch.mutable_tag_offsets()[m_added] = m_tag_bytes;
+                }
+            }
+
+            /**
+             * Add a tag to the node added last.
+             *
+             * @param key Pointer to tag key.
+             * @param key_length Length of key (not including the \0 byte).
+             * @param value Pointer to tag value.
+             * @param value_length Length of value (not including the \0 byte).
+             *
+             * @pre The batch was created with tags and add_node() was
+             *      called at least once.
+             * @throws std:length_error If key or value is longer than
+             *         osmium::max_osm_string_length
+             */
+            void add_tag(const char* key, const std::size_t key_length, const char* value, const std::size_t value_length) {
+                assert(cobject().has_tags() && m_added > 0);
+                if (key_length > osmium::max_osm_string_length) {
+                    throw std::length_error{"OSM tag key is too long"};
+                }
+                if (value_length > osmium::max_osm_string_length) {
+                    throw std::length_error{"OSM tag value is too long"};
+                }
+                add_string(key, static_cast<string_size_type>(key_length));
+                add_string(value, static_cast<string_size_type>(value_length));
+                object().mutable_tag_offsets()[m_added] = m_tag_bytes;
+            }
+
+        }; // class NodeBatchBuilder
+
 #undef OSMIUM_FORWARD
 
     } // namespace builder
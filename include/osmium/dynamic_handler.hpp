@@ -34,18 +34,20 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/handler.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/changeset.hpp>
+#include <osmium/osm/entity.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/way.hpp>
 
 #include <memory>
 #include <utility>
 
 namespace osmium {
 
-    class Node;
-    class Way;
-    class Relation;
-    class Area;
-    class Changeset;
-
     namespace handler {
 
         namespace detail {
@@ -82,6 +84,35 @@ namespace osmium {
                 virtual void flush() {
                 }
 
+                /**
+                 * Call the handler functions for all objects in the
+                 * buffer. Derived classes override this to do the loop
+                 * without a virtual call for each object.
+                 */
+                virtual void buffer(const osmium::memory::Buffer& buffer) {
+                    for (const auto& entity : buffer) {
+                        switch (entity.type()) {
+                            case osmium::item_type::node:
+                                node(static_cast<const osmium::Node&>(entity));
+                                break;
+                            case osmium::item_type::way:
+                                way(static_cast<const osmium::Way&>(entity));
+                                break;
+                            case osmium::item_type::relation:
+                                relation(static_cast<const osmium::Relation&>(entity));
+                                break;
+                            case osmium::item_type::area:
+                                area(static_cast<const osmium::Area&>(entity));
+                                break;
+                            case osmium::item_type::changeset:
+                                changeset(static_cast<const osmium::Changeset&>(entity));
+                                break;
+                            default:
+                                break;
+                        }
+                    }
+                }
+
             }; // class HandlerWrapperBase
 
 
@@ -114,6 +145,22 @@ auto _name_##_dispatch(THandler& handler, const osmium::_type_& object, long) ->
             void flush_dispatch(THandler& /*handler*/, long /*dispatch*/) { // NOLINT(google-runtime-int)
             }
 
+            // Call func for all objects in a buffer which only contains
+            // objects of type TObject.
+            template <typename TObject, typename TFunction>
+            void for_each_object(const osmium::memory::Buffer& buffer, TFunction&& func) {
+                if (buffer.committed() == 0) {
+                    return;
+                }
+                const unsigned char* data = buffer.data();
+                const unsigned char* const end = data + buffer.committed();
+                while (data != end) {
+                    const auto& object = *reinterpret_cast<const TObject*>(data);
+                    std::forward<TFunction>(func)(object);
+                    data = object.next();
+                }
+            }
+
             template <typename THandler>
             class HandlerWrapper : public HandlerWrapperBase {
 
@@ -158,10 +205,61 @@ auto _name_##_dispatch(THandler& handler, const osmium::_type_& object, long) ->
                     flush_dispatch(m_handler, 0);
                 }
 
+                void buffer(const osmium::memory::Buffer& buffer) final {
+                    switch (buffer.homogeneous_type()) {
+                        case osmium::item_type::node:
+                            for_each_object<osmium::Node>(buffer, [this](const osmium::Node& node) {
+                                node_dispatch(m_handler, node, 0);
+                            });
+                            return;
+                        case osmium::item_type::way:
+                            for_each_object<osmium::Way>(buffer, [this](const osmium::Way& way) {
+                                way_dispatch(m_handler, way, 0);
+                            });
+                            return;
+                        case osmium::item_type::relation:
+                            for_each_object<osmium::Relation>(buffer, [this](const osmium::Relation& relation) {
+                                relation_dispatch(m_handler, relation, 0);
+                            });
+                            return;
+                        default:
+                            break;
+                    }
+                    for (const auto& entity : buffer) {
+                        switch (entity.type()) {
+                            case osmium::item_type::node:
+                                node_dispatch(m_handler, static_cast<const osmium::Node&>(entity), 0);
+                                break;
+                            case osmium::item_type::way:
+                                way_dispatch(m_handler, static_cast<const osmium::Way&>(entity), 0);
+                                break;
+                            case osmium::item_type::relation:
+                                relation_dispatch(m_handler, static_cast<const osmium::Relation&>(entity), 0);
+                                break;
+                            case osmium::item_type::area:
+                                area_dispatch(m_handler, static_cast<const osmium::Area&>(entity), 0);
+                                break;
+                            case osmium::item_type::changeset:
+                                changeset_dispatch(m_handler, static_cast<const osmium::Changeset&>(entity), 0);
+                                break;
+                            default:
+                                break;
+                        }
+                    }
+                }
+
             }; // class HandlerWrapper
 
         } // namespace detail
 
+        /**
+         * Handler forwarding all calls to a handler that can be changed
+         * at runtime with set().
+         *
+         * Calling buffer() (or osmium::apply() with a buffer and only this
+         * handler) calls the handler for all objects in the buffer with
+         * only one virtual function call instead of one per object.
+         */
         class DynamicHandler : public osmium::handler::Handler {
 
             using impl_ptr = std::unique_ptr<osmium::handler::detail::HandlerWrapperBase>;
@@ -202,10 +300,30 @@ auto _name_##_dispatch(THandler& handler, const osmium::_type_& object, long) ->
                 m_impl->flush();
             }
 
+            /// Call the handler for all objects in the buffer.
+            void buffer(const osmium::memory::Buffer& buffer) {
+                m_impl->buffer(buffer);
+            }
+
         }; // class DynamicHandler
 
     } // namespace handler
 
+    /**
+     * Apply a DynamicHandler to all objects in a buffer. This does the
+     * same as the generic osmium::apply(), but with only one virtual
+     * function call for the whole buffer.
+     */
+    inline void apply(const osmium::memory::Buffer& buffer, osmium::handler::DynamicHandler& handler) {
+        handler.buffer(buffer);
+        handler.flush();
+    }
+
+    inline void apply(osmium::memory::Buffer& buffer, osmium::handler::DynamicHandler& handler) {
+        handler.buffer(buffer);
+        handler.flush();
+    }
+
 } // namespace osmium
 
 #endif // OSMIUM_DYNAMIC_HANDLER_HPP
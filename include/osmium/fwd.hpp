@@ -51,6 +51,7 @@ namespace osmium {
     class InnerRing;
     class Location;
     class Node;
+    class NodeBatch;
     class NodeRef;
     class NodeRefList;
     class OSMEntity;
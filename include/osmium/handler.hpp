@@ -40,6 +40,7 @@ namespace osmium {
     class ChangesetDiscussion;
     class InnerRing;
     class Node;
+    class NodeBatch;
     class OSMObject;
     class OuterRing;
     class Relation;
@@ -67,6 +68,9 @@ namespace osmium {
          *
          * If you are working with changesets, implement the changeset()
          * function.
+         *
+         * If you are reading nodes as batches (see osmium::NodeBatch),
+         * implement the node_batch() function.
          */
         class Handler {
 
@@ -90,6 +94,9 @@ namespace osmium {
             void changeset(const osmium::Changeset& /*changeset*/) const noexcept {
             }
 
+            void node_batch(const osmium::NodeBatch& /*node_batch*/) const noexcept {
+            }
+
             void tag_list(const osmium::TagList& /*tag_list*/) const noexcept {
             }
 
@@ -45,6 +45,10 @@ DEALINGS IN THE SOFTWARE.
 
 namespace osmium {
 
+    namespace thread {
+        class Pool;
+    } // namespace thread
+
     namespace index {
 
         namespace map {
@@ -238,6 +242,14 @@ namespace osmium {
                     std::sort(m_vector.begin(), m_vector.end());
                 }
 
+                /**
+                 * Sort data in map using the threads in the pool. Use this
+                 * instead of sort() for large maps.
+                 *
+                 * Include <osmium/index/parallel_sort.hpp> to use this.
+                 */
+                void sort(osmium::thread::Pool& pool);
+
                 void dump_as_array(const int fd) final {
                     constexpr const size_t value_size = sizeof(TValue);
                     constexpr const size_t buffer_size = (10L * 1024L * 1024L) / value_size;
@@ -43,6 +43,10 @@ DEALINGS IN THE SOFTWARE.
 
 namespace osmium {
 
+    namespace thread {
+        class Pool;
+    } // namespace thread
+
     namespace index {
 
         namespace multimap {
@@ -130,6 +134,14 @@ namespace osmium {
                     std::sort(m_vector.begin(), m_vector.end());
                 }
 
+                /**
+                 * Sort data in multimap using the threads in the pool. Use
+                 * this instead of sort() for large multimaps.
+                 *
+                 * Include <osmium/index/parallel_sort.hpp> to use this.
+                 */
+                void sort(osmium::thread::Pool& pool);
+
                 void remove(const TId id, const TValue value) {
                     const auto r = get_all(id);
                     for (auto it = r.first; it != r.second; ++it) {
@@ -144,6 +156,10 @@ namespace osmium {
                     std::sort(m_vector.begin(), m_vector.end());
                 }
 
+                void consolidate(osmium::thread::Pool& pool) {
+                    sort(pool);
+                }
+
                 void erase_removed() {
                     m_vector.erase(
                         std::remove_if(m_vector.begin(), m_vector.end(), is_removed),
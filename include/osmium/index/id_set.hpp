@@ -38,11 +38,14 @@ DEALINGS IN THE SOFTWARE.
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
-#include <cstring>
+#include <cstdint>
 #include <iterator>
+#include <limits>
 #include <memory>
+#include <stdexcept>
 #include <type_traits>
 #include <vector>
 
@@ -106,6 +109,33 @@ namespace osmium {
                 default_chunk_bits = 22U
             };
 
+            /// Number of bits set in a 64 bit word.
+            inline int popcount(uint64_t word) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+                return __builtin_popcountll(word);
+#else
+                int count = 0;
+                for (; word != 0; word &= word - 1) {
+                    ++count;
+                }
+                return count;
+#endif
+            }
+
+            /// Index of the lowest bit set in a 64 bit word, word must not be 0.
+            inline int count_trailing_zeros(uint64_t word) noexcept {
+                assert(word != 0);
+#if defined(__GNUC__) || defined(__clang__)
+                return __builtin_ctzll(word);
+#else
+                int count = 0;
+                for (; (word & 1U) == 0; word >>= 1U) {
+                    ++count;
+                }
+                return count;
+#endif
+            }
+
         } // namespace detail
 
         template <typename T, std::size_t chunk_bits = detail::default_chunk_bits>
@@ -127,27 +157,29 @@ namespace osmium {
             T m_last;
 
             void next() noexcept {
-                while (m_value != m_last && !m_set->get(m_value)) {
-                    const T cid = id_set::chunk_id(m_value);
+                while (m_value < m_last) {
+                    const auto cid = id_set::chunk_id(m_value);
                     assert(cid < m_set->m_data.size());
-                    if (!m_set->m_data[cid]) {
-                        m_value = (cid + 1) << (chunk_bits + 3);
-                    } else {
-                        const auto slot = m_set->m_data[cid][id_set::offset(m_value)];
-                        if (slot == 0) {
-                            m_value += 8;
-                            m_value &= ~0x7ULL;
-                        } else {
-                            ++m_value;
-                        }
+                    const auto* chunk = m_set->m_data[cid].get();
+                    if (!chunk) {
+                        m_value = static_cast<T>((cid + 1) << (chunk_bits + 3U));
+                        continue;
                     }
+                    const uint64_t word = chunk[id_set::offset(m_value)] >> (m_value & 0x3fU);
+                    if (word != 0) {
+                        m_value += static_cast<T>(detail::count_trailing_zeros(word));
+                        return;
+                    }
+                    m_value = (m_value | 0x3fU) + 1;
                 }
+                m_value = m_last;
             }
 
         public:
 
             using iterator_category = std::forward_iterator_tag;
             using value_type        = T;
+            using difference_type   = std::ptrdiff_t;
             using pointer           = value_type*;
             using reference         = value_type&;
 
@@ -193,20 +225,26 @@ namespace osmium {
          * as needed, so it works relatively efficiently with both smaller
          * and larger Id sets. If it is not used, no memory is allocated at
          * all.
+         *
+         * The bit fields are stored in 64 bit words, so the set operations
+         * (|=, &=, -=) and iterating over the set work on whole words at a
+         * time.
          */
         template <typename T, std::size_t chunk_bits>
         class IdSetDense : public IdSet<T> {
 
             static_assert(std::is_unsigned<T>::value, "Needs unsigned type");
             static_assert(sizeof(T) >= 4, "Needs at least 32bit type");
+            static_assert(chunk_bits >= 3, "chunk_bits must be at least 3");
 
             friend class IdSetDenseIterator<T, chunk_bits>;
 
             enum : std::size_t {
-                chunk_size = 1U << chunk_bits
+                chunk_size = 1U << chunk_bits,
+                words_per_chunk = chunk_size / sizeof(uint64_t)
             };
 
-            std::vector<std::unique_ptr<unsigned char[]>> m_data;
+            std::vector<std::unique_ptr<uint64_t[]>> m_data;
             T m_size = 0;
 
             static std::size_t chunk_id(T id) noexcept {
@@ -214,18 +252,22 @@ namespace osmium {
             }
 
             static std::size_t offset(T id) noexcept {
-                return (id >> 3U) & ((1U << chunk_bits) - 1U);
+                return (id >> 6U) & (words_per_chunk - 1U);
             }
 
-            static unsigned int bitmask(T id) noexcept {
-                return 1U << (id & 0x7U);
+            static uint64_t bitmask(T id) noexcept {
+                return 1ULL << (id & 0x3fU);
             }
 
             T last() const noexcept {
                 return static_cast<T>(m_data.size()) * chunk_size * 8;
             }
 
-            unsigned char& get_element(T id) {
+            static std::unique_ptr<uint64_t[]> new_chunk() {
+                return std::unique_ptr<uint64_t[]>{new uint64_t[words_per_chunk]()};
+            }
+
+            uint64_t& get_element(T id) {
                 const auto cid = chunk_id(id);
                 if (cid >= m_data.size()) {
                     m_data.resize(cid + 1);
@@ -233,13 +275,35 @@ namespace osmium {
 
                 auto& chunk = m_data[cid];
                 if (!chunk) {
-                    chunk.reset(new unsigned char[chunk_size]);
-                    ::memset(chunk.get(), 0, chunk_size);
+                    chunk = new_chunk();
                 }
 
                 return chunk[offset(id)];
             }
 
+            static T count_chunk(const uint64_t* chunk) noexcept {
+                T count = 0;
+                for (std::size_t i = 0; i < words_per_chunk; ++i) {
+                    count += static_cast<T>(detail::popcount(chunk[i]));
+                }
+                return count;
+            }
+
+            // Recalculate m_size after a set operation and free all chunks
+            // that became empty.
+            void recount() noexcept {
+                m_size = 0;
+                for (auto& chunk : m_data) {
+                    if (chunk) {
+                        const auto count = count_chunk(chunk.get());
+                        if (count == 0) {
+                            chunk.reset();
+                        }
+                        m_size += count;
+                    }
+                }
+            }
+
         public:
 
             using const_iterator = IdSetDenseIterator<T, chunk_bits>;
@@ -258,8 +322,8 @@ namespace osmium {
                 m_data.reserve(other.m_data.size());
                 for (const auto& ptr : other.m_data) {
                     if (ptr) {
-                        m_data.emplace_back(new unsigned char[chunk_size]);
-                        ::memcpy(m_data.back().get(), ptr.get(), chunk_size);
+                        m_data.emplace_back(new uint64_t[words_per_chunk]);
+                        std::copy_n(ptr.get(), words_per_chunk, m_data.back().get());
                     } else {
                         m_data.emplace_back();
                     }
@@ -362,6 +426,78 @@ namespace osmium {
                 return m_data.size() * chunk_size;
             }
 
+            /**
+             * Add all Ids in the other set to this set. Works on whole 64
+             * bit words at a time.
+             */
+            IdSetDense& operator|=(const IdSetDense& other) {
+                if (m_data.size() < other.m_data.size()) {
+                    m_data.resize(other.m_data.size());
+                }
+                for (std::size_t cid = 0; cid < other.m_data.size(); ++cid) {
+                    const uint64_t* src = other.m_data[cid].get();
+                    if (!src) {
+                        continue;
+                    }
+                    auto& chunk = m_data[cid];
+                    if (!chunk) {
+                        chunk.reset(new uint64_t[words_per_chunk]);
+                        std::copy_n(src, words_per_chunk, chunk.get());
+                        continue;
+                    }
+                    uint64_t* dest = chunk.get();
+                    for (std::size_t i = 0; i < words_per_chunk; ++i) {
+                        dest[i] |= src[i];
+                    }
+                }
+                recount();
+                return *this;
+            }
+
+            /**
+             * Remove all Ids from this set which are not in the other set.
+             * Works on whole 64 bit words at a time.
+             */
+            IdSetDense& operator&=(const IdSetDense& other) {
+                for (std::size_t cid = 0; cid < m_data.size(); ++cid) {
+                    auto& chunk = m_data[cid];
+                    if (!chunk) {
+                        continue;
+                    }
+                    const uint64_t* src = cid < other.m_data.size() ? other.m_data[cid].get() : nullptr;
+                    if (!src) {
+                        chunk.reset();
+                        continue;
+                    }
+                    uint64_t* dest = chunk.get();
+                    for (std::size_t i = 0; i < words_per_chunk; ++i) {
+                        dest[i] &= src[i];
+                    }
+                }
+                recount();
+                return *this;
+            }
+
+            /**
+             * Remove all Ids in the other set from this set. Works on whole
+             * 64 bit words at a time.
+             */
+            IdSetDense& operator-=(const IdSetDense& other) {
+                const auto num_chunks = std::min(m_data.size(), other.m_data.size());
+                for (std::size_t cid = 0; cid < num_chunks; ++cid) {
+                    const uint64_t* src = other.m_data[cid].get();
+                    if (!m_data[cid] || !src) {
+                        continue;
+                    }
+                    uint64_t* dest = m_data[cid].get();
+                    for (std::size_t i = 0; i < words_per_chunk; ++i) {
+                        dest[i] &= ~src[i];
+                    }
+                }
+                recount();
+                return *this;
+            }
+
             const_iterator begin() const {
                 return {this, 0, last()};
             }
@@ -372,6 +508,27 @@ namespace osmium {
 
         }; // class IdSetDense
 
+        /// Return union of the two sets.
+        template <typename T, std::size_t chunk_bits>
+        inline IdSetDense<T, chunk_bits> operator|(IdSetDense<T, chunk_bits> lhs, const IdSetDense<T, chunk_bits>& rhs) {
+            lhs |= rhs;
+            return lhs;
+        }
+
+        /// Return intersection of the two sets.
+        template <typename T, std::size_t chunk_bits>
+        inline IdSetDense<T, chunk_bits> operator&(IdSetDense<T, chunk_bits> lhs, const IdSetDense<T, chunk_bits>& rhs) {
+            lhs &= rhs;
+            return lhs;
+        }
+
+        /// Return difference of the two sets.
+        template <typename T, std::size_t chunk_bits>
+        inline IdSetDense<T, chunk_bits> operator-(IdSetDense<T, chunk_bits> lhs, const IdSetDense<T, chunk_bits>& rhs) {
+            lhs -= rhs;
+            return lhs;
+        }
+
         /**
          * IdSet implementation for small Id sets. It writes the Ids
          * into a vector and uses linear search.
@@ -503,6 +660,317 @@ namespace osmium {
 
         }; // class IdSetSmall
 
+        template <typename T, std::size_t chunk_bits = detail::default_chunk_bits>
+        class ConcurrentIdSetDense;
+
+        /**
+         * Const_iterator for iterating over a ConcurrentIdSetDense. Do not
+         * use while other threads are changing the set.
+         */
+        template <typename T, std::size_t chunk_bits>
+        class ConcurrentIdSetDenseIterator {
+
+            using id_set = ConcurrentIdSetDense<T, chunk_bits>;
+
+            const id_set* m_set;
+
+            // The position is kept in 64 bit, because the end of the last
+            // chunk doesn't fit into a 32 bit T.
+            uint64_t m_value;
+            uint64_t m_last;
+
+            void next() noexcept {
+                while (m_value < m_last) {
+                    const auto* chunk = m_set->chunk(id_set::chunk_id(m_value));
+                    if (!chunk) {
+                        m_value = static_cast<uint64_t>(id_set::chunk_id(m_value) + 1) << (chunk_bits + 3U);
+                        continue;
+                    }
+                    const uint64_t word = chunk[id_set::word_offset(m_value)].load(std::memory_order_relaxed) >> (m_value & 0x3fU);
+                    if (word != 0) {
+                        m_value += static_cast<uint64_t>(detail::count_trailing_zeros(word));
+                        return;
+                    }
+                    m_value = (m_value | 0x3fU) + 1;
+                }
+                m_value = m_last;
+            }
+
+        public:
+
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = T;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = value_type*;
+            using reference         = value_type&;
+
+            ConcurrentIdSetDenseIterator(const id_set* set, uint64_t value, uint64_t last) noexcept :
+                m_set(set),
+                m_value(value),
+                m_last(last) {
+                next();
+            }
+
+            ConcurrentIdSetDenseIterator& operator++() noexcept {
+                if (m_value != m_last) {
+                    ++m_value;
+                    next();
+                }
+                return *this;
+            }
+
+            ConcurrentIdSetDenseIterator operator++(int) noexcept {
+                ConcurrentIdSetDenseIterator tmp{*this};
+                operator++();
+                return tmp;
+            }
+
+            bool operator==(const ConcurrentIdSetDenseIterator& rhs) const noexcept {
+                return m_set == rhs.m_set && m_value == rhs.m_value;
+            }
+
+            bool operator!=(const ConcurrentIdSetDenseIterator& rhs) const noexcept {
+                return !(*this == rhs);
+            }
+
+            T operator*() const noexcept {
+                assert(m_value < m_last);
+                return static_cast<T>(m_value);
+            }
+
+        }; // class ConcurrentIdSetDenseIterator
+
+        /**
+         * A set of Ids of the given type that can be filled from several
+         * threads at the same time. Like IdSetDense the storage is in
+         * chunks used as bit fields which are allocated as needed. Chunks
+         * are allocated lock-free using compare-and-swap on a table of
+         * chunk pointers, bits are set using atomic fetch_or operations.
+         *
+         * Because the chunk table can not be resized while other threads
+         * access it, the largest Id that can be stored has to be set in
+         * the constructor. The default allows all Ids up to 2^40, which is
+         * enough for OSM object Ids for the foreseeable future.
+         *
+         * The functions set(), check_and_set(), unset(), get(), and
+         * merge() can be called concurrently from several threads. All
+         * other functions must not be called while the set is changed.
+         *
+         * There is no counter kept of the number of Ids in the set,
+         * because that would be a point of contention between threads.
+         * Instead size() counts the bits set in all chunks.
+         */
+        template <typename T, std::size_t chunk_bits>
+        class ConcurrentIdSetDense : public IdSet<T> {
+
+            static_assert(std::is_unsigned<T>::value, "Needs unsigned type");
+            static_assert(sizeof(T) >= 4, "Needs at least 32bit type");
+            static_assert(chunk_bits >= 3, "chunk_bits must be at least 3");
+
+            friend class ConcurrentIdSetDenseIterator<T, chunk_bits>;
+
+            using word_type = std::atomic<uint64_t>;
+
+            enum : std::size_t {
+                chunk_size = 1U << chunk_bits,
+                words_per_chunk = chunk_size / sizeof(uint64_t)
+            };
+
+            std::size_t m_num_chunks;
+            std::unique_ptr<std::atomic<word_type*>[]> m_chunks;
+
+            static std::size_t chunk_id(uint64_t id) noexcept {
+                return static_cast<std::size_t>(id >> (chunk_bits + 3U));
+            }
+
+            static std::size_t word_offset(uint64_t id) noexcept {
+                return static_cast<std::size_t>(id >> 6U) & (words_per_chunk - 1U);
+            }
+
+            static uint64_t bitmask(T id) noexcept {
+                return 1ULL << (id & 0x3fU);
+            }
+
+            static T default_max_id() noexcept {
+                return static_cast<T>(std::min<uint64_t>(std::numeric_limits<T>::max(), (1ULL << 40U) - 1));
+            }
+
+            // One past the last Id in the last chunk. This doesn't fit
+            // into T if T is a 32 bit type.
+            uint64_t last() const noexcept {
+                return static_cast<uint64_t>(m_num_chunks) << (chunk_bits + 3U);
+            }
+
+            const word_type* chunk(std::size_t cid) const noexcept {
+                return m_chunks[cid].load(std::memory_order_acquire);
+            }
+
+            word_type& get_element(T id) {
+                const auto cid = chunk_id(id);
+                if (cid >= m_num_chunks) {
+                    throw std::out_of_range{"Id too large for ConcurrentIdSetDense"};
+                }
+
+                word_type* chunk = m_chunks[cid].load(std::memory_order_acquire);
+                if (!chunk) {
+                    std::unique_ptr<word_type[]> new_chunk{new word_type[words_per_chunk]()};
+                    if (m_chunks[cid].compare_exchange_strong(chunk, new_chunk.get(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+                        chunk = new_chunk.release();
+                    }
+                    // If the exchange failed, another thread was faster,
+                    // chunk now points to its chunk and ours is freed.
+                }
+
+                return chunk[word_offset(id)];
+            }
+
+            void free_chunks() noexcept {
+                for (std::size_t i = 0; i < m_num_chunks; ++i) {
+                    delete[] m_chunks[i].exchange(nullptr);
+                }
+            }
+
+        public:
+
+            using const_iterator = ConcurrentIdSetDenseIterator<T, chunk_bits>;
+
+            /**
+             * Create empty set.
+             *
+             * @param max_id The largest Id that can be stored in this set.
+             */
+            explicit ConcurrentIdSetDense(T max_id = default_max_id()) :
+                m_num_chunks(chunk_id(max_id) + 1),
+                m_chunks(new std::atomic<word_type*>[m_num_chunks]()) {
+            }
+
+            ConcurrentIdSetDense(const ConcurrentIdSetDense&) = delete;
+            ConcurrentIdSetDense& operator=(const ConcurrentIdSetDense&) = delete;
+
+            ConcurrentIdSetDense(ConcurrentIdSetDense&&) = delete;
+            ConcurrentIdSetDense& operator=(ConcurrentIdSetDense&&) = delete;
+
+            ~ConcurrentIdSetDense() noexcept override {
+                free_chunks();
+            }
+
+            /**
+             * Add the Id to the set if it is not already in there.
+             *
+             * @param id The Id to set.
+             * @returns true if the Id was added, false if it was already set.
+             * @throws std::out_of_range if the Id is larger than max_id.
+             */
+            bool check_and_set(T id) {
+                const auto mask = bitmask(id);
+                return (get_element(id).fetch_or(mask, std::memory_order_relaxed) & mask) == 0;
+            }
+
+            /**
+             * Add the given Id to the set.
+             *
+             * @param id The Id to set.
+             * @throws std::out_of_range if the Id is larger than max_id.
+             */
+            void set(T id) final {
+                (void)check_and_set(id);
+            }
+
+            /**
+             * Remove the given Id from the set.
+             *
+             * @param id The Id to unset.
+             */
+            void unset(T id) {
+                if (chunk_id(id) >= m_num_chunks) {
+                    return;
+                }
+                auto* c = m_chunks[chunk_id(id)].load(std::memory_order_acquire);
+                if (c) {
+                    c[word_offset(id)].fetch_and(~bitmask(id), std::memory_order_relaxed);
+                }
+            }
+
+            /**
+             * Is the Id in the set?
+             *
+             * @param id The Id to check.
+             */
+            bool get(T id) const noexcept final {
+                if (chunk_id(id) >= m_num_chunks) {
+                    return false;
+                }
+                const auto* c = chunk(chunk_id(id));
+                if (!c) {
+                    return false;
+                }
+                return (c[word_offset(id)].load(std::memory_order_relaxed) & bitmask(id)) != 0;
+            }
+
+            /**
+             * Add all Ids from the other set to this set. This can be used
+             * to combine per-thread IdSetSmall sets into one set. Several
+             * threads can merge into the same set at the same time.
+             *
+             * @throws std::out_of_range if an Id is larger than max_id.
+             */
+            void merge(const IdSetSmall<T>& other) {
+                for (const T id : other) {
+                    set(id);
+                }
+            }
+
+            /**
+             * Is the set empty?
+             */
+            bool empty() const noexcept final {
+                return begin() == end();
+            }
+
+            /**
+             * The number of Ids stored in the set. This has to look at
+             * all allocated chunks, so it is not a cheap operation.
+             */
+            T size() const noexcept {
+                T count = 0;
+                for (std::size_t cid = 0; cid < m_num_chunks; ++cid) {
+                    const auto* c = chunk(cid);
+                    if (c) {
+                        for (std::size_t i = 0; i < words_per_chunk; ++i) {
+                            count += static_cast<T>(detail::popcount(c[i].load(std::memory_order_relaxed)));
+                        }
+                    }
+                }
+                return count;
+            }
+
+            /**
+             * Clear the set.
+             */
+            void clear() final {
+                free_chunks();
+            }
+
+            std::size_t used_memory() const noexcept final {
+                std::size_t memory = m_num_chunks * sizeof(word_type*);
+                for (std::size_t cid = 0; cid < m_num_chunks; ++cid) {
+                    if (chunk(cid)) {
+                        memory += chunk_size;
+                    }
+                }
+                return memory;
+            }
+
+            const_iterator begin() const noexcept {
+                return {this, 0, last()};
+            }
+
+            const_iterator end() const noexcept {
+                return {this, last(), last()};
+            }
+
+        }; // class ConcurrentIdSetDense
+
     } // namespace index
 
 } // namespace osmium
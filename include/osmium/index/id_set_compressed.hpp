@@ -0,0 +1,985 @@
+#ifndef OSMIUM_INDEX_ID_SET_COMPRESSED_HPP
+#define OSMIUM_INDEX_ID_SET_COMPRESSED_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/id_set.hpp>
+#include <osmium/io/detail/read_write.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace detail {
+
+            /**
+             * Container for up to 2^16 values used in IdSetCompressed.
+             * Depending on the data it stores the values as sorted array
+             * (for sparse data), as bitmap (for dense data), or as list of
+             * runs of consecutive values (for clustered data).
+             */
+            class id_set_container {
+
+            public:
+
+                enum class container_type : uint32_t {
+                    array  = 0,
+                    bitmap = 1,
+                    run    = 2
+                };
+
+                /// A run of consecutive values from start to start + length (inclusive).
+                struct run_type {
+                    uint16_t start;
+                    uint16_t length;
+                };
+
+                enum : uint32_t {
+                    // Above this cardinality bitmaps need less memory than arrays.
+                    max_array_size = 4096U,
+                    bitmap_words   = 1024U,
+                    end_value      = 1U << 16U
+                };
+
+            private:
+
+                container_type m_type = container_type::array;
+                uint32_t m_cardinality = 0;
+                std::vector<uint16_t> m_array;
+                std::vector<uint64_t> m_bitmap;
+                std::vector<run_type> m_runs;
+
+                static uint32_t run_end(const run_type& run) noexcept {
+                    return static_cast<uint32_t>(run.start) + run.length;
+                }
+
+                static uint64_t bitmask(uint32_t value) noexcept {
+                    return 1ULL << (value & 0x3fU);
+                }
+
+                // Return iterator to the first run that ends at or after value.
+                std::vector<run_type>::const_iterator find_run(uint32_t value) const noexcept {
+                    return std::lower_bound(m_runs.cbegin(), m_runs.cend(), value, [](const run_type& run, uint32_t v) {
+                        return run_end(run) < v;
+                    });
+                }
+
+                std::vector<uint64_t> make_bitmap() const {
+                    if (m_type == container_type::bitmap) {
+                        return m_bitmap;
+                    }
+                    std::vector<uint64_t> bitmap(bitmap_words, 0);
+                    if (m_type == container_type::array) {
+                        for (const auto value : m_array) {
+                            bitmap[value >> 6U] |= bitmask(value);
+                        }
+                    } else {
+                        for (const auto& run : m_runs) {
+                            for (uint32_t value = run.start; value <= run_end(run); ++value) {
+                                bitmap[value >> 6U] |= bitmask(value);
+                            }
+                        }
+                    }
+                    return bitmap;
+                }
+
+                std::vector<uint16_t> make_array() const {
+                    std::vector<uint16_t> array;
+                    array.reserve(m_cardinality);
+                    for (uint32_t value = next(0); value != end_value; value = next(value + 1)) {
+                        array.push_back(static_cast<uint16_t>(value));
+                    }
+                    return array;
+                }
+
+                void set_bitmap(std::vector<uint64_t>&& bitmap) {
+                    m_bitmap = std::move(bitmap);
+                    m_cardinality = 0;
+                    for (const auto word : m_bitmap) {
+                        m_cardinality += static_cast<uint32_t>(popcount(word));
+                    }
+                    m_array.clear();
+                    m_array.shrink_to_fit();
+                    m_runs.clear();
+                    m_runs.shrink_to_fit();
+                    m_type = container_type::bitmap;
+                    if (m_cardinality <= max_array_size) {
+                        convert_to_array();
+                    }
+                }
+
+                void set_array(std::vector<uint16_t>&& array) {
+                    m_array = std::move(array);
+                    m_cardinality = static_cast<uint32_t>(m_array.size());
+                    m_bitmap.clear();
+                    m_bitmap.shrink_to_fit();
+                    m_runs.clear();
+                    m_runs.shrink_to_fit();
+                    m_type = container_type::array;
+                    if (m_cardinality > max_array_size) {
+                        convert_to_bitmap();
+                    }
+                }
+
+                void convert_to_array() {
+                    auto array = make_array();
+                    m_bitmap.clear();
+                    m_bitmap.shrink_to_fit();
+                    m_runs.clear();
+                    m_runs.shrink_to_fit();
+                    m_array = std::move(array);
+                    m_type = container_type::array;
+                }
+
+                void convert_to_bitmap() {
+                    auto bitmap = make_bitmap();
+                    m_array.clear();
+                    m_array.shrink_to_fit();
+                    m_runs.clear();
+                    m_runs.shrink_to_fit();
+                    m_bitmap = std::move(bitmap);
+                    m_type = container_type::bitmap;
+                }
+
+                // Run containers are not updated in place, convert them
+                // to one of the other types before changing them.
+                void make_mutable() {
+                    if (m_type == container_type::run) {
+                        if (m_cardinality > max_array_size) {
+                            convert_to_bitmap();
+                        } else {
+                            convert_to_array();
+                        }
+                    }
+                }
+
+                template <typename TFunc>
+                std::vector<uint16_t> filter_array(const std::vector<uint16_t>& array, TFunc&& func) const {
+                    std::vector<uint16_t> result;
+                    result.reserve(array.size());
+                    std::copy_if(array.cbegin(), array.cend(), std::back_inserter(result), std::forward<TFunc>(func));
+                    return result;
+                }
+
+            public:
+
+                container_type type() const noexcept {
+                    return m_type;
+                }
+
+                uint32_t cardinality() const noexcept {
+                    return m_cardinality;
+                }
+
+                bool empty() const noexcept {
+                    return m_cardinality == 0;
+                }
+
+                bool get(uint16_t value) const noexcept {
+                    switch (m_type) {
+                        case container_type::array:
+                            return std::binary_search(m_array.cbegin(), m_array.cend(), value);
+                        case container_type::bitmap:
+                            return (m_bitmap[value >> 6U] & bitmask(value)) != 0;
+                        default: { // container_type::run
+                            const auto it = find_run(value);
+                            return it != m_runs.cend() && it->start <= value;
+                        }
+                    }
+                }
+
+                /**
+                 * Add value to container.
+                 *
+                 * @returns true if the value was added, false if it was
+                 *          already in the container.
+                 */
+                bool set(uint16_t value) {
+                    if (m_type == container_type::run) {
+                        if (get(value)) {
+                            return false;
+                        }
+                        make_mutable();
+                    }
+                    if (m_type == container_type::array) {
+                        const auto it = std::lower_bound(m_array.begin(), m_array.end(), value);
+                        if (it != m_array.end() && *it == value) {
+                            return false;
+                        }
+                        m_array.insert(it, value);
+                        ++m_cardinality;
+                        if (m_cardinality > max_array_size) {
+                            convert_to_bitmap();
+                        }
+                        return true;
+                    }
+                    auto& word = m_bitmap[value >> 6U];
+                    if ((word & bitmask(value)) != 0) {
+                        return false;
+                    }
+                    word |= bitmask(value);
+                    ++m_cardinality;
+                    return true;
+                }
+
+                /**
+                 * Remove value from container.
+                 *
+                 * @returns true if the value was removed, false if it was
+                 *          not in the container.
+                 */
+                bool unset(uint16_t value) {
+                    if (!get(value)) {
+                        return false;
+                    }
+                    make_mutable();
+                    --m_cardinality;
+                    if (m_type == container_type::array) {
+                        m_array.erase(std::lower_bound(m_array.begin(), m_array.end(), value));
+                        return true;
+                    }
+                    m_bitmap[value >> 6U] &= ~bitmask(value);
+                    if (m_cardinality <= max_array_size) {
+                        convert_to_array();
+                    }
+                    return true;
+                }
+
+                /**
+                 * Return the smallest value in the container larger than or
+                 * equal to the given value or end_value if there is none.
+                 */
+                uint32_t next(uint32_t value) const noexcept {
+                    if (value >= end_value) {
+                        return end_value;
+                    }
+                    switch (m_type) {
+                        case container_type::array: {
+                            const auto it = std::lower_bound(m_array.cbegin(), m_array.cend(), value);
+                            return it == m_array.cend() ? static_cast<uint32_t>(end_value) : *it;
+                        }
+                        case container_type::bitmap: {
+                            uint32_t n = value >> 6U;
+                            uint64_t word = m_bitmap[n] & (~0ULL << (value & 0x3fU));
+                            while (word == 0) {
+                                if (++n == bitmap_words) {
+                                    return end_value;
+                                }
+                                word = m_bitmap[n];
+                            }
+                            return (n << 6U) + static_cast<uint32_t>(count_trailing_zeros(word));
+                        }
+                        default: { // container_type::run
+                            const auto it = find_run(value);
+                            if (it == m_runs.cend()) {
+                                return end_value;
+                            }
+                            return std::max(value, static_cast<uint32_t>(it->start));
+                        }
+                    }
+                }
+
+                /**
+                 * Convert into a run container if that needs less memory.
+                 *
+                 * @returns true if the container was converted.
+                 */
+                bool optimize() {
+                    if (m_type == container_type::run || m_cardinality == 0) {
+                        return false;
+                    }
+                    std::vector<run_type> runs;
+                    for (uint32_t value = next(0); value != end_value;) {
+                        uint32_t last = value;
+                        while (last + 1 < end_value && get(static_cast<uint16_t>(last + 1))) {
+                            ++last;
+                        }
+                        runs.push_back(run_type{static_cast<uint16_t>(value), static_cast<uint16_t>(last - value)});
+                        value = next(last + 1);
+                    }
+                    if (runs.size() * sizeof(run_type) >= memory()) {
+                        return false;
+                    }
+                    m_array.clear();
+                    m_array.shrink_to_fit();
+                    m_bitmap.clear();
+                    m_bitmap.shrink_to_fit();
+                    m_runs = std::move(runs);
+                    m_runs.shrink_to_fit();
+                    m_type = container_type::run;
+                    return true;
+                }
+
+                void union_with(const id_set_container& other) {
+                    if (m_type == container_type::array && other.m_type == container_type::array) {
+                        std::vector<uint16_t> result;
+                        result.reserve(m_array.size() + other.m_array.size());
+                        std::set_union(m_array.cbegin(), m_array.cend(),
+                                       other.m_array.cbegin(), other.m_array.cend(),
+                                       std::back_inserter(result));
+                        set_array(std::move(result));
+                        return;
+                    }
+                    auto bitmap = make_bitmap();
+                    const auto other_bitmap = other.make_bitmap();
+                    for (std::size_t i = 0; i < bitmap_words; ++i) {
+                        bitmap[i] |= other_bitmap[i];
+                    }
+                    set_bitmap(std::move(bitmap));
+                }
+
+                void intersect_with(const id_set_container& other) {
+                    if (other.m_type == container_type::array) {
+                        set_array(other.filter_array(other.m_array, [this](uint16_t value) {
+                            return get(value);
+                        }));
+                        return;
+                    }
+                    if (m_type != container_type::bitmap) {
+                        set_array(filter_array(make_array(), [&other](uint16_t value) {
+                            return other.get(value);
+                        }));
+                        return;
+                    }
+                    auto bitmap = make_bitmap();
+                    const auto other_bitmap = other.make_bitmap();
+                    for (std::size_t i = 0; i < bitmap_words; ++i) {
+                        bitmap[i] &= other_bitmap[i];
+                    }
+                    set_bitmap(std::move(bitmap));
+                }
+
+                void subtract(const id_set_container& other) {
+                    if (m_type != container_type::bitmap) {
+                        set_array(filter_array(make_array(), [&other](uint16_t value) {
+                            return !other.get(value);
+                        }));
+                        return;
+                    }
+                    auto bitmap = make_bitmap();
+                    const auto other_bitmap = other.make_bitmap();
+                    for (std::size_t i = 0; i < bitmap_words; ++i) {
+                        bitmap[i] &= ~other_bitmap[i];
+                    }
+                    set_bitmap(std::move(bitmap));
+                }
+
+                std::size_t memory() const noexcept {
+                    return m_array.capacity() * sizeof(uint16_t) +
+                           m_bitmap.capacity() * sizeof(uint64_t) +
+                           m_runs.capacity() * sizeof(run_type);
+                }
+
+                /// Append serialized form of this container to out.
+                void serialize(std::string& out) const {
+                    const uint32_t header[3] = {
+                        static_cast<uint32_t>(m_type),
+                        m_cardinality,
+                        static_cast<uint32_t>(m_type == container_type::array ? m_array.size() :
+                                              m_type == container_type::bitmap ? m_bitmap.size() : m_runs.size())
+                    };
+                    out.append(reinterpret_cast<const char*>(header), sizeof(header));
+                    switch (m_type) {
+                        case container_type::array:
+                            out.append(reinterpret_cast<const char*>(m_array.data()), m_array.size() * sizeof(uint16_t));
+                            break;
+                        case container_type::bitmap:
+                            out.append(reinterpret_cast<const char*>(m_bitmap.data()), m_bitmap.size() * sizeof(uint64_t));
+                            break;
+                        default: // container_type::run
+                            out.append(reinterpret_cast<const char*>(m_runs.data()), m_runs.size() * sizeof(run_type));
+                    }
+                }
+
+                /**
+                 * Read container from serialized data.
+                 *
+                 * @returns Pointer to data after this container.
+                 * @throws std::runtime_error if the data is invalid.
+                 */
+                const char* deserialize(const char* data, const char* end) {
+                    uint32_t header[3];
+                    if (static_cast<std::size_t>(end - data) < sizeof(header)) {
+                        throw std::runtime_error{"invalid IdSetCompressed data: truncated"};
+                    }
+                    std::memcpy(header, data, sizeof(header));
+                    data += sizeof(header);
+
+                    const uint32_t size = header[2];
+
+                    // Check before allocating memory for the contents.
+                    const auto check_available = [&data, end](std::size_t bytes) {
+                        if (static_cast<std::size_t>(end - data) < bytes) {
+                            throw std::runtime_error{"invalid IdSetCompressed data: truncated"};
+                        }
+                    };
+
+                    const auto read = [&data](void* dest, std::size_t bytes) {
+                        std::memcpy(dest, data, bytes);
+                        data += bytes;
+                    };
+
+                    m_type = static_cast<container_type>(header[0]);
+                    m_cardinality = 0;
+                    m_array.clear();
+                    m_bitmap.clear();
+                    m_runs.clear();
+                    switch (m_type) {
+                        case container_type::array:
+                            if (size == 0 || size > max_array_size) {
+                                throw std::runtime_error{"invalid IdSetCompressed data: wrong array size"};
+                            }
+                            check_available(size * sizeof(uint16_t));
+                            m_array.resize(size);
+                            read(m_array.data(), m_array.size() * sizeof(uint16_t));
+                            for (std::size_t i = 1; i < m_array.size(); ++i) {
+                                if (m_array[i - 1] >= m_array[i]) {
+                                    throw std::runtime_error{"invalid IdSetCompressed data: array not sorted"};
+                                }
+                            }
+                            m_cardinality = size;
+                            break;
+                        case container_type::bitmap:
+                            if (size != bitmap_words) {
+                                throw std::runtime_error{"invalid IdSetCompressed data: wrong bitmap size"};
+                            }
+                            check_available(size * sizeof(uint64_t));
+                            m_bitmap.resize(size);
+                            read(m_bitmap.data(), m_bitmap.size() * sizeof(uint64_t));
+                            for (const auto word : m_bitmap) {
+                                m_cardinality += static_cast<uint32_t>(popcount(word));
+                            }
+                            if (m_cardinality <= max_array_size) {
+                                throw std::runtime_error{"invalid IdSetCompressed data: bitmap too small"};
+                            }
+                            break;
+                        case container_type::run:
+                            // Runs that don't touch each other leave at
+                            // least one value between them.
+                            if (size == 0 || size > end_value / 2) {
+                                throw std::runtime_error{"invalid IdSetCompressed data: wrong number of runs"};
+                            }
+                            check_available(size * sizeof(run_type));
+                            m_runs.resize(size);
+                            read(m_runs.data(), m_runs.size() * sizeof(run_type));
+                            for (std::size_t i = 0; i < m_runs.size(); ++i) {
+                                if (run_end(m_runs[i]) >= end_value ||
+                                    (i > 0 && m_runs[i].start <= run_end(m_runs[i - 1]) + 1)) {
+                                    throw std::runtime_error{"invalid IdSetCompressed data: invalid run"};
+                                }
+                                m_cardinality += static_cast<uint32_t>(m_runs[i].length) + 1;
+                            }
+                            break;
+                        default:
+                            throw std::runtime_error{"invalid IdSetCompressed data: unknown container type"};
+                    }
+
+                    if (m_cardinality != header[1]) {
+                        throw std::runtime_error{"invalid IdSetCompressed data: wrong cardinality"};
+                    }
+
+                    return data;
+                }
+
+            }; // class id_set_container
+
+        } // namespace detail
+
+        template <typename T>
+        class IdSetCompressed;
+
+        /**
+         * Const_iterator for iterating over a IdSetCompressed.
+         */
+        template <typename T>
+        class IdSetCompressedIterator {
+
+            using id_set = IdSetCompressed<T>;
+
+            const id_set* m_set;
+            std::size_t m_block;
+            uint32_t m_value;
+
+            void next() noexcept {
+                while (m_block < m_set->m_blocks.size()) {
+                    m_value = m_set->m_blocks[m_block].container.next(m_value);
+                    if (m_value != detail::id_set_container::end_value) {
+                        return;
+                    }
+                    ++m_block;
+                    m_value = 0;
+                }
+            }
+
+        public:
+
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = T;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = value_type*;
+            using reference         = value_type&;
+
+            IdSetCompressedIterator(const id_set* set, std::size_t block) noexcept :
+                m_set(set),
+                m_block(block),
+                m_value(0) {
+                next();
+            }
+
+            IdSetCompressedIterator& operator++() noexcept {
+                ++m_value;
+                next();
+                return *this;
+            }
+
+            IdSetCompressedIterator operator++(int) noexcept {
+                IdSetCompressedIterator tmp{*this};
+                operator++();
+                return tmp;
+            }
+
+            bool operator==(const IdSetCompressedIterator& rhs) const noexcept {
+                return m_set == rhs.m_set && m_block == rhs.m_block && m_value == rhs.m_value;
+            }
+
+            bool operator!=(const IdSetCompressedIterator& rhs) const noexcept {
+                return !(*this == rhs);
+            }
+
+            T operator*() const noexcept {
+                assert(m_block < m_set->m_blocks.size());
+                return static_cast<T>((m_set->m_blocks[m_block].key << 16U) | m_value);
+            }
+
+        }; // class IdSetCompressedIterator
+
+        /**
+         * A compressed set of Ids of the given type, similar to "roaring
+         * bitmaps". The Id space is split into blocks of 2^16 Ids, for
+         * each block with at least one Id in it, a container is kept.
+         * Depending on the number of Ids in a block, the container stores
+         * them as sorted array of 16 bit values or as bitmap. Call
+         * optimize() to convert containers with clustered Ids into lists
+         * of runs of consecutive Ids.
+         *
+         * This needs much less memory than IdSetDense for sets of medium
+         * density, for instance when Ids are spread out over a large range.
+         *
+         * The set can be dumped into a file and loaded back, for instance
+         * to use it in several passes.
+         */
+        template <typename T>
+        class IdSetCompressed : public IdSet<T> {
+
+            static_assert(std::is_unsigned<T>::value, "Needs unsigned type");
+            static_assert(sizeof(T) >= 4, "Needs at least 32bit type");
+
+            friend class IdSetCompressedIterator<T>;
+
+            struct block {
+                T key;
+                detail::id_set_container container;
+            };
+
+            std::vector<block> m_blocks;
+            T m_size = 0;
+
+            static T block_key(T id) noexcept {
+                return id >> 16U;
+            }
+
+            static uint16_t low_bits(T id) noexcept {
+                return static_cast<uint16_t>(id & 0xffffU);
+            }
+
+            typename std::vector<block>::const_iterator find_block(T key) const noexcept {
+                return std::lower_bound(m_blocks.cbegin(), m_blocks.cend(), key, [](const block& b, T k) {
+                    return b.key < k;
+                });
+            }
+
+            typename std::vector<block>::iterator find_block(T key) noexcept {
+                // Fast path for Ids set in order.
+                if (!m_blocks.empty() && m_blocks.back().key == key) {
+                    return std::prev(m_blocks.end());
+                }
+                return std::lower_bound(m_blocks.begin(), m_blocks.end(), key, [](const block& b, T k) {
+                    return b.key < k;
+                });
+            }
+
+            void remove_empty_blocks() {
+                m_blocks.erase(std::remove_if(m_blocks.begin(), m_blocks.end(), [](const block& b) {
+                    return b.container.empty();
+                }), m_blocks.end());
+            }
+
+            void recalculate_size() noexcept {
+                m_size = 0;
+                for (const auto& b : m_blocks) {
+                    m_size += b.container.cardinality();
+                }
+            }
+
+            enum : uint32_t {
+                serialize_byte_order = 0x01020304U
+            };
+
+            static constexpr const char* serialize_magic() noexcept {
+                return "OSMIDSC1";
+            }
+
+        public:
+
+            using const_iterator = IdSetCompressedIterator<T>;
+
+            IdSetCompressed() = default;
+
+            /**
+             * Add the Id to the set if it is not already in there.
+             *
+             * @param id The Id to set.
+             * @returns true if the Id was added, false if it was already set.
+             */
+            bool check_and_set(T id) {
+                const T key = block_key(id);
+                auto it = find_block(key);
+                if (it == m_blocks.end() || it->key != key) {
+                    it = m_blocks.insert(it, block{key, detail::id_set_container{}});
+                }
+                if (it->container.set(low_bits(id))) {
+                    ++m_size;
+                    return true;
+                }
+                return false;
+            }
+
+            /**
+             * Add the given Id to the set.
+             *
+             * @param id The Id to set.
+             */
+            void set(T id) final {
+                (void)check_and_set(id);
+            }
+
+            /**
+             * Remove the given Id from the set.
+             *
+             * @param id The Id to unset.
+             */
+            void unset(T id) {
+                const T key = block_key(id);
+                const auto it = find_block(key);
+                if (it == m_blocks.end() || it->key != key) {
+                    return;
+                }
+                if (it->container.unset(low_bits(id))) {
+                    --m_size;
+                    if (it->container.empty()) {
+                        m_blocks.erase(it);
+                    }
+                }
+            }
+
+            /**
+             * Is the Id in the set?
+             *
+             * @param id The Id to check.
+             */
+            bool get(T id) const noexcept final {
+                const T key = block_key(id);
+                const auto it = find_block(key);
+                if (it == m_blocks.cend() || it->key != key) {
+                    return false;
+                }
+                return it->container.get(low_bits(id));
+            }
+
+            /**
+             * Is the set empty?
+             */
+            bool empty() const noexcept final {
+                return m_size == 0;
+            }
+
+            /**
+             * The number of Ids stored in the set.
+             */
+            T size() const noexcept {
+                return m_size;
+            }
+
+            /**
+             * Clear the set.
+             */
+            void clear() final {
+                m_blocks.clear();
+                m_size = 0;
+            }
+
+            std::size_t used_memory() const noexcept final {
+                std::size_t memory = m_blocks.capacity() * sizeof(block);
+                for (const auto& b : m_blocks) {
+                    memory += b.container.memory();
+                }
+                return memory;
+            }
+
+            /**
+             * Convert the containers where this saves memory into lists of
+             * runs of consecutive Ids. Call this after the set is filled.
+             * Changing a block after this is more expensive, because its
+             * container will be converted back first.
+             */
+            void optimize() {
+                for (auto& b : m_blocks) {
+                    b.container.optimize();
+                }
+                m_blocks.shrink_to_fit();
+            }
+
+            /**
+             * Add all Ids in the other set to this set.
+             */
+            IdSetCompressed& operator|=(const IdSetCompressed& other) {
+                std::vector<block> result;
+                result.reserve(m_blocks.size() + other.m_blocks.size());
+                auto it = m_blocks.begin();
+                for (const auto& b : other.m_blocks) {
+                    for (; it != m_blocks.end() && it->key < b.key; ++it) {
+                        result.push_back(std::move(*it));
+                    }
+                    if (it != m_blocks.end() && it->key == b.key) {
+                        result.push_back(std::move(*it));
+                        result.back().container.union_with(b.container);
+                        ++it;
+                    } else {
+                        result.push_back(b);
+                    }
+                }
+                std::move(it, m_blocks.end(), std::back_inserter(result));
+                using std::swap;
+                swap(m_blocks, result);
+                recalculate_size();
+                return *this;
+            }
+
+            /**
+             * Remove all Ids from this set which are not in the other set.
+             */
+            IdSetCompressed& operator&=(const IdSetCompressed& other) {
+                auto it = other.m_blocks.cbegin();
+                for (auto& b : m_blocks) {
+                    while (it != other.m_blocks.cend() && it->key < b.key) {
+                        ++it;
+                    }
+                    if (it != other.m_blocks.cend() && it->key == b.key) {
+                        b.container.intersect_with(it->container);
+                    } else {
+                        b.container = detail::id_set_container{};
+                    }
+                }
+                remove_empty_blocks();
+                recalculate_size();
+                return *this;
+            }
+
+            /**
+             * Remove all Ids in the other set from this set.
+             */
+            IdSetCompressed& operator-=(const IdSetCompressed& other) {
+                auto it = other.m_blocks.cbegin();
+                for (auto& b : m_blocks) {
+                    while (it != other.m_blocks.cend() && it->key < b.key) {
+                        ++it;
+                    }
+                    if (it != other.m_blocks.cend() && it->key == b.key) {
+                        b.container.subtract(it->container);
+                    }
+                }
+                remove_empty_blocks();
+                recalculate_size();
+                return *this;
+            }
+
+            /**
+             * Write the set into a string. The format uses the native byte
+             * order, so it can only be read on systems with the same byte
+             * order.
+             */
+            std::string serialize() const {
+                std::string out{serialize_magic(), 8};
+                const uint32_t byte_order = serialize_byte_order;
+                out.append(reinterpret_cast<const char*>(&byte_order), sizeof(byte_order));
+                const uint64_t num_blocks = m_blocks.size();
+                out.append(reinterpret_cast<const char*>(&num_blocks), sizeof(num_blocks));
+                for (const auto& b : m_blocks) {
+                    const uint64_t key = b.key;
+                    out.append(reinterpret_cast<const char*>(&key), sizeof(key));
+                    b.container.serialize(out);
+                }
+                return out;
+            }
+
+            /**
+             * Replace the contents of this set with the set serialized in
+             * the data.
+             *
+             * @throws std::runtime_error if the data is invalid.
+             */
+            void deserialize(const std::string& data) {
+                const char* ptr = data.data();
+                const char* const end = ptr + data.size();
+
+                uint32_t byte_order = 0;
+                uint64_t num_blocks = 0;
+                if (data.size() < 8 + sizeof(byte_order) + sizeof(num_blocks) ||
+                    std::memcmp(ptr, serialize_magic(), 8) != 0) {
+                    throw std::runtime_error{"invalid IdSetCompressed data: wrong magic"};
+                }
+                ptr += 8;
+                std::memcpy(&byte_order, ptr, sizeof(byte_order));
+                ptr += sizeof(byte_order);
+                if (byte_order != serialize_byte_order) {
+                    throw std::runtime_error{"invalid IdSetCompressed data: wrong byte order"};
+                }
+                std::memcpy(&num_blocks, ptr, sizeof(num_blocks));
+                ptr += sizeof(num_blocks);
+
+                // Each block needs at least its key and a container header.
+                if (num_blocks > static_cast<std::size_t>(end - ptr) / (sizeof(uint64_t) + 3 * sizeof(uint32_t))) {
+                    throw std::runtime_error{"invalid IdSetCompressed data: truncated"};
+                }
+
+                std::vector<block> blocks;
+                blocks.reserve(static_cast<std::size_t>(num_blocks));
+                for (uint64_t i = 0; i < num_blocks; ++i) {
+                    uint64_t key = 0;
+                    if (static_cast<std::size_t>(end - ptr) < sizeof(key)) {
+                        throw std::runtime_error{"invalid IdSetCompressed data: truncated"};
+                    }
+                    std::memcpy(&key, ptr, sizeof(key));
+                    ptr += sizeof(key);
+                    if (key > block_key(std::numeric_limits<T>::max()) ||
+                        (!blocks.empty() && key <= blocks.back().key)) {
+                        throw std::runtime_error{"invalid IdSetCompressed data: invalid block key"};
+                    }
+                    blocks.push_back(block{static_cast<T>(key), detail::id_set_container{}});
+                    ptr = blocks.back().container.deserialize(ptr, end);
+                }
+
+                using std::swap;
+                swap(m_blocks, blocks);
+                recalculate_size();
+            }
+
+            /**
+             * Write the set to a file.
+             *
+             * @throws std::system_error if writing fails.
+             */
+            void dump(const int fd) const {
+                const auto data = serialize();
+                osmium::io::detail::reliable_write(fd, data.data(), data.size());
+            }
+
+            /**
+             * Replace the contents of this set with the set read from a file
+             * written by dump().
+             *
+             * @throws std::system_error if reading fails.
+             * @throws std::runtime_error if the data is invalid.
+             */
+            void load(const int fd) {
+                std::string data;
+                std::string buffer(1024UL * 1024UL, '\0');
+                while (true) {
+                    const auto nread = osmium::io::detail::reliable_read(fd, &*buffer.begin(), static_cast<unsigned int>(buffer.size()));
+                    if (nread == 0) {
+                        break;
+                    }
+                    data.append(buffer.data(), static_cast<std::size_t>(nread));
+                }
+                deserialize(data);
+            }
+
+            const_iterator begin() const noexcept {
+                return {this, 0};
+            }
+
+            const_iterator end() const noexcept {
+                return {this, m_blocks.size()};
+            }
+
+        }; // class IdSetCompressed
+
+        /// Return union of the two sets.
+        template <typename T>
+        inline IdSetCompressed<T> operator|(IdSetCompressed<T> lhs, const IdSetCompressed<T>& rhs) {
+            lhs |= rhs;
+            return lhs;
+        }
+
+        /// Return intersection of the two sets.
+        template <typename T>
+        inline IdSetCompressed<T> operator&(IdSetCompressed<T> lhs, const IdSetCompressed<T>& rhs) {
+            lhs &= rhs;
+            return lhs;
+        }
+
+        /// Return difference of the two sets.
+        template <typename T>
+        inline IdSetCompressed<T> operator-(IdSetCompressed<T> lhs, const IdSetCompressed<T>& rhs) {
+            lhs -= rhs;
+            return lhs;
+        }
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_ID_SET_COMPRESSED_HPP
@@ -0,0 +1,375 @@
+#ifndef OSMIUM_INDEX_MAP_READONLY_FILE_MAP_HPP
+#define OSMIUM_INDEX_MAP_READONLY_FILE_MAP_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/index.hpp>
+#include <osmium/index/map.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory_mapping.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define OSMIUM_HAS_INDEX_MAP_READONLY_FILE_MAP
+
+namespace osmium {
+
+    /**
+     * Exception thrown when an index file can not be used because its
+     * header is missing or doesn't match the expected format.
+     */
+    struct OSMIUM_EXPORT index_file_error : public std::runtime_error {
+
+        explicit index_file_error(const char* message) :
+            std::runtime_error(message) {
+        }
+
+        explicit index_file_error(const std::string& message) :
+            std::runtime_error(message) {
+        }
+
+    }; // struct index_file_error
+
+    namespace index {
+
+        /**
+         * The layout of the data in an index file.
+         */
+        enum class index_file_layout : uint32_t {
+
+            /// Array of values indexed by id (see Map::dump_as_array()).
+            dense  = 1,
+
+            /// Sorted list of (id, value) pairs (see Map::dump_as_list()).
+            sparse = 2
+
+        }; // enum class index_file_layout
+
+        namespace detail {
+
+            enum : uint32_t {
+                index_file_version    = 1,
+                index_file_byte_order = 0x01020304U
+            };
+
+            constexpr const char index_file_magic[8] = {'O', 'S', 'M', 'I', 'D', 'X', '\0', '\0'};
+
+            /**
+             * Header at the start of an index file. It is padded to 64 bytes
+             * so the data following it is suitably aligned for any key and
+             * value type when the file is memory mapped.
+             */
+            struct index_file_header {
+                char magic[8];
+                uint32_t version;
+                uint32_t byte_order;
+                uint32_t layout;
+                uint32_t key_size;
+                uint32_t value_size;
+                uint32_t element_size;
+                uint64_t count;
+                uint64_t reserved[3];
+            }; // struct index_file_header
+
+            static_assert(sizeof(index_file_header) == 64, "index_file_header must be 64 bytes");
+
+            template <typename TId, typename TValue>
+            constexpr std::size_t index_file_element_size(const index_file_layout layout) noexcept {
+                return layout == index_file_layout::dense ? sizeof(TValue) : sizeof(std::pair<TId, TValue>);
+            }
+
+            template <typename TId, typename TValue>
+            index_file_header make_index_file_header(const index_file_layout layout, const uint64_t count) noexcept {
+                index_file_header header{};
+                std::memcpy(header.magic, index_file_magic, sizeof(header.magic));
+                header.version      = index_file_version;
+                header.byte_order   = index_file_byte_order;
+                header.layout       = static_cast<uint32_t>(layout);
+                header.key_size     = sizeof(TId);
+                header.value_size   = sizeof(TValue);
+                header.element_size = static_cast<uint32_t>(index_file_element_size<TId, TValue>(layout));
+                header.count        = count;
+                return header;
+            }
+
+        } // namespace detail
+
+        namespace map {
+
+            /**
+             * Write the contents of a map to a versioned index file that
+             * can later be opened with the ReadOnlyFileMap class.
+             *
+             * The file descriptor must refer to an empty file open for
+             * writing. For the sparse layout the map is sorted first,
+             * so this only works for maps supporting dump_as_list(), for
+             * the dense layout the map must support dump_as_array().
+             *
+             * @param map The map to write out.
+             * @param fd File descriptor of an empty file.
+             * @param layout Write dense array or sparse list?
+             * @throws std::system_error if writing fails.
+             * @throws std::runtime_error if the map doesn't support the layout.
+             */
+            template <typename TId, typename TValue>
+            inline void write_index_file(Map<TId, TValue>& map, const int fd, const index_file_layout layout) {
+                auto header = osmium::index::detail::make_index_file_header<TId, TValue>(layout, 0);
+                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&header), sizeof(header));
+
+                if (layout == index_file_layout::dense) {
+                    map.dump_as_array(fd);
+                } else {
+                    map.sort();
+                    map.dump_as_list(fd);
+                }
+
+                const std::size_t data_size = osmium::file_size(fd) - sizeof(header);
+                const std::size_t element_size = header.element_size;
+                if (data_size % element_size != 0) {
+                    throw index_file_error{"index data has wrong size (must be multiple of " + std::to_string(element_size) + ")"};
+                }
+
+                header.count = data_size / element_size;
+                osmium::file_seek(fd, 0);
+                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&header), sizeof(header));
+                osmium::file_seek(fd, sizeof(header) + data_size);
+            }
+
+            /**
+             * A map backed by a read-only memory mapping of an index file
+             * written with write_index_file(). Opening the map only maps
+             * the file and checks its header, no data is read or copied,
+             * so this is fast regardless of the size of the index. Because
+             * the mapping is read-only, several processes using the same
+             * file will share the page cache for it.
+             *
+             * Both the dense and the sparse layout are supported, the
+             * layout is taken from the file header. Lookups in dense files
+             * are O(1), lookups in sparse files do a binary search.
+             *
+             * The set() function is not supported and will throw.
+             */
+            template <typename TId, typename TValue>
+            class ReadOnlyFileMap : public Map<TId, TValue> {
+
+                using element_type = std::pair<TId, TValue>;
+
+                osmium::util::MemoryMapping m_mapping;
+                index_file_layout m_layout;
+                std::size_t m_count;
+
+                const osmium::index::detail::index_file_header& header() const noexcept {
+                    return *m_mapping.get_addr<const osmium::index::detail::index_file_header>();
+                }
+
+                const char* data() const noexcept {
+                    return m_mapping.get_addr<const char>() + sizeof(osmium::index::detail::index_file_header);
+                }
+
+                const TValue* dense_data() const noexcept {
+                    return reinterpret_cast<const TValue*>(data());
+                }
+
+                const element_type* sparse_data() const noexcept {
+                    return reinterpret_cast<const element_type*>(data());
+                }
+
+                static std::size_t check_file_size(const int fd) {
+                    const auto size = osmium::file_size(fd);
+                    if (size < sizeof(osmium::index::detail::index_file_header)) {
+                        throw index_file_error{"index file too small to contain header"};
+                    }
+                    return size;
+                }
+
+                void check_header() const {
+                    const auto& h = header();
+                    if (std::memcmp(h.magic, osmium::index::detail::index_file_magic, sizeof(h.magic)) != 0) {
+                        throw index_file_error{"not an index file (wrong magic)"};
+                    }
+                    if (h.byte_order != osmium::index::detail::index_file_byte_order) {
+                        throw index_file_error{"index file was written on system with different byte order"};
+                    }
+                    if (h.version != osmium::index::detail::index_file_version) {
+                        throw index_file_error{"unsupported index file version " + std::to_string(h.version)};
+                    }
+                    if (h.layout != static_cast<uint32_t>(index_file_layout::dense) &&
+                        h.layout != static_cast<uint32_t>(index_file_layout::sparse)) {
+                        throw index_file_error{"unknown index file layout " + std::to_string(h.layout)};
+                    }
+                    const auto layout = static_cast<index_file_layout>(h.layout);
+                    if (h.key_size != sizeof(TId) ||
+                        h.value_size != sizeof(TValue) ||
+                        h.element_size != osmium::index::detail::index_file_element_size<TId, TValue>(layout)) {
+                        throw index_file_error{"index file key or value type doesn't match"};
+                    }
+                    // Compare without multiplying, because count comes from
+                    // the file and the product could overflow.
+                    if (h.count > (m_mapping.size() - sizeof(osmium::index::detail::index_file_header)) / h.element_size) {
+                        throw index_file_error{"index file truncated"};
+                    }
+                }
+
+                const element_type* find_id(const TId id) const noexcept {
+                    const element_type* end = sparse_data() + m_count;
+                    const element_type* it = std::lower_bound(sparse_data(), end, id, [](const element_type& a, const TId b) {
+                        return a.first < b;
+                    });
+                    if (it == end || it->first != id) {
+                        return nullptr;
+                    }
+                    return it;
+                }
+
+            public:
+
+                /**
+                 * Open index from the file with the given file descriptor.
+                 * The file descriptor can be closed after this returns.
+                 *
+                 * @throws osmium::index_file_error if the file header is
+                 *         invalid.
+                 * @throws std::system_error if the mapping fails.
+                 */
+                explicit ReadOnlyFileMap(const int fd) :
+                    m_mapping(check_file_size(fd), osmium::util::MemoryMapping::mapping_mode::readonly, fd),
+                    m_layout(index_file_layout::dense),
+                    m_count(0) {
+                    check_header();
+                    m_layout = static_cast<index_file_layout>(header().layout);
+                    m_count = static_cast<std::size_t>(header().count);
+                }
+
+                ReadOnlyFileMap(const ReadOnlyFileMap&) = delete;
+                ReadOnlyFileMap& operator=(const ReadOnlyFileMap&) = delete;
+
+                ReadOnlyFileMap(ReadOnlyFileMap&&) noexcept = default;
+                ReadOnlyFileMap& operator=(ReadOnlyFileMap&&) noexcept = default;
+
+                ~ReadOnlyFileMap() noexcept override = default;
+
+                /// The layout of the index file.
+                index_file_layout layout() const noexcept {
+                    return m_layout;
+                }
+
+                void set(const TId /*id*/, const TValue /*value*/) final {
+                    throw std::runtime_error{"can't set value in read-only index"};
+                }
+
+                TValue get(const TId id) const final {
+                    const TValue value = get_noexcept(id);
+                    if (value == osmium::index::empty_value<TValue>()) {
+                        throw osmium::not_found{id};
+                    }
+                    return value;
+                }
+
+                TValue get_noexcept(const TId id) const noexcept final {
+                    if (m_layout == index_file_layout::dense) {
+                        if (id >= m_count) {
+                            return osmium::index::empty_value<TValue>();
+                        }
+                        return dense_data()[id];
+                    }
+
+                    const element_type* element = find_id(id);
+                    if (!element) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                    return element->second;
+                }
+
+                /**
+                 * The number of elements in the file. For the dense layout
+                 * this is one more than the largest id, for the sparse
+                 * layout it is the number of (id, value) pairs.
+                 */
+                std::size_t size() const final {
+                    return m_count;
+                }
+
+                /// The size of the index file (the memory used on disk).
+                std::size_t used_memory() const final {
+                    return m_mapping ? m_mapping.size() : 0;
+                }
+
+                /// Unmap the file. The map can not be used after this.
+                void clear() final {
+                    m_mapping.unmap();
+                    m_count = 0;
+                }
+
+            }; // class ReadOnlyFileMap
+
+            template <typename TId, typename TValue>
+            struct create_map<TId, TValue, ReadOnlyFileMap> {
+                ReadOnlyFileMap<TId, TValue>* operator()(const std::vector<std::string>& config) {
+                    // open_for_reading() would use stdin for these names.
+                    if (config.size() < 2 || config[1].empty() || config[1] == "-") {
+                        throw map_factory_error{"Need file name for read-only index file map"};
+                    }
+                    const int fd = osmium::io::detail::open_for_reading(config[1]);
+                    std::unique_ptr<ReadOnlyFileMap<TId, TValue>> map;
+                    try {
+                        map.reset(new ReadOnlyFileMap<TId, TValue>{fd});
+                    } catch (...) {
+                        osmium::io::detail::reliable_close(fd);
+                        throw;
+                    }
+                    // The mapping stays valid after the file is closed.
+                    osmium::io::detail::reliable_close(fd);
+                    return map.release();
+                }
+            };
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#ifdef OSMIUM_WANT_NODE_LOCATION_MAPS
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::ReadOnlyFileMap, readonly_file_map)
+#endif
+
+#endif // OSMIUM_INDEX_MAP_READONLY_FILE_MAP_HPP
@@ -43,6 +43,10 @@ DEALINGS IN THE SOFTWARE.
 
 namespace osmium {
 
+    namespace thread {
+        class Pool;
+    } // namespace thread
+
     namespace index {
 
         namespace multimap {
@@ -125,6 +129,16 @@ namespace osmium {
                 main_map_type m_main;
                 extra_map_type m_extra;
 
+                // Move the entries from the extra map into the main map
+                // and drop removed entries. Leaves the main map unsorted.
+                void merge_extra() {
+                    m_main.erase_removed();
+                    for (const auto& element : m_extra) {
+                        m_main.set(element.first, element.second);
+                    }
+                    m_extra.clear();
+                }
+
             public:
 
                 using iterator       = HybridIterator<TId, TValue>;
@@ -170,14 +184,20 @@ namespace osmium {
                 }
 
                 void consolidate() {
-                    m_main.erase_removed();
-                    for (const auto& element : m_extra) {
-                        m_main.set(element.first, element.second);
-                    }
-                    m_extra.clear();
+                    merge_extra();
                     m_main.sort();
                 }
 
+                /**
+                 * Like consolidate(), but sort using the threads in the pool.
+                 *
+                 * Include <osmium/index/parallel_sort.hpp> to use this.
+                 */
+                void consolidate(osmium::thread::Pool& pool) {
+                    merge_extra();
+                    m_main.sort(pool);
+                }
+
                 void dump_as_list(const int fd) final {
                     consolidate();
                     m_main.dump_as_list(fd);
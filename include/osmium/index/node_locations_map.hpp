@@ -51,6 +51,10 @@ DEALINGS IN THE SOFTWARE.
     REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::DenseMmapArray, dense_mmap_array)
 #endif
 
+#ifdef OSMIUM_HAS_INDEX_MAP_READONLY_FILE_MAP
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::ReadOnlyFileMap, readonly_file_map)
+#endif
+
 #ifdef OSMIUM_HAS_INDEX_MAP_SPARSE_FILE_ARRAY
     REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::SparseFileArray, sparse_file_array)
 #endif
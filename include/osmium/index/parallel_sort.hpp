@@ -0,0 +1,112 @@
+#ifndef OSMIUM_INDEX_PARALLEL_SORT_HPP
+#define OSMIUM_INDEX_PARALLEL_SORT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Include this file to use the sort() and consolidate() functions taking
+ * an osmium::thread::Pool of the vector based sparse maps and multimaps,
+ * the Hybrid multimap, and the build_*() functions taking a pool of the
+ * RelationsMapStash. They are kept out of the index headers so that those
+ * don't depend on the thread and sort code.
+ *
+ * @attention If you include this file, you'll need to enable
+ *            multithreading.
+ */
+
+#include <osmium/index/detail/mmap_vector_base.hpp>
+#include <osmium/index/detail/vector_map.hpp>
+#include <osmium/index/detail/vector_multimap.hpp>
+#include <osmium/index/relations_map.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/thread/sort.hpp>
+
+#include <algorithm>
+#include <type_traits>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace detail {
+
+            /**
+             * Sort a vector used in one of the vector based indexes using
+             * the threads in the pool. Vectors based on memory mappings
+             * are sorted with a temporary buffer in a file, other vectors
+             * with a temporary buffer in memory.
+             */
+            template <typename TVector>
+            void parallel_sort_vector(osmium::thread::Pool& pool, TVector& vector) {
+                using value_type = typename TVector::value_type;
+                if (std::is_base_of<osmium::detail::mmap_vector_base<value_type>, TVector>::value) {
+                    osmium::thread::parallel_sort_external(pool, vector.begin(), vector.end());
+                } else {
+                    osmium::thread::parallel_sort(pool, vector.begin(), vector.end());
+                }
+            }
+
+            template <typename TKey, typename TKeyInternal, typename TValue, typename TValueInternal>
+            void flat_map<TKey, TKeyInternal, TValue, TValueInternal>::sort_unique(osmium::thread::Pool& pool) {
+                osmium::thread::parallel_sort(pool, m_map.begin(), m_map.end());
+                const auto last = std::unique(m_map.begin(), m_map.end());
+                m_map.erase(last, m_map.end());
+            }
+
+        } // namespace detail
+
+        namespace map {
+
+            template <typename TId, typename TValue, template <typename...> class TVector>
+            void VectorBasedSparseMap<TId, TValue, TVector>::sort(osmium::thread::Pool& pool) {
+                osmium::index::detail::parallel_sort_vector(pool, m_vector);
+            }
+
+        } // namespace map
+
+        namespace multimap {
+
+            template <typename TId, typename TValue, template <typename...> class TVector>
+            void VectorBasedSparseMultimap<TId, TValue, TVector>::sort(osmium::thread::Pool& pool) {
+                osmium::index::detail::parallel_sort_vector(pool, m_vector);
+            }
+
+        } // namespace multimap
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_PARALLEL_SORT_HPP
@@ -48,6 +48,10 @@ DEALINGS IN THE SOFTWARE.
 
 namespace osmium {
 
+    namespace thread {
+        class Pool;
+    } // namespace thread
+
     namespace index {
 
         namespace detail {
@@ -119,6 +123,22 @@ namespace osmium {
                     m_map.erase(last, m_map.end());
                 }
 
+                // Defined in <osmium/index/parallel_sort.hpp>.
+                void sort_unique(osmium::thread::Pool& pool);
+
+                void append(const flat_map& other) {
+                    m_map.insert(m_map.end(), other.m_map.begin(), other.m_map.end());
+                }
+
+                void swap(flat_map& other) noexcept {
+                    m_map.swap(other.m_map);
+                }
+
+                void clear() {
+                    m_map.clear();
+                    m_map.shrink_to_fit();
+                }
+
                 std::pair<const_iterator, const_iterator> get(const key_type key) const noexcept {
                     return std::equal_range(m_map.begin(), m_map.end(), kv_pair{key}, [](const kv_pair& lhs, const kv_pair& rhs) {
                         return lhs.key < rhs.key;
@@ -353,6 +373,40 @@ namespace osmium {
                 }
             }
 
+            /**
+             * Move all entries from the other stash into this one. Use this
+             * to combine stashes filled in different threads. The other
+             * stash will be empty afterwards.
+             */
+            void merge(RelationsMapStash&& other) {
+                assert(m_valid && "You can't use the RelationsMap any more after calling build_index()");
+                assert(other.m_valid && "You can't use the RelationsMap any more after calling build_index()");
+                if (m_map.empty()) {
+                    m_map.swap(other.m_map);
+                } else {
+                    m_map.append(other.m_map);
+                }
+                other.m_map.clear();
+            }
+
+            /**
+             * Move all entries from all the stashes into this one. Use this
+             * to combine stashes filled in different threads, usually one
+             * stash per thread. The other stashes will be empty afterwards.
+             */
+            void merge(std::vector<RelationsMapStash>& stashes) {
+                assert(m_valid && "You can't use the RelationsMap any more after calling build_index()");
+                std::size_t size = m_map.size();
+                for (const auto& stash : stashes) {
+                    size += stash.m_map.size();
+                }
+                m_map.reserve(size);
+                for (auto& stash : stashes) {
+                    m_map.append(stash.m_map);
+                    stash.m_map.clear();
+                }
+            }
+
             /**
              * Is this stash empty?
              *
@@ -438,6 +492,63 @@ namespace osmium {
                 return RelationsMapIndexes{std::move(m_map), std::move(reverse_map)};
             }
 
+            /**
+             * Build an index for member to parent lookups from the contents
+             * of this stash and return it. The data is sorted using the
+             * threads in the pool.
+             *
+             * Include <osmium/index/parallel_sort.hpp> to use this.
+             *
+             * After you get the index you can not use the stash any more!
+             */
+            RelationsMapIndex build_member_to_parent_index(osmium::thread::Pool& pool) {
+                assert(m_valid && "You can't use the RelationsMap any more after calling build_member_to_parent_index()");
+                m_map.sort_unique(pool);
+#ifndef NDEBUG
+                m_valid = false;
+#endif
+                return RelationsMapIndex{std::move(m_map)};
+            }
+
+            /**
+             * Build an index for parent to member lookups from the contents
+             * of this stash and return it. The data is sorted using the
+             * threads in the pool.
+             *
+             * Include <osmium/index/parallel_sort.hpp> to use this.
+             *
+             * After you get the index you can not use the stash any more!
+             */
+            RelationsMapIndex build_parent_to_member_index(osmium::thread::Pool& pool) {
+                assert(m_valid && "You can't use the RelationsMap any more after calling build_parent_to_member_index()");
+                m_map.flip_in_place();
+                m_map.sort_unique(pool);
+#ifndef NDEBUG
+                m_valid = false;
+#endif
+                return RelationsMapIndex{std::move(m_map)};
+            }
+
+            /**
+             * Build indexes for member-to-parent and parent-to-member lookups
+             * from the contents of this stash and return them. The data is
+             * sorted using the threads in the pool.
+             *
+             * Include <osmium/index/parallel_sort.hpp> to use this.
+             *
+             * After you get the index you can not use the stash any more!
+             */
+            RelationsMapIndexes build_indexes(osmium::thread::Pool& pool) {
+                assert(m_valid && "You can't use the RelationsMap any more after calling build_indexes()");
+                auto reverse_map = m_map.flip_copy();
+                reverse_map.sort_unique(pool);
+                m_map.sort_unique(pool);
+#ifndef NDEBUG
+                m_valid = false;
+#endif
+                return RelationsMapIndexes{std::move(m_map), std::move(reverse_map)};
+            }
+
         }; // class RelationsMapStash
 
         // defined outside the class on purpose
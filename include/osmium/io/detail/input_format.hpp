@@ -38,8 +38,11 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/file.hpp>
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
+#include <osmium/io/object_filter.hpp>
+#include <osmium/io/read_tags.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/object.hpp>
 #include <osmium/thread/pool.hpp>
 
 #include <array>
@@ -66,6 +69,10 @@ namespace osmium {
                 osmium::osm_entity_bits::type read_which_entities;
                 osmium::io::read_meta read_metadata;
                 osmium::io::buffers_type buffers_kind;
+                osmium::io::node_batch_mode node_batches;
+                osmium::io::read_tags tags;
+                osmium::io::read_members members;
+                osmium::io::object_filter filter;
                 bool want_buffered_pages_removed;
             };
 
@@ -77,6 +84,10 @@ namespace osmium {
                 queue_wrapper<std::string> m_input_queue;
                 osmium::osm_entity_bits::type m_read_which_entities;
                 osmium::io::read_meta m_read_metadata;
+                osmium::io::node_batch_mode m_node_batches;
+                osmium::io::read_tags m_tags;
+                osmium::io::read_members m_members;
+                osmium::io::object_filter m_filter;
                 bool m_header_is_done = false;
 
             protected:
@@ -93,6 +104,22 @@ namespace osmium {
                     return m_read_metadata;
                 }
 
+                osmium::io::node_batch_mode node_batches() const noexcept {
+                    return m_node_batches;
+                }
+
+                const osmium::io::read_tags& tag_options() const noexcept {
+                    return m_tags;
+                }
+
+                osmium::io::read_members read_relation_members() const noexcept {
+                    return m_members;
+                }
+
+                const osmium::io::object_filter& filter_options() const noexcept {
+                    return m_filter;
+                }
+
                 bool header_is_done() const noexcept {
                     return m_header_is_done;
                 }
@@ -130,7 +157,11 @@ namespace osmium {
                     m_header_promise(args.header_promise),
                     m_input_queue(args.input_queue),
                     m_read_which_entities(args.read_which_entities),
-                    m_read_metadata(args.read_metadata) {
+                    m_read_metadata(args.read_metadata),
+                    m_node_batches(args.node_batches),
+                    m_tags(args.tags),
+                    m_members(args.members),
+                    m_filter(args.filter) {
                 }
 
                 Parser(const Parser&) = delete;
@@ -202,6 +233,17 @@ namespace osmium {
                     return m_buffer;
                 }
 
+                // Commit the OSM object just built if it passes the object
+                // filter, remove it from the buffer otherwise.
+                void commit_object() {
+                    if (filter_options().empty() ||
+                        filter_options()(m_buffer.get<osmium::OSMObject>(m_buffer.committed()))) {
+                        m_buffer.commit();
+                    } else {
+                        m_buffer.rollback();
+                    }
+                }
+
                 void flush_nested_buffer() {
                     if (m_buffer.has_nested_buffers()) {
                         std::unique_ptr<osmium::memory::Buffer> buffer_ptr{m_buffer.get_last_nested()};
@@ -313,8 +313,12 @@ namespace osmium {
                     return {static_cast<osmium::user_id_type>(uid), user};
                 }
 
-                void decode_tags(osmium::builder::Builder& parent, const char** dataptr, const char* const end) {
-                    osmium::builder::TagListBuilder builder{parent};
+                // Tags have to be decoded even if they are not wanted,
+                // because they might be added to the reference table.
+                void decode_tags(osmium::builder::Builder& parent, const char** dataptr, const char* const end, const osmium::osm_entity_bits::type entity) {
+                    const bool wanted = tag_options().wanted(entity);
+                    const bool filtered = tag_options().filtered(entity);
+                    std::unique_ptr<osmium::builder::TagListBuilder> builder;
 
                     while (*dataptr != end) {
                         const bool update_pointer = (**dataptr == 0x00);
@@ -343,7 +347,14 @@ namespace osmium {
                             *dataptr = data;
                         }
 
-                        builder.add_tag(start, value);
+                        if (!wanted || (filtered && !tag_options()(start, value))) {
+                            continue;
+                        }
+
+                        if (!builder) {
+                            builder.reset(new osmium::builder::TagListBuilder{parent});
+                        }
+                        builder->add_tag(start, value);
                     }
                 }
 
@@ -397,7 +408,7 @@ namespace osmium {
                         builder.set_location(osmium::Location{lon, lat});
 
                         if (data != end) {
-                            decode_tags(builder, &data, end);
+                            decode_tags(builder, &data, end, osmium::osm_entity_bits::node);
                         }
                     }
                 }
@@ -428,7 +439,7 @@ namespace osmium {
                         }
 
                         if (data != end) {
-                            decode_tags(builder, &data, end);
+                            decode_tags(builder, &data, end, osmium::osm_entity_bits::way);
                         }
                     }
                 }
@@ -485,7 +496,13 @@ namespace osmium {
                                 throw o5m_error{"relation format error"};
                             }
 
-                            osmium::builder::RelationMemberListBuilder rml_builder{builder};
+                            // Members have to be decoded even if they are
+                            // not wanted to keep the delta and reference
+                            // table state.
+                            std::unique_ptr<osmium::builder::RelationMemberListBuilder> rml_builder;
+                            if (read_relation_members() == osmium::io::read_members::yes) {
+                                rml_builder.reset(new osmium::builder::RelationMemberListBuilder{builder});
+                            }
 
                             while (data < end_refs) {
                                 const auto delta_id = zvarint(&data, end);
@@ -495,12 +512,14 @@ namespace osmium {
                                 const auto type_role = decode_role(&data, end);
                                 const auto i = osmium::item_type_to_nwr_index(type_role.first);
                                 const auto ref = m_delta_member_ids[i].update(delta_id);
-                                rml_builder.add_member(type_role.first, ref, type_role.second);
+                                if (rml_builder) {
+                                    rml_builder->add_member(type_role.first, ref, type_role.second);
+                                }
                             }
                         }
 
                         if (data != end) {
-                            decode_tags(builder, &data, end);
+                            decode_tags(builder, &data, end, osmium::osm_entity_bits::relation);
                         }
                     }
                 }
@@ -560,7 +579,7 @@ namespace osmium {
                                     if (read_types() & osmium::osm_entity_bits::node) {
                                         maybe_new_buffer(osmium::item_type::node);
                                         decode_node(m_data, m_data + length);
-                                        buffer().commit();
+                                        commit_object();
                                     }
                                     break;
                                 case dataset_type::way:
@@ -568,7 +587,7 @@ namespace osmium {
                                     if (read_types() & osmium::osm_entity_bits::way) {
                                         maybe_new_buffer(osmium::item_type::way);
                                         decode_way(m_data, m_data + length);
-                                        buffer().commit();
+                                        commit_object();
                                     }
                                     break;
                                 case dataset_type::relation:
@@ -576,7 +595,7 @@ namespace osmium {
                                     if (read_types() & osmium::osm_entity_bits::relation) {
                                         maybe_new_buffer(osmium::item_type::relation);
                                         decode_relation(m_data, m_data + length);
-                                        buffer().commit();
+                                        commit_object();
                                     }
                                     break;
                                 case dataset_type::bounding_box:
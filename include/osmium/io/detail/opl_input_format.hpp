@@ -133,7 +133,7 @@ namespace osmium {
                             break;
                     }
 
-                    if (opl_parse_line(m_line_count, data, buffer(), read_types())) {
+                    if (opl_parse_line(m_line_count, data, buffer(), read_types(), filter_options())) {
                         flush_nested_buffer();
                     }
                     ++m_line_count;
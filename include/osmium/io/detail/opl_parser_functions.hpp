@@ -36,6 +36,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/builder/osm_object_builder.hpp>
 #include <osmium/io/detail/string_util.hpp>
 #include <osmium/io/error.hpp>
+#include <osmium/io/object_filter.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/box.hpp>
 #include <osmium/osm/changeset.hpp>
@@ -857,10 +858,25 @@ namespace osmium {
                 }
             }
 
+            // Commit the object just parsed if it matches the filter,
+            // otherwise remove it from the buffer again. Returns true if
+            // the object was committed.
+            inline bool opl_commit_object(osmium::memory::Buffer& buffer,
+                                          const osmium::io::object_filter& filter) {
+                if (filter.empty() ||
+                    filter(buffer.get<osmium::OSMObject>(buffer.committed()))) {
+                    buffer.commit();
+                    return true;
+                }
+                buffer.rollback();
+                return false;
+            }
+
             inline bool opl_parse_line(uint64_t line_count,
                                        const char* data,
                                        osmium::memory::Buffer& buffer,
-                                       osmium::osm_entity_bits::type read_types = osmium::osm_entity_bits::all) {
+                                       osmium::osm_entity_bits::type read_types = osmium::osm_entity_bits::all,
+                                       const osmium::io::object_filter& filter = osmium::io::object_filter{}) {
                 const char* start_of_line = data;
                 try {
                     switch (*data) {
@@ -874,24 +890,21 @@ namespace osmium {
                             if (read_types & osmium::osm_entity_bits::node) {
                                 ++data;
                                 opl_parse_node(&data, buffer);
-                                buffer.commit();
-                                return true;
+                                return opl_commit_object(buffer, filter);
                             }
                             break;
                         case 'w':
                             if (read_types & osmium::osm_entity_bits::way) {
                                 ++data;
                                 opl_parse_way(&data, buffer);
-                                buffer.commit();
-                                return true;
+                                return opl_commit_object(buffer, filter);
                             }
                             break;
                         case 'r':
                             if (read_types & osmium::osm_entity_bits::relation) {
                                 ++data;
                                 opl_parse_relation(&data, buffer);
-                                buffer.commit();
-                                return true;
+                                return opl_commit_object(buffer, filter);
                             }
                             break;
                         case 'c':
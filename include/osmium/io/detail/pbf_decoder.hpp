@@ -48,6 +48,8 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/detail/zlib.hpp>
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
+#include <osmium/io/object_filter.hpp>
+#include <osmium/io/read_tags.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/box.hpp>
 #include <osmium/osm/entity_bits.hpp>
@@ -154,8 +156,24 @@ namespace osmium {
 
                 osmium::memory::Buffer m_buffer{initial_buffer_size, osmium::memory::Buffer::auto_grow::internal};
 
+                osmium::item_type m_decoded_type = osmium::item_type::undefined;
+                bool m_mixed_types = false;
+
                 osmium::io::read_meta m_read_metadata;
 
+                osmium::io::node_batch_mode m_node_batches;
+
+                osmium::io::read_tags m_read_tags;
+
+                osmium::io::read_members m_read_members;
+
+                osmium::io::object_filter m_filter;
+
+                // The strings in the string table are not \0-terminated,
+                // tags are copied here to check them against the filter.
+                std::string m_tag_key;
+                std::string m_tag_value;
+
                 void decode_stringtable(const data_view& data) {
                     if (!m_stringtable.empty()) {
                         throw osmium::pbf_error{"more than one stringtable in pbf file"};
@@ -197,6 +215,17 @@ namespace osmium {
                     }
                 }
 
+                // Remember the type of objects decoded. After decoding the
+                // buffer is tagged with the type if all objects have the
+                // same type, which is usually the case.
+                void note_type(osmium::item_type type) noexcept {
+                    if (m_decoded_type == osmium::item_type::undefined) {
+                        m_decoded_type = type;
+                    } else if (m_decoded_type != type) {
+                        m_mixed_types = true;
+                    }
+                }
+
                 void decode_primitive_block_data() {
                     protozero::pbf_message<OSMFormat::PrimitiveBlock> pbf_primitive_block{m_data};
                     while (pbf_primitive_block.next(OSMFormat::PrimitiveBlock::repeated_PrimitiveGroup_primitivegroup, protozero::pbf_wire_type::length_delimited)) {
@@ -205,36 +234,46 @@ namespace osmium {
                             switch (pbf_primitive_group.tag_and_type()) {
                                 case protozero::tag_and_type(OSMFormat::PrimitiveGroup::repeated_Node_nodes, protozero::pbf_wire_type::length_delimited):
                                     if (m_read_types & osmium::osm_entity_bits::node) {
-                                        decode_node(pbf_primitive_group.get_view());
-                                        m_buffer.commit();
+                                        if (commit_object(decode_node(pbf_primitive_group.get_view()))) {
+                                            note_type(osmium::item_type::node);
+                                        }
                                     } else {
                                         pbf_primitive_group.skip();
                                     }
                                     break;
                                 case protozero::tag_and_type(OSMFormat::PrimitiveGroup::optional_DenseNodes_dense, protozero::pbf_wire_type::length_delimited):
                                     if (m_read_types & osmium::osm_entity_bits::node) {
-                                        if (m_read_metadata == osmium::io::read_meta::yes) {
-                                            decode_dense_nodes(pbf_primitive_group.get_view());
+                                        if (m_node_batches != osmium::io::node_batch_mode::none) {
+                                            decode_dense_nodes_as_batch(pbf_primitive_group.get_view());
+                                            m_buffer.commit();
+                                            note_type(osmium::item_type::node_batch);
                                         } else {
-                                            decode_dense_nodes_without_metadata(pbf_primitive_group.get_view());
+                                            if (m_read_metadata == osmium::io::read_meta::yes) {
+                                                decode_dense_nodes(pbf_primitive_group.get_view());
+                                            } else {
+                                                decode_dense_nodes_without_metadata(pbf_primitive_group.get_view());
+                                            }
+                                            m_buffer.commit();
+                                            note_type(osmium::item_type::node);
                                         }
-                                        m_buffer.commit();
                                     } else {
                                         pbf_primitive_group.skip();
                                     }
                                     break;
                                 case protozero::tag_and_type(OSMFormat::PrimitiveGroup::repeated_Way_ways, protozero::pbf_wire_type::length_delimited):
                                     if (m_read_types & osmium::osm_entity_bits::way) {
-                                        decode_way(pbf_primitive_group.get_view());
-                                        m_buffer.commit();
+                                        if (commit_object(decode_way(pbf_primitive_group.get_view()))) {
+                                            note_type(osmium::item_type::way);
+                                        }
                                     } else {
                                         pbf_primitive_group.skip();
                                     }
                                     break;
                                 case protozero::tag_and_type(OSMFormat::PrimitiveGroup::repeated_Relation_relations, protozero::pbf_wire_type::length_delimited):
                                     if (m_read_types & osmium::osm_entity_bits::relation) {
-                                        decode_relation(pbf_primitive_group.get_view());
-                                        m_buffer.commit();
+                                        if (commit_object(decode_relation(pbf_primitive_group.get_view()))) {
+                                            note_type(osmium::item_type::relation);
+                                        }
                                     } else {
                                         pbf_primitive_group.skip();
                                     }
@@ -300,8 +339,19 @@ namespace osmium {
                     return user;
                 }
 
-                void build_tag_list(osmium::builder::Builder& parent, varint_range& keys, varint_range& vals) {
-                    if (keys.empty() || vals.empty()) {
+                bool keep_tag(const osm_string_len_type& key, const osm_string_len_type& value) {
+                    m_tag_key.assign(key.first, key.second);
+                    m_tag_value.assign(value.first, value.second);
+                    return m_read_tags(m_tag_key.c_str(), m_tag_value.c_str());
+                }
+
+                void build_tag_list(osmium::builder::Builder& parent, varint_range& keys, varint_range& vals, const osmium::osm_entity_bits::type entity) {
+                    if (keys.empty() || vals.empty() || !m_read_tags.wanted(entity)) {
+                        return;
+                    }
+
+                    if (m_read_tags.filtered(entity)) {
+                        build_filtered_tag_list(parent, keys, vals);
                         return;
                     }
 
@@ -313,6 +363,79 @@ namespace osmium {
                     } while (!keys.empty() && !vals.empty());
                 }
 
+                // Only start the tag list when the first tag matching the
+                // filter is found, so objects without matching tags don't
+                // get one.
+                void build_filtered_tag_list(osmium::builder::Builder& parent, varint_range& keys, varint_range& vals) {
+                    osm_string_len_type k;
+                    osm_string_len_type v;
+                    do {
+                        if (keys.empty() || vals.empty()) {
+                            return;
+                        }
+                        k = m_stringtable.at(keys.next_uint32());
+                        v = m_stringtable.at(vals.next_uint32());
+                    } while (!keep_tag(k, v));
+
+                    osmium::builder::TagListBuilder builder{parent};
+                    builder.add_tag(k.first, k.second, v.first, v.second);
+                    while (!keys.empty() && !vals.empty()) {
+                        k = m_stringtable.at(keys.next_uint32());
+                        v = m_stringtable.at(vals.next_uint32());
+                        if (keep_tag(k, v)) {
+                            builder.add_tag(k.first, k.second, v.first, v.second);
+                        }
+                    }
+                }
+
+                // Check a tag against the tags filters of the object filter
+                // given in the bitmask. The object filter only sees tags
+                // that would be read with the read_tags option.
+                uint64_t match_tag(const uint64_t rules, const osm_string_len_type& key, const osm_string_len_type& value, const bool filtered) {
+                    m_tag_key.assign(key.first, key.second);
+                    m_tag_value.assign(value.first, value.second);
+                    if (filtered && !m_read_tags(m_tag_key.c_str(), m_tag_value.c_str())) {
+                        return 0;
+                    }
+                    return m_filter.tag_matches(rules, m_tag_key.c_str(), m_tag_value.c_str());
+                }
+
+                // Check the tags of an object against the object filter
+                // before anything is added to the buffer.
+                bool tags_match_filter(varint_range keys, varint_range vals, const osmium::osm_entity_bits::type entity) {
+                    const auto rules = m_filter.tags_rules(entity);
+                    if (rules == 0) {
+                        return true;
+                    }
+                    if (!m_read_tags.wanted(entity)) {
+                        return false;
+                    }
+
+                    const bool filtered = m_read_tags.filtered(entity);
+                    uint64_t matched = 0;
+                    while (!keys.empty() && !vals.empty()) {
+                        const auto& k = m_stringtable.at(keys.next_uint32());
+                        const auto& v = m_stringtable.at(vals.next_uint32());
+                        matched |= match_tag(rules, k, v, filtered);
+                        if (matched == rules) {
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+
+                // Commit the object just decoded if it should be kept and
+                // passes the predicate of the object filter, roll it back
+                // otherwise. Returns true if the object was committed.
+                bool commit_object(const bool keep) {
+                    if (keep && (m_filter.empty() || m_filter.predicate_matches(m_buffer.get<osmium::OSMObject>(m_buffer.committed())))) {
+                        m_buffer.commit();
+                        return true;
+                    }
+                    m_buffer.rollback();
+                    return false;
+                }
+
                 int32_t convert_pbf_lon(const int64_t c) const noexcept {
                     return static_cast<int32_t>((c * m_granularity + m_lon_offset) / resolution_convert);
                 }
@@ -321,7 +444,7 @@ namespace osmium {
                     return static_cast<int32_t>((c * m_granularity + m_lat_offset) / resolution_convert);
                 }
 
-                void decode_node(const data_view& data) {
+                bool decode_node(const data_view& data) {
                     osmium::builder::NodeBuilder builder{m_buffer};
                     osmium::Node& node = builder.object();
 
@@ -373,12 +496,21 @@ namespace osmium {
                         });
                     }
 
+                    if (!m_filter.empty() &&
+                        (!m_filter.id_matches(osmium::osm_entity_bits::node, node.id()) ||
+                         !m_filter.location_matches(node.location()) ||
+                         !tags_match_filter(keys, vals, osmium::osm_entity_bits::node))) {
+                        return false;
+                    }
+
                     builder.set_user(user.first, user.second);
 
-                    build_tag_list(builder, keys, vals);
+                    build_tag_list(builder, keys, vals, osmium::osm_entity_bits::node);
+
+                    return true;
                 }
 
-                void decode_way(const data_view& data) {
+                bool decode_way(const data_view& data) {
                     osmium::builder::WayBuilder builder{m_buffer};
 
                     varint_range keys;
@@ -422,6 +554,12 @@ namespace osmium {
                         }
                     }
 
+                    if (!m_filter.empty() &&
+                        (!m_filter.id_matches(osmium::osm_entity_bits::way, builder.cobject().id()) ||
+                         !tags_match_filter(keys, vals, osmium::osm_entity_bits::way))) {
+                        return false;
+                    }
+
                     builder.set_user(user.first, user.second);
 
                     if (!refs.empty()) {
@@ -444,10 +582,12 @@ namespace osmium {
                         }
                     }
 
-                    build_tag_list(builder, keys, vals);
+                    build_tag_list(builder, keys, vals, osmium::osm_entity_bits::way);
+
+                    return true;
                 }
 
-                void decode_relation(const data_view& data) {
+                bool decode_relation(const data_view& data) {
                     osmium::builder::RelationBuilder builder{m_buffer};
 
                     varint_range keys;
@@ -491,9 +631,15 @@ namespace osmium {
                         }
                     }
 
+                    if (!m_filter.empty() &&
+                        (!m_filter.id_matches(osmium::osm_entity_bits::relation, builder.cobject().id()) ||
+                         !tags_match_filter(keys, vals, osmium::osm_entity_bits::relation))) {
+                        return false;
+                    }
+
                     builder.set_user(user.first, user.second);
 
-                    if (!refs.empty()) {
+                    if (!refs.empty() && m_read_members == osmium::io::read_members::yes) {
                         osmium::builder::RelationMemberListBuilder rml_builder{builder};
                         osmium::DeltaDecode<int64_t> ref;
                         while (!roles.empty() && !refs.empty() && !types.empty()) {
@@ -511,10 +657,36 @@ namespace osmium {
                         }
                     }
 
-                    build_tag_list(builder, keys, vals);
+                    build_tag_list(builder, keys, vals, osmium::osm_entity_bits::relation);
+
+                    return true;
+                }
+
+                // Get next tag of the current node from the keys_vals of
+                // dense nodes. Returns false at the end of the tags of the
+                // current node.
+                bool next_dense_node_tag(varint_range& tags, osm_string_len_type& key, osm_string_len_type& value) {
+                    if (tags.empty()) {
+                        return false;
+                    }
+                    const auto idx = tags.next_int32();
+                    if (idx == 0) {
+                        return false;
+                    }
+                    key = m_stringtable.at(idx);
+                    if (tags.empty()) {
+                        throw osmium::pbf_error{"PBF format error"}; // this is against the spec, keys/vals must come in pairs
+                    }
+                    value = m_stringtable.at(tags.next_int32());
+                    return true;
                 }
 
                 void build_tag_list_from_dense_nodes(osmium::builder::NodeBuilder& builder, varint_range& tags) {
+                    if (!m_read_tags.all()) {
+                        build_filtered_tag_list_from_dense_nodes(builder, tags);
+                        return;
+                    }
+
                     osmium::builder::TagListBuilder tl_builder{builder};
                     while (!tags.empty()) {
                         const auto idx = tags.next_int32();
@@ -530,6 +702,67 @@ namespace osmium {
                     }
                 }
 
+                // The tags of all dense nodes are in one array, so the tags
+                // of this node have to be consumed even if they are not
+                // wanted.
+                void build_filtered_tag_list_from_dense_nodes(osmium::builder::NodeBuilder& builder, varint_range& tags) {
+                    const bool wanted = m_read_tags.wanted(osmium::osm_entity_bits::node);
+                    const bool filtered = m_read_tags.filtered(osmium::osm_entity_bits::node);
+
+                    osm_string_len_type k;
+                    osm_string_len_type v;
+                    do {
+                        if (!next_dense_node_tag(tags, k, v)) {
+                            return;
+                        }
+                    } while (!wanted || (filtered && !keep_tag(k, v)));
+
+                    osmium::builder::TagListBuilder tl_builder{builder};
+                    tl_builder.add_tag(k.first, k.second, v.first, v.second);
+                    while (next_dense_node_tag(tags, k, v)) {
+                        if (!filtered || keep_tag(k, v)) {
+                            tl_builder.add_tag(k.first, k.second, v.first, v.second);
+                        }
+                    }
+                }
+
+                void skip_dense_node_tags(varint_range& tags) {
+                    osm_string_len_type k;
+                    osm_string_len_type v;
+                    while (next_dense_node_tag(tags, k, v)) {
+                    }
+                }
+
+                // Check the tags of the current dense node against the
+                // object filter without consuming them.
+                bool dense_node_tags_match_filter(varint_range tags) {
+                    const auto rules = m_filter.tags_rules(osmium::osm_entity_bits::node);
+                    if (rules == 0) {
+                        return true;
+                    }
+                    if (!m_read_tags.wanted(osmium::osm_entity_bits::node)) {
+                        return false;
+                    }
+
+                    const bool filtered = m_read_tags.filtered(osmium::osm_entity_bits::node);
+                    uint64_t matched = 0;
+                    osm_string_len_type k;
+                    osm_string_len_type v;
+                    while (next_dense_node_tag(tags, k, v)) {
+                        matched |= match_tag(rules, k, v, filtered);
+                        if (matched == rules) {
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+
+                bool dense_node_matches_filter(const osmium::object_id_type id, const osmium::Location& location, const varint_range& tags) {
+                    return m_filter.id_matches(osmium::osm_entity_bits::node, id) &&
+                           m_filter.location_matches(location) &&
+                           dense_node_tags_match_filter(tags);
+                }
+
                 void decode_dense_nodes_without_metadata(const data_view& data) {
                     varint_range ids;
                     varint_range lats;
@@ -567,6 +800,7 @@ namespace osmium {
                             throw osmium::pbf_error{"PBF format error"};
                         }
 
+                        bool keep = true;
                         {
                             osmium::builder::NodeBuilder builder{m_buffer};
                             osmium::Node& node = builder.object();
@@ -580,13 +814,134 @@ namespace osmium {
                                     convert_pbf_lat(lat)
                             });
 
-                            if (!tags.empty()) {
+                            if (!m_filter.empty() && !dense_node_matches_filter(builder.cobject().id(), builder.cobject().location(), tags)) {
+                                keep = false;
+                                skip_dense_node_tags(tags);
+                            } else if (!tags.empty()) {
                                 build_tag_list_from_dense_nodes(builder, tags);
                             }
                         }
-                        m_buffer.commit();
+                        commit_object(keep);
+                    }
+
+                }
+
+                void add_dense_node_tags_to_batch(osmium::builder::NodeBatchBuilder& builder, varint_range& tags) {
+                    const bool wanted = m_read_tags.wanted(osmium::osm_entity_bits::node);
+                    const bool filtered = m_read_tags.filtered(osmium::osm_entity_bits::node);
+
+                    osm_string_len_type k;
+                    osm_string_len_type v;
+                    while (next_dense_node_tag(tags, k, v)) {
+                        if (wanted && (!filtered || keep_tag(k, v))) {
+                            builder.add_tag(k.first, k.second, v.first, v.second);
+                        }
+                    }
+                }
+
+                // Decode dense nodes into a single NodeBatch instead of
+                // creating a Node object for each node. Metadata is always
+                // ignored, tags only decoded if asked for.
+                void decode_dense_nodes_as_batch(const data_view& data) {
+                    const bool with_tags = m_node_batches == osmium::io::node_batch_mode::with_tags;
+
+                    varint_range ids;
+                    varint_range lats;
+                    varint_range lons;
+                    varint_range tags;
+
+                    protozero::pbf_message<OSMFormat::DenseNodes> pbf_dense_nodes{data};
+                    while (pbf_dense_nodes.next()) {
+                        switch (pbf_dense_nodes.tag_and_type()) {
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_id, protozero::pbf_wire_type::length_delimited):
+                                ids = varint_range{pbf_dense_nodes.get_view()};
+                                break;
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lat, protozero::pbf_wire_type::length_delimited):
+                                lats = varint_range{pbf_dense_nodes.get_view()};
+                                break;
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lon, protozero::pbf_wire_type::length_delimited):
+                                lons = varint_range{pbf_dense_nodes.get_view()};
+                                break;
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_int32_keys_vals, protozero::pbf_wire_type::length_delimited):
+                                if (with_tags || m_filter.tags_rules(osmium::osm_entity_bits::node) != 0) {
+                                    tags = varint_range{pbf_dense_nodes.get_view()};
+                                } else {
+                                    pbf_dense_nodes.skip();
+                                }
+                                break;
+                            default:
+                                pbf_dense_nodes.skip();
+                        }
+                    }
+
+                    const auto count = ids.size();
+                    if (lats.size() != count || lons.size() != count) {
+                        // this is against the spec, must have same number of elements
+                        throw osmium::pbf_error{"PBF format error"};
+                    }
+
+                    if (count == 0) {
+                        return;
+                    }
+
+                    if (!m_filter.empty()) {
+                        decode_filtered_dense_nodes_as_batch(ids, lats, lons, tags, with_tags);
+                        return;
+                    }
+
+                    osmium::DeltaDecode<int64_t> dense_id;
+                    osmium::DeltaDecode<int64_t> dense_latitude;
+                    osmium::DeltaDecode<int64_t> dense_longitude;
+
+                    osmium::builder::NodeBatchBuilder builder{m_buffer, count, with_tags};
+                    while (!ids.empty()) {
+                        const auto id = dense_id.update(ids.next_sint64());
+                        const auto lon = dense_longitude.update(lons.next_sint64());
+                        const auto lat = dense_latitude.update(lats.next_sint64());
+                        builder.add_node(id, osmium::Location{convert_pbf_lon(lon), convert_pbf_lat(lat)});
+                        add_dense_node_tags_to_batch(builder, tags);
                     }
+                }
+
+                // The size of a NodeBatch must be known before it is built,
+                // so the nodes matching the object filter are collected
+                // first. The predicate of the filter is not used, because
+                // there are no Node objects it could be called with.
+                void decode_filtered_dense_nodes_as_batch(varint_range& ids, varint_range& lats, varint_range& lons, varint_range& tags, const bool with_tags) {
+                    struct batch_node {
+                        osmium::object_id_type id;
+                        osmium::Location location;
+                        varint_range tags;
+                    };
+
+                    std::vector<batch_node> nodes;
+
+                    osmium::DeltaDecode<int64_t> dense_id;
+                    osmium::DeltaDecode<int64_t> dense_latitude;
+                    osmium::DeltaDecode<int64_t> dense_longitude;
 
+                    while (!ids.empty()) {
+                        const auto id = dense_id.update(ids.next_sint64());
+                        const auto lon = dense_longitude.update(lons.next_sint64());
+                        const auto lat = dense_latitude.update(lats.next_sint64());
+                        const osmium::Location location{convert_pbf_lon(lon), convert_pbf_lat(lat)};
+                        if (dense_node_matches_filter(id, location, tags)) {
+                            nodes.push_back(batch_node{id, location, tags});
+                        }
+                        skip_dense_node_tags(tags);
+                    }
+
+                    if (nodes.empty()) {
+                        return;
+                    }
+
+                    osmium::builder::NodeBatchBuilder builder{m_buffer, nodes.size(), with_tags};
+                    for (auto& node : nodes) {
+                        builder.add_node(node.id, node.location);
+                        if (with_tags) {
+                            add_dense_node_tags_to_batch(builder, node.tags);
+                        }
+                    }
                 }
 
                 void decode_dense_nodes(const data_view& data) {
@@ -668,6 +1023,7 @@ namespace osmium {
                             throw osmium::pbf_error{"PBF format error"};
                         }
 
+                        bool keep = true;
                         {
                             bool visible = true;
 
@@ -733,20 +1089,31 @@ namespace osmium {
                                 });
                             }
 
-                            if (!tags.empty()) {
+                            if (!m_filter.empty() && !dense_node_matches_filter(builder.cobject().id(), builder.cobject().location(), tags)) {
+                                keep = false;
+                                skip_dense_node_tags(tags);
+                            } else if (!tags.empty()) {
                                 build_tag_list_from_dense_nodes(builder, tags);
                             }
                         }
-                        m_buffer.commit();
+                        commit_object(keep);
                     }
                 }
 
             public:
 
-                PBFPrimitiveBlockDecoder(const data_view& data, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata) :
+                PBFPrimitiveBlockDecoder(const data_view& data, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata,
+                                         const osmium::io::node_batch_mode node_batches = osmium::io::node_batch_mode::none,
+                                         const osmium::io::read_tags& tags = osmium::io::read_tags{},
+                                         const osmium::io::read_members members = osmium::io::read_members::yes,
+                                         const osmium::io::object_filter& filter = osmium::io::object_filter{}) :
                     m_data(data),
                     m_read_types(read_types),
-                    m_read_metadata(read_metadata) {
+                    m_read_metadata(read_metadata),
+                    m_node_batches(node_batches),
+                    m_read_tags(tags),
+                    m_read_members(members),
+                    m_filter(filter) {
                 }
 
                 PBFPrimitiveBlockDecoder(const PBFPrimitiveBlockDecoder&) = delete;
@@ -765,6 +1132,10 @@ namespace osmium {
                         throw osmium::pbf_error{"string id out of range"};
                     }
 
+                    if (!m_mixed_types) {
+                        m_buffer.set_homogeneous_type(m_decoded_type);
+                    }
+
                     return std::move(m_buffer);
                 }
 
@@ -962,18 +1333,30 @@ namespace osmium {
                 std::shared_ptr<std::string> m_input_buffer;
                 osmium::osm_entity_bits::type m_read_types;
                 osmium::io::read_meta m_read_metadata;
+                osmium::io::node_batch_mode m_node_batches;
+                osmium::io::read_tags m_read_tags;
+                osmium::io::read_members m_read_members;
+                osmium::io::object_filter m_filter;
 
             public:
 
-                PBFDataBlobDecoder(std::string&& input_buffer, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata) :
+                PBFDataBlobDecoder(std::string&& input_buffer, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata,
+                                   const osmium::io::node_batch_mode node_batches = osmium::io::node_batch_mode::none,
+                                   const osmium::io::read_tags& tags = osmium::io::read_tags{},
+                                   const osmium::io::read_members members = osmium::io::read_members::yes,
+                                   const osmium::io::object_filter& filter = osmium::io::object_filter{}) :
                     m_input_buffer(std::make_shared<std::string>(std::move(input_buffer))),
                     m_read_types(read_types),
-                    m_read_metadata(read_metadata) {
+                    m_read_metadata(read_metadata),
+                    m_node_batches(node_batches),
+                    m_read_tags(tags),
+                    m_read_members(members),
+                    m_filter(filter) {
                 }
 
                 osmium::memory::Buffer operator()() {
                     std::string output;
-                    PBFPrimitiveBlockDecoder decoder{decode_blob(*m_input_buffer, output), m_read_types, m_read_metadata};
+                    PBFPrimitiveBlockDecoder decoder{decode_blob(*m_input_buffer, output), m_read_types, m_read_metadata, m_node_batches, m_read_tags, m_read_members, m_filter};
                     return decoder();
                 }
 
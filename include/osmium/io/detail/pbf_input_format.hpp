@@ -231,7 +231,7 @@ namespace osmium {
                     while (const auto size = check_type_and_get_blob_size("OSMData")) {
                         std::string input_buffer{read_from_input_queue_with_check(size)};
 
-                        PBFDataBlobDecoder data_blob_parser{std::move(input_buffer), read_types(), read_metadata()};
+                        PBFDataBlobDecoder data_blob_parser{std::move(input_buffer), read_types(), read_metadata(), node_batches(), tag_options(), read_relation_members(), filter_options()};
 
                         if (use_pool) {
                             send_to_output_queue(get_pool().submit(std::move(data_blob_parser)));
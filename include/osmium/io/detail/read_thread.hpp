@@ -35,6 +35,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/io/compression.hpp>
 #include <osmium/io/detail/queue_util.hpp>
+#include <osmium/thread/stats.hpp>
 #include <osmium/thread/util.hpp>
 
 #include <atomic>
@@ -63,6 +64,7 @@ namespace osmium {
 
                 // used in both threads
                 std::atomic<bool> m_done;
+                osmium::thread::detail::throughput_counter m_throughput{};
 
                 // only used in the main thread
                 std::thread m_thread;
@@ -76,6 +78,7 @@ namespace osmium {
                             if (at_end_of_data(data)) {
                                 break;
                             }
+                            m_throughput.add(data.size());
                             add_to_queue(m_queue, std::move(data));
                         }
 
@@ -111,6 +114,11 @@ namespace osmium {
                     }
                 }
 
+                /// The amount of (decompressed) data read so far.
+                osmium::thread::throughput_stats throughput() const noexcept {
+                    return m_throughput.stats();
+                }
+
                 void stop() noexcept {
                     m_done = true;
                 }
@@ -35,6 +35,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/io/compression.hpp>
 #include <osmium/io/detail/queue_util.hpp>
+#include <osmium/thread/stats.hpp>
 #include <osmium/thread/util.hpp>
 
 #include <exception>
@@ -60,17 +61,20 @@ namespace osmium {
                 std::unique_ptr<osmium::io::Compressor> m_compressor;
                 std::promise<std::size_t> m_promise;
                 std::atomic_bool* m_notification;
+                osmium::thread::detail::throughput_counter* m_throughput;
 
             public:
 
                 WriteThread(future_string_queue_type& input_queue,
                             std::unique_ptr<osmium::io::Compressor>&& compressor,
                             std::promise<std::size_t>&& promise,
-                            std::atomic_bool* notification) :
+                            std::atomic_bool* notification,
+                            osmium::thread::detail::throughput_counter* throughput = nullptr) :
                     m_queue(input_queue),
                     m_compressor(std::move(compressor)),
                     m_promise(std::move(promise)),
-                    m_notification(notification) {
+                    m_notification(notification),
+                    m_throughput(throughput) {
                 }
 
                 WriteThread(const WriteThread&) = delete;
@@ -91,6 +95,9 @@ namespace osmium {
                                 break;
                             }
                             m_compressor->write(data);
+                            if (m_throughput) {
+                                m_throughput->add(data.size());
+                            }
                         }
                         m_compressor->close();
                         m_promise.set_value(m_compressor->file_size());
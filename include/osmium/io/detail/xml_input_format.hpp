@@ -325,7 +325,7 @@ namespace osmium {
                     builder.set_bounds(box);
                 }
 
-                void get_tag(osmium::builder::Builder& builder, const XML_Char** attrs) {
+                void get_tag(osmium::builder::Builder& builder, const XML_Char** attrs, const osmium::osm_entity_bits::type entity) {
                     const char* k = "";
                     const char* v = "";
 
@@ -337,6 +337,10 @@ namespace osmium {
                         }
                     });
 
+                    if (tag_options().filtered(entity) && !tag_options()(k, v)) {
+                        return;
+                    }
+
                     if (!m_tl_builder) {
                         m_tl_builder.reset(new osmium::builder::TagListBuilder{builder});
                     }
@@ -494,8 +498,8 @@ namespace osmium {
                         case context::node:
                             if (!std::strcmp(element, "tag")) {
                                 m_context_stack.push_back(context::tag);
-                                if (read_types() & osmium::osm_entity_bits::node) {
-                                    get_tag(*m_node_builder, attrs);
+                                if ((read_types() & osmium::osm_entity_bits::node) && tag_options().wanted(osmium::osm_entity_bits::node)) {
+                                    get_tag(*m_node_builder, attrs, osmium::osm_entity_bits::node);
                                 }
                             } else {
                                 throw xml_error{std::string{"Unknown element in <node>: "} + element};
@@ -525,9 +529,9 @@ namespace osmium {
                                 }
                             } else if (!std::strcmp(element, "tag")) {
                                 m_context_stack.push_back(context::tag);
-                                if (read_types() & osmium::osm_entity_bits::way) {
+                                if ((read_types() & osmium::osm_entity_bits::way) && tag_options().wanted(osmium::osm_entity_bits::way)) {
                                     m_wnl_builder.reset();
-                                    get_tag(*m_way_builder, attrs);
+                                    get_tag(*m_way_builder, attrs, osmium::osm_entity_bits::way);
                                 }
                             } else if (!std::strcmp(element, "bbox") || !std::strcmp(element, "bounds")) {
                                 m_context_stack.push_back(context::obj_bbox);
@@ -538,7 +542,7 @@ namespace osmium {
                         case context::relation:
                             if (!std::strcmp(element, "member")) {
                                 m_context_stack.push_back(context::member);
-                                if (read_types() & osmium::osm_entity_bits::relation) {
+                                if ((read_types() & osmium::osm_entity_bits::relation) && read_relation_members() == osmium::io::read_members::yes) {
                                     m_tl_builder.reset();
 
                                     if (!m_rml_builder) {
@@ -569,9 +573,9 @@ namespace osmium {
                                 }
                             } else if (!std::strcmp(element, "tag")) {
                                 m_context_stack.push_back(context::tag);
-                                if (read_types() & osmium::osm_entity_bits::relation) {
+                                if ((read_types() & osmium::osm_entity_bits::relation) && tag_options().wanted(osmium::osm_entity_bits::relation)) {
                                     m_rml_builder.reset();
-                                    get_tag(*m_relation_builder, attrs);
+                                    get_tag(*m_relation_builder, attrs, osmium::osm_entity_bits::relation);
                                 }
                             } else if (!std::strcmp(element, "bbox") || !std::strcmp(element, "bounds")) {
                                 m_context_stack.push_back(context::obj_bbox);
@@ -596,9 +600,9 @@ namespace osmium {
                                 }
                             } else if (!std::strcmp(element, "tag")) {
                                 m_context_stack.push_back(context::tag);
-                                if (read_types() & osmium::osm_entity_bits::changeset) {
+                                if ((read_types() & osmium::osm_entity_bits::changeset) && tag_options().wanted(osmium::osm_entity_bits::changeset)) {
                                     m_changeset_discussion_builder.reset();
-                                    get_tag(*m_changeset_builder, attrs);
+                                    get_tag(*m_changeset_builder, attrs, osmium::osm_entity_bits::changeset);
                                 }
                             } else {
                                 throw xml_error{std::string{"Unknown element in <changeset>: "} + element};
@@ -673,7 +677,7 @@ namespace osmium {
                             if (read_types() & osmium::osm_entity_bits::node) {
                                 m_tl_builder.reset();
                                 m_node_builder.reset();
-                                buffer().commit();
+                                commit_object();
                                 flush_nested_buffer();
                             }
                             break;
@@ -683,7 +687,7 @@ namespace osmium {
                                 m_tl_builder.reset();
                                 m_wnl_builder.reset();
                                 m_way_builder.reset();
-                                buffer().commit();
+                                commit_object();
                                 flush_nested_buffer();
                             }
                             break;
@@ -693,7 +697,7 @@ namespace osmium {
                                 m_tl_builder.reset();
                                 m_rml_builder.reset();
                                 m_relation_builder.reset();
-                                buffer().commit();
+                                commit_object();
                                 flush_nested_buffer();
                             }
                             break;
@@ -57,11 +57,26 @@ namespace osmium {
             yes = 1
         };
 
+        enum class read_members {
+            no  = 0,
+            yes = 1
+        };
+
         enum class buffers_type {
             any    = 0,
             single = 1
         };
 
+        /**
+         * Read nodes as osmium::Node objects (the default) or as columnar
+         * osmium::NodeBatch items without metadata, optionally with tags.
+         */
+        enum class node_batch_mode {
+            none      = 0,
+            locations = 1,
+            with_tags = 2
+        };
+
         inline const char* as_string(const file_format format) noexcept {
             switch (format) {
                 case file_format::xml:
@@ -0,0 +1,305 @@
+#ifndef OSMIUM_IO_OBJECT_FILTER_HPP
+#define OSMIUM_IO_OBJECT_FILTER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/tag.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/tags/tags_filter.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Reader option deciding which OSM objects are kept. Objects can be
+         * selected by their tags, by ID ranges, by location (for nodes),
+         * and by an arbitrary predicate. Objects failing any of the checks
+         * are dropped by the parser and never reach the buffers returned
+         * from Reader::read().
+         *
+         * The PBF parser runs these checks in the decoder tasks on the
+         * thread pool. IDs, locations, and tags are checked before the
+         * object is built, the predicate is called on the finished object.
+         * The XML, O5M, and OPL parsers check the finished objects on the
+         * parser thread.
+         *
+         * Nodes read as osmium::NodeBatch (see osmium::io::node_batch_mode)
+         * are checked against IDs, locations, and tags, but not against
+         * the predicate, because there is no osmium::Node object to call
+         * it with.
+         *
+         * Usage:
+         * @code
+         * // Only read highways and nodes in a bounding box
+         * osmium::TagsFilter highways{false};
+         * highways.add_rule(true, "highway");
+         * osmium::io::object_filter filter;
+         * filter.tags(highways, osmium::osm_entity_bits::way);
+         * filter.bbox(osmium::Box{9.0, 48.0, 10.0, 49.0});
+         * osmium::io::Reader reader{"input.osm.pbf", filter};
+         * @endcode
+         *
+         * The filter sees the tags as they are read, so tags removed with
+         * the read_tags option can not be matched.
+         */
+        class object_filter {
+
+        public:
+
+            using predicate_type = std::function<bool(const osmium::OSMObject&)>;
+
+            /// The maximum number of tags filters that can be added.
+            enum {
+                max_tags_filters = 64
+            };
+
+        private:
+
+            struct tags_rule {
+                // Shared between all copies given to the parser threads.
+                std::shared_ptr<const osmium::TagsFilter> filter;
+                osmium::osm_entity_bits::type entities;
+            };
+
+            struct id_range {
+                osmium::osm_entity_bits::type entities;
+                osmium::object_id_type first;
+                osmium::object_id_type last;
+            };
+
+            std::vector<tags_rule> m_tags_rules;
+            std::vector<id_range> m_id_ranges;
+            osmium::Box m_bbox{};
+            predicate_type m_predicate{};
+            osmium::osm_entity_bits::type m_tags_entities = osmium::osm_entity_bits::nothing;
+            osmium::osm_entity_bits::type m_id_entities = osmium::osm_entity_bits::nothing;
+            osmium::osm_entity_bits::type m_predicate_entities = osmium::osm_entity_bits::nothing;
+
+        public:
+
+            /**
+             * Only keep objects of the specified entity types with at
+             * least one tag matching the filter. If this is called several
+             * times, objects have to match all filters.
+             *
+             * @param filter Tags filter, a tag matches if the filter
+             *               returns true.
+             * @param entities The entities the filter is used for.
+             * @returns A reference to this object for chaining.
+             * @throws std::length_error If more than max_tags_filters
+             *         filters are added.
+             */
+            object_filter& tags(osmium::TagsFilter filter, const osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::all) {
+                if (m_tags_rules.size() >= max_tags_filters) {
+                    throw std::length_error{"too many tags filters in object_filter"};
+                }
+                m_tags_rules.push_back(tags_rule{std::make_shared<const osmium::TagsFilter>(std::move(filter)), entities});
+                m_tags_entities |= entities;
+                return *this;
+            }
+
+            /**
+             * Only keep objects of the specified entity types with an ID
+             * in the range first to last (inclusive). If this is called
+             * several times, the ID has to be in any of the ranges given
+             * for its entity type.
+             *
+             * @returns A reference to this object for chaining.
+             */
+            object_filter& ids(const osmium::osm_entity_bits::type entities, const osmium::object_id_type first, const osmium::object_id_type last) {
+                m_id_ranges.push_back(id_range{entities, first, last});
+                m_id_entities |= entities;
+                return *this;
+            }
+
+            /**
+             * Only keep nodes with a location inside the box. Nodes without
+             * a location are dropped, too. Ways and relations are not
+             * affected. Replaces any box set before.
+             *
+             * @returns A reference to this object for chaining.
+             */
+            object_filter& bbox(const osmium::Box& box) noexcept {
+                m_bbox = box;
+                return *this;
+            }
+
+            /**
+             * Only keep objects of the specified entity types for which the
+             * predicate returns true. The predicate is called from several
+             * threads at the same time, so it must be thread safe. It is
+             * called after all other checks passed. Replaces any predicate
+             * set before.
+             *
+             * The predicate is not used for nodes read into an
+             * osmium::NodeBatch.
+             *
+             * @returns A reference to this object for chaining.
+             */
+            object_filter& predicate(predicate_type predicate, const osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::all) {
+                m_predicate = std::move(predicate);
+                m_predicate_entities = m_predicate ? entities : osmium::osm_entity_bits::nothing;
+                return *this;
+            }
+
+            /**
+             * Are all objects kept? Parsers use this to avoid any checks in
+             * the common case.
+             */
+            bool empty() const noexcept {
+                return m_tags_entities == osmium::osm_entity_bits::nothing &&
+                       m_id_entities == osmium::osm_entity_bits::nothing &&
+                       !m_bbox.valid() &&
+                       m_predicate_entities == osmium::osm_entity_bits::nothing;
+            }
+
+            /**
+             * Check the ID of an object of the specified entity type.
+             */
+            bool id_matches(const osmium::osm_entity_bits::type entity, const osmium::object_id_type id) const noexcept {
+                if ((m_id_entities & entity) == 0) {
+                    return true;
+                }
+                for (const auto& range : m_id_ranges) {
+                    if ((range.entities & entity) != 0 && id >= range.first && id <= range.last) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            /**
+             * Check the location of a node.
+             */
+            bool location_matches(const osmium::Location& location) const noexcept {
+                if (!m_bbox.valid()) {
+                    return true;
+                }
+                return location && m_bbox.contains(location);
+            }
+
+            /**
+             * Get the tags filters that have to match for the specified
+             * entity type as a bitmask. Returns 0 if tags are not checked.
+             */
+            uint64_t tags_rules(const osmium::osm_entity_bits::type entity) const noexcept {
+                if ((m_tags_entities & entity) == 0) {
+                    return 0;
+                }
+                uint64_t mask = 0;
+                for (std::size_t i = 0; i < m_tags_rules.size(); ++i) {
+                    if ((m_tags_rules[i].entities & entity) != 0) {
+                        mask |= 1ULL << i;
+                    }
+                }
+                return mask;
+            }
+
+            /**
+             * Check a tag against the tags filters in the bitmask.
+             *
+             * @returns The bitmask of those filters matching the tag.
+             */
+            uint64_t tag_matches(const uint64_t rules, const char* key, const char* value) const noexcept {
+                uint64_t matched = 0;
+                for (std::size_t i = 0; i < m_tags_rules.size(); ++i) {
+                    const uint64_t bit = 1ULL << i;
+                    if ((rules & bit) != 0 && (*m_tags_rules[i].filter)(key, value)) {
+                        matched |= bit;
+                    }
+                }
+                return matched;
+            }
+
+            /**
+             * Check a finished object with the predicate.
+             */
+            bool predicate_matches(const osmium::OSMObject& object) const {
+                if ((m_predicate_entities & osmium::osm_entity_bits::from_item_type(object.type())) == 0) {
+                    return true;
+                }
+                return m_predicate(object);
+            }
+
+            /**
+             * Check a finished object against all parts of the filter.
+             */
+            bool operator()(const osmium::OSMObject& object) const {
+                const auto entity = osmium::osm_entity_bits::from_item_type(object.type());
+
+                if (!id_matches(entity, object.id())) {
+                    return false;
+                }
+
+                if (entity == osmium::osm_entity_bits::node &&
+                    !location_matches(static_cast<const osmium::Node&>(object).location())) {
+                    return false;
+                }
+
+                const auto rules = tags_rules(entity);
+                if (rules != 0) {
+                    uint64_t matched = 0;
+                    for (const osmium::Tag& tag : object.tags()) {
+                        matched |= tag_matches(rules, tag.key(), tag.value());
+                        if (matched == rules) {
+                            break;
+                        }
+                    }
+                    if (matched != rules) {
+                        return false;
+                    }
+                }
+
+                return predicate_matches(object);
+            }
+
+        }; // class object_filter
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_OBJECT_FILTER_HPP
@@ -0,0 +1,156 @@
+#ifndef OSMIUM_IO_READ_TAGS_HPP
+#define OSMIUM_IO_READ_TAGS_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/tags/tags_filter.hpp>
+
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Reader option deciding which tags are decoded. By default all
+         * tags of all entities are read. Tags of some entity types can be
+         * skipped completely or reduced to those matching a TagsFilter.
+         * This happens while decoding, so tags not needed are never copied
+         * into the buffers and objects without wanted tags don't get a tag
+         * list at all.
+         *
+         * Usage:
+         * @code
+         * // Only read node tags with keys "amenity" or "shop", skip tags
+         * // on relations completely.
+         * osmium::io::read_tags tags;
+         * tags.filter({"amenity", "shop"}, osmium::osm_entity_bits::node);
+         * tags.skip(osmium::osm_entity_bits::relation);
+         * osmium::io::Reader reader{"input.osm.pbf", tags};
+         * @endcode
+         *
+         * This is honored by the PBF, XML, and O5M parsers.
+         */
+        class read_tags {
+
+            // Shared between all copies given to the parser threads.
+            std::shared_ptr<const osmium::TagsFilter> m_filter{};
+            osmium::osm_entity_bits::type m_skipped = osmium::osm_entity_bits::nothing;
+            osmium::osm_entity_bits::type m_filtered = osmium::osm_entity_bits::nothing;
+
+        public:
+
+            /**
+             * Don't read any tags for the specified entity types.
+             *
+             * @returns A reference to this object for chaining.
+             */
+            read_tags& skip(const osmium::osm_entity_bits::type entities) noexcept {
+                m_skipped |= entities;
+                return *this;
+            }
+
+            /**
+             * Only read tags matching the filter for the specified entity
+             * types. Replaces any filter set before.
+             *
+             * @param filter Tags filter, a tag is kept if the filter
+             *               returns true.
+             * @param entities The entities the filter is used for.
+             * @returns A reference to this object for chaining.
+             */
+            read_tags& filter(osmium::TagsFilter filter, const osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::all) {
+                m_filter = std::make_shared<const osmium::TagsFilter>(std::move(filter));
+                m_filtered = entities;
+                return *this;
+            }
+
+            /**
+             * Only read tags with any of the specified keys for the
+             * specified entity types. Replaces any filter set before.
+             *
+             * @param keys The keys of the tags to keep.
+             * @param entities The entities the filter is used for.
+             * @returns A reference to this object for chaining.
+             */
+            read_tags& filter(const std::initializer_list<const char*> keys, const osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::all) {
+                osmium::TagsFilter keys_filter{false};
+                for (const char* key : keys) {
+                    keys_filter.add_rule(true, key);
+                }
+                return filter(std::move(keys_filter), entities);
+            }
+
+            /**
+             * Are all tags read? Parsers use this to avoid any checks in
+             * the common case.
+             */
+            bool all() const noexcept {
+                return m_skipped == osmium::osm_entity_bits::nothing && !m_filter;
+            }
+
+            /**
+             * Should any tags of the specified entity type be read?
+             */
+            bool wanted(const osmium::osm_entity_bits::type entity) const noexcept {
+                return (m_skipped & entity) == 0;
+            }
+
+            /**
+             * Should the tags of the specified entity type be checked with
+             * the filter?
+             */
+            bool filtered(const osmium::osm_entity_bits::type entity) const noexcept {
+                return m_filter && (m_filtered & entity) != 0;
+            }
+
+            /**
+             * Check a tag against the filter.
+             *
+             * @pre @code filtered(entity) @endcode for the entity type of
+             *      the object the tag belongs to.
+             */
+            bool operator()(const char* key, const char* value) const noexcept {
+                return (*m_filter)(key, value);
+            }
+
+        }; // class read_tags
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_READ_TAGS_HPP
@@ -41,9 +41,12 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/error.hpp>
 #include <osmium/io/file.hpp>
 #include <osmium/io/header.hpp>
+#include <osmium/io/object_filter.hpp>
+#include <osmium/io/read_tags.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/entity_bits.hpp>
 #include <osmium/thread/pool.hpp>
+#include <osmium/thread/stats.hpp>
 #include <osmium/thread/util.hpp>
 #include <osmium/util/config.hpp>
 
@@ -81,6 +84,36 @@ namespace osmium {
 
         } // namespace detail
 
+        /**
+         * Statistics of a Reader, see Reader::stats(). Data flows from the
+         * read thread through the input queue to the parser (which might
+         * use the pool) and through the osmdata queue to Reader::read().
+         *
+         * If the input queue is often full (input_queue.push_blocked is
+         * large), parsing is the bottleneck. If the osmdata queue is often
+         * full, the code calling read() is the bottleneck. If the osmdata
+         * queue is often empty, but the input queue is not, parsing is the
+         * bottleneck, if both are often empty, reading is.
+         */
+        struct reader_stats {
+
+            /// Data read from the file (after decompression).
+            osmium::thread::throughput_stats input;
+
+            /// Queue between the read thread and the parser.
+            osmium::thread::queue_stats input_queue;
+
+            /// Queue between the parser and Reader::read().
+            osmium::thread::queue_stats osmdata_queue;
+
+            /// Buffers returned from Reader::read().
+            osmium::thread::throughput_stats output;
+
+            /// The thread pool used (shared with all other users).
+            osmium::thread::pool_stats pool;
+
+        }; // struct reader_stats
+
         /**
          * This is the user-facing interface for reading OSM files. Instantiate
          * an object of this class with a file name or osmium::io::File object
@@ -124,6 +157,9 @@ namespace osmium {
             detail::future_buffer_queue_type m_osmdata_queue;
             detail::queue_wrapper<osmium::memory::Buffer> m_osmdata_queue_wrapper;
 
+            // Buffers returned from read().
+            osmium::thread::detail::throughput_counter m_output_throughput{};
+
             std::future<osmium::io::Header> m_header_future{};
             osmium::io::Header m_header{};
 
@@ -132,6 +168,10 @@ namespace osmium {
             osmium::osm_entity_bits::type m_read_which_entities = osmium::osm_entity_bits::all;
             osmium::io::read_meta m_read_metadata = osmium::io::read_meta::yes;
             osmium::io::buffers_type m_buffers_kind = osmium::io::buffers_type::any;
+            osmium::io::node_batch_mode m_node_batches = osmium::io::node_batch_mode::none;
+            osmium::io::read_tags m_read_tags{};
+            osmium::io::read_members m_read_members = osmium::io::read_members::yes;
+            osmium::io::object_filter m_object_filter{};
 
             void set_option(osmium::thread::Pool& pool) noexcept {
                 m_pool = &pool;
@@ -154,6 +194,26 @@ namespace osmium {
                 m_buffers_kind = value;
             }
 
+            void set_option(osmium::io::node_batch_mode value) noexcept {
+                // Ignore this setting if we have a history/change file,
+                // because node batches can't represent deleted nodes.
+                if (!m_file.has_multiple_object_versions()) {
+                    m_node_batches = value;
+                }
+            }
+
+            void set_option(const osmium::io::read_tags& value) {
+                m_read_tags = value;
+            }
+
+            void set_option(osmium::io::read_members value) noexcept {
+                m_read_members = value;
+            }
+
+            void set_option(const osmium::io::object_filter& value) {
+                m_object_filter = value;
+            }
+
             // This function will run in a separate thread.
             static void parser_thread(osmium::thread::Pool& pool,
                                       int fd,
@@ -165,6 +225,10 @@ namespace osmium {
                                       osmium::osm_entity_bits::type read_which_entities,
                                       osmium::io::read_meta read_metadata,
                                       osmium::io::buffers_type buffers_kind,
+                                      osmium::io::node_batch_mode node_batches,
+                                      const osmium::io::read_tags& tags,
+                                      osmium::io::read_members members,
+                                      const osmium::io::object_filter& filter,
                                       bool want_buffered_pages_removed) {
                 std::promise<osmium::io::Header> promise{std::move(header_promise)};
                 osmium::io::detail::parser_arguments args = {
@@ -177,6 +241,10 @@ namespace osmium {
                     read_which_entities,
                     read_metadata,
                     buffers_kind,
+                    node_batches,
+                    tags,
+                    members,
+                    filter,
                     want_buffered_pages_removed};
                 creator(args)->parse();
             }
@@ -305,6 +373,38 @@ namespace osmium {
              *      use in "single" mode if the input file is not sorted by
              *      type, otherwise this will be rather inefficient.
              *
+             * * osmium::io::node_batch_mode: Read nodes as osmium::Node
+             *      objects (osmium::io::node_batch_mode::none, the default)
+             *      or as osmium::NodeBatch items containing only IDs and
+             *      locations (osmium::io::node_batch_mode::locations) or
+             *      IDs, locations, and tags
+             *      (osmium::io::node_batch_mode::with_tags). Batches are
+             *      much faster to create if you don't need the metadata.
+             *      Currently only the PBF parser creates batches and only
+             *      for dense nodes, other nodes are still returned as
+             *      osmium::Node objects. Ignored for history and change
+             *      files.
+             *
+             * * osmium::io::read_tags: Which tags to read. Tags can be
+             *      skipped for some entity types or filtered with a
+             *      TagsFilter while decoding. See the read_tags class for
+             *      details. The default is to read all tags. Only the PBF,
+             *      XML, and O5M parsers use this setting.
+             *
+             * * osmium::io::read_members: Read relation members or not.
+             *      The default is osmium::io::read_members::yes. If you
+             *      set this to osmium::io::read_members::no, relations
+             *      will have an empty member list. Only the PBF, XML, and
+             *      O5M parsers use this setting.
+             *
+             * * osmium::io::object_filter: Which objects to read. Objects
+             *      can be selected by tags, ID ranges, location, or a
+             *      predicate. Objects not matching are dropped by the
+             *      parser and never show up in the buffers. See the
+             *      object_filter class for details. The default is to read
+             *      all objects. Nodes read into an osmium::NodeBatch are
+             *      not checked with the predicate.
+             *
              * * osmium::thread::Pool&: Reference to a thread pool that should
              *      be used for reading instead of the default pool. Usually
              *      it is okay to use the statically initialized shared
@@ -319,12 +419,12 @@ namespace osmium {
             explicit Reader(const osmium::io::File& file, TArgs&&... args) :
                 m_file(file.check()),
                 m_creator(detail::ParserFactory::instance().get_creator_function(m_file)),
-                m_input_queue(detail::get_input_queue_size(), "raw_input"),
+                m_input_queue(detail::get_input_queue_size(), "raw_input", osmium::thread::queue_kind::spsc),
                 m_fd(m_file.buffer() ? -1 : open_input_file_or_url(m_file.filename(), &m_childpid)),
                 m_file_size(m_fd > 2 ? osmium::file_size(m_fd) : 0),
                 m_decompressor(make_decompressor(m_file, m_fd, &m_offset)),
                 m_read_thread_manager(*m_decompressor, m_input_queue),
-                m_osmdata_queue(detail::get_osmdata_queue_size(), "parser_results"),
+                m_osmdata_queue(detail::get_osmdata_queue_size(), "parser_results", osmium::thread::queue_kind::spsc),
                 m_osmdata_queue_wrapper(m_osmdata_queue) {
 
                 (void)std::initializer_list<int>{(set_option(args), 0)...};
@@ -345,7 +445,8 @@ namespace osmium {
                 m_thread = osmium::thread::thread_handler{parser_thread, std::ref(*m_pool), fd_for_parser, std::ref(m_creator),
                                                           std::ref(m_input_queue), std::ref(m_osmdata_queue),
                                                           std::move(header_promise), &m_offset, m_read_which_entities,
-                                                          m_read_metadata, m_buffers_kind,
+                                                          m_read_metadata, m_buffers_kind, m_node_batches,
+                                                          m_read_tags, m_read_members, m_object_filter,
                                                           m_decompressor->want_buffered_pages_removed()};
             }
 
@@ -452,6 +553,7 @@ namespace osmium {
                         buffer = std::move(m_back_buffers);
                         m_back_buffers = osmium::memory::Buffer{};
                     }
+                    m_output_throughput.add(buffer.committed());
                     return buffer;
                 }
 
@@ -481,6 +583,7 @@ namespace osmium {
                             buffer = std::move(*m_back_buffers.get_last_nested());
                         }
                         if (buffer.committed() > 0) {
+                            m_output_throughput.add(buffer.committed());
                             return buffer;
                         }
                     }
@@ -525,6 +628,21 @@ namespace osmium {
                 return m_offset;
             }
 
+            /**
+             * Get statistics about the reading and parsing of the file.
+             * This can be called from any thread at any time, for instance
+             * to export the numbers to some monitoring system while reading.
+             */
+            reader_stats stats() const {
+                reader_stats result;
+                result.input = m_read_thread_manager.throughput();
+                result.input_queue = m_input_queue.stats();
+                result.osmdata_queue = m_osmdata_queue.stats();
+                result.output = m_output_throughput.stats();
+                result.pool = m_pool->stats();
+                return result;
+            }
+
         }; // class Reader
 
         /**
@@ -44,6 +44,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/writer_options.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/thread/pool.hpp>
+#include <osmium/thread/stats.hpp>
 #include <osmium/thread/util.hpp>
 #include <osmium/util/config.hpp>
 #include <osmium/version.hpp>
@@ -74,6 +75,31 @@ namespace osmium {
 
         } // namespace detail
 
+        /**
+         * Statistics of a Writer, see Writer::stats(). Buffers given to
+         * the Writer are encoded (usually in the pool) and the results are
+         * sent through the output queue to the write thread.
+         *
+         * If the output queue is often full (output_queue.push_blocked is
+         * large), compressing and writing is the bottleneck. If it is often
+         * empty, encoding or the code producing the data is.
+         */
+        struct writer_stats {
+
+            /// Buffers given to the output format for encoding.
+            osmium::thread::throughput_stats input;
+
+            /// Queue between the output format and the write thread.
+            osmium::thread::queue_stats output_queue;
+
+            /// Data written by the write thread (before compression).
+            osmium::thread::throughput_stats output;
+
+            /// The thread pool used (shared with all other users).
+            osmium::thread::pool_stats pool;
+
+        }; // struct writer_stats
+
         /**
          * This is the user-facing interface for writing OSM files. Instantiate
          * an object of this class with a file name or osmium::io::File object
@@ -105,10 +131,19 @@ namespace osmium {
 
             osmium::io::File m_file;
 
-            detail::future_string_queue_type m_output_queue{detail::get_output_queue_size(), "raw_output"};
+            // Only the thread using the Writer pushes to this queue and only the
+            // write thread pops from it.
+            detail::future_string_queue_type m_output_queue{detail::get_output_queue_size(), "raw_output", osmium::thread::queue_kind::spsc};
 
             std::unique_ptr<osmium::io::detail::OutputFormat> m_output{nullptr};
 
+            osmium::thread::Pool* m_pool = nullptr;
+
+            // Buffers given to the output format (in the thread using
+            // the Writer) and data written by the write thread.
+            osmium::thread::detail::throughput_counter m_input_throughput{};
+            osmium::thread::detail::throughput_counter m_output_throughput{};
+
             osmium::memory::Buffer m_buffer{};
 
             osmium::io::Header m_header;
@@ -137,11 +172,13 @@ namespace osmium {
             static void write_thread(detail::future_string_queue_type& output_queue,
                                      std::unique_ptr<osmium::io::Compressor>&& compressor,
                                      std::promise<std::size_t>&& write_promise,
-                                     std::atomic_bool* notification) {
+                                     std::atomic_bool* notification,
+                                     osmium::thread::detail::throughput_counter* throughput) {
                 detail::WriteThread write_thread{output_queue,
                                                  std::move(compressor),
                                                  std::move(write_promise),
-                                                 notification};
+                                                 notification,
+                                                 throughput};
                 write_thread();
             }
 
@@ -160,6 +197,7 @@ namespace osmium {
                     write_header();
                 }
                 if (buffer && buffer.committed() > 0) {
+                    m_input_throughput.add(buffer.committed());
                     m_output->write_buffer(std::move(buffer));
                 }
             }
@@ -177,6 +215,7 @@ namespace osmium {
                     using std::swap;
                     swap(m_buffer, buffer);
 
+                    m_input_throughput.add(buffer.committed());
                     m_output->write_buffer(std::move(buffer));
                 }
             }
@@ -276,6 +315,7 @@ namespace osmium {
                 }
 
                 m_header = options.header;
+                m_pool = options.pool;
 
                 m_output = osmium::io::detail::OutputFormatFactory::instance().create_output(*options.pool, m_file, m_output_queue);
 
@@ -286,7 +326,7 @@ namespace osmium {
 
                 std::promise<std::size_t> write_promise;
                 m_write_future = write_promise.get_future();
-                m_thread = osmium::thread::thread_handler{write_thread, std::ref(m_output_queue), std::move(compressor), std::move(write_promise), &m_notification};
+                m_thread = osmium::thread::thread_handler{write_thread, std::ref(m_output_queue), std::move(compressor), std::move(write_promise), &m_notification, &m_output_throughput};
             }
 
             template <typename... TArgs>
@@ -328,6 +368,19 @@ namespace osmium {
                 m_buffer_size = size;
             }
 
+            /**
+             * Get statistics about the encoding and writing of the file.
+             * This can be called from any thread at any time.
+             */
+            writer_stats stats() const {
+                writer_stats result;
+                result.input = m_input_throughput.stats();
+                result.output_queue = m_output_queue.stats();
+                result.output = m_output_throughput.stats();
+                result.pool = m_pool->stats();
+                return result;
+            }
+
             /**
              * Set header. This will overwrite a header set in the constructor.
              *
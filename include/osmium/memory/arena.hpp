@@ -0,0 +1,254 @@
+#ifndef OSMIUM_MEMORY_ARENA_HPP
+#define OSMIUM_MEMORY_ARENA_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace osmium {
+
+    namespace memory {
+
+        /**
+         * A simple monotonic memory arena. Memory is allocated from a list
+         * of blocks and never freed individually. Call reset() to make all
+         * memory available again. This is useful for scratch data that is
+         * built up and thrown away as a whole many times, for instance
+         * when assembling areas.
+         *
+         * After a reset() the memory is kept for the next round (up to
+         * max_retained() bytes). If more than one block was used, they are
+         * replaced by a single block large enough for all of them, so after
+         * a few rounds allocations don't need the global heap any more.
+         *
+         * Use the ArenaAllocator class to use the arena with standard
+         * containers.
+         */
+        class Arena {
+
+            struct block {
+                std::unique_ptr<unsigned char[]> data;
+                std::size_t size;
+            };
+
+            std::vector<block> m_blocks{};
+
+            // Block we are currently allocating from.
+            std::size_t m_current = 0;
+
+            // Offset of first unused byte in current block.
+            std::size_t m_offset = 0;
+
+            std::size_t m_block_size;
+
+            std::size_t m_max_retained;
+
+            void add_block(std::size_t min_size) {
+                std::size_t size = m_blocks.empty() ? m_block_size : m_blocks.back().size * 2;
+                size = std::max(size, min_size);
+                m_blocks.push_back(block{std::unique_ptr<unsigned char[]>{new unsigned char[size]}, size});
+            }
+
+        public:
+
+            enum : std::size_t {
+                default_block_size = 64UL * 1024UL,
+                default_max_retained = 64UL * 1024UL * 1024UL
+            };
+
+            /**
+             * Construct an arena. No memory is allocated until the first
+             * call to allocate().
+             *
+             * @param block_size Size of the first block allocated.
+             * @param max_retained Keep at most this many bytes when reset()
+             *                     is called.
+             */
+            explicit Arena(std::size_t block_size = default_block_size, std::size_t max_retained = default_max_retained) :
+                m_block_size(block_size),
+                m_max_retained(max_retained) {
+            }
+
+            Arena(const Arena&) = delete;
+            Arena& operator=(const Arena&) = delete;
+
+            Arena(Arena&&) = default;
+            Arena& operator=(Arena&&) = default;
+
+            ~Arena() noexcept = default;
+
+            /**
+             * Allocate memory from the arena.
+             *
+             * @param size Number of bytes.
+             * @param alignment Alignment of the memory. Must be a power of
+             *                  two not larger than alignof(std::max_align_t).
+             * @returns Pointer to memory.
+             * @throws std::bad_alloc If there is not enough memory.
+             */
+            void* allocate(std::size_t size, std::size_t alignment) {
+                while (m_current < m_blocks.size()) {
+                    auto& blk = m_blocks[m_current];
+                    const std::size_t offset = (m_offset + alignment - 1) & ~(alignment - 1);
+                    if (offset + size <= blk.size) {
+                        m_offset = offset + size;
+                        return blk.data.get() + offset;
+                    }
+                    ++m_current;
+                    m_offset = 0;
+                }
+
+                add_block(size);
+                m_offset = size;
+                return m_blocks.back().data.get();
+            }
+
+            /**
+             * Make all memory of the arena available again. Any memory
+             * allocated before must not be used any more.
+             */
+            void reset() noexcept {
+                if (m_blocks.size() > 1) {
+                    std::size_t size = 0;
+                    for (const auto& blk : m_blocks) {
+                        size += blk.size;
+                    }
+                    m_blocks.clear();
+                    if (size <= m_max_retained) {
+                        try {
+                            add_block(size);
+                        } catch (const std::bad_alloc&) {
+                            // ignore, we'll allocate again when needed
+                        }
+                    }
+                } else if (!m_blocks.empty() && m_blocks.front().size > m_max_retained) {
+                    m_blocks.clear();
+                }
+                m_current = 0;
+                m_offset = 0;
+            }
+
+            /// The number of bytes allocated from the arena since the last reset().
+            std::size_t used() const noexcept {
+                std::size_t size = m_offset;
+                for (std::size_t n = 0; n < m_current && n < m_blocks.size(); ++n) {
+                    size += m_blocks[n].size;
+                }
+                return size;
+            }
+
+            /// The number of bytes this arena got from the heap.
+            std::size_t capacity() const noexcept {
+                std::size_t size = 0;
+                for (const auto& blk : m_blocks) {
+                    size += blk.size;
+                }
+                return size;
+            }
+
+            /// The number of blocks this arena got from the heap.
+            std::size_t num_blocks() const noexcept {
+                return m_blocks.size();
+            }
+
+            std::size_t max_retained() const noexcept {
+                return m_max_retained;
+            }
+
+        }; // class Arena
+
+        /**
+         * Allocator using an Arena. Deallocation does nothing, the memory
+         * is only reused after the arena is reset. If no arena is set, the
+         * allocator uses the global heap like std::allocator.
+         */
+        template <typename T>
+        class ArenaAllocator {
+
+            Arena* m_arena;
+
+            template <typename U>
+            friend class ArenaAllocator;
+
+        public:
+
+            using value_type = T;
+
+            explicit ArenaAllocator(Arena* arena = nullptr) noexcept :
+                m_arena(arena) {
+            }
+
+            template <typename U>
+            ArenaAllocator(const ArenaAllocator<U>& other) noexcept : // NOLINT(google-explicit-constructor, hicpp-explicit-conversions)
+                m_arena(other.m_arena) {
+            }
+
+            T* allocate(std::size_t n) {
+                if (m_arena) {
+                    return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+                }
+                return static_cast<T*>(::operator new(n * sizeof(T)));
+            }
+
+            void deallocate(T* ptr, std::size_t /*n*/) noexcept {
+                if (!m_arena) {
+                    ::operator delete(ptr);
+                }
+            }
+
+            Arena* arena() const noexcept {
+                return m_arena;
+            }
+
+            template <typename U>
+            bool operator==(const ArenaAllocator<U>& other) const noexcept {
+                return m_arena == other.m_arena;
+            }
+
+            template <typename U>
+            bool operator!=(const ArenaAllocator<U>& other) const noexcept {
+                return m_arena != other.m_arena;
+            }
+
+        }; // class ArenaAllocator
+
+    } // namespace memory
+
+} // namespace osmium
+
+#endif // OSMIUM_MEMORY_ARENA_HPP
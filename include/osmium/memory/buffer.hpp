@@ -36,6 +36,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/memory/item.hpp>
 #include <osmium/memory/item_iterator.hpp>
 #include <osmium/osm/entity.hpp>
+#include <osmium/osm/item_type.hpp>
 #include <osmium/util/compatibility.hpp>
 
 #include <algorithm>
@@ -46,6 +47,7 @@ DEALINGS IN THE SOFTWARE.
 #include <iterator>
 #include <memory>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 
 namespace osmium {
@@ -113,6 +115,7 @@ namespace osmium {
             uint8_t m_builder_count = 0;
 #endif
             auto_grow m_auto_grow{auto_grow::no};
+            osmium::item_type m_homogeneous_type = osmium::item_type::undefined;
 
             static std::size_t calculate_capacity(std::size_t capacity) noexcept {
                 enum {
@@ -141,9 +144,36 @@ namespace osmium {
                 m_committed = 0;
 
                 old->m_next_buffer = std::move(m_next_buffer);
+                old->m_homogeneous_type = m_homogeneous_type;
                 m_next_buffer = std::move(old);
             }
 
+            // Are all items between the offsets of the given type?
+            bool all_items_of_type(osmium::item_type type, std::size_t from, std::size_t to) const noexcept {
+                const unsigned char* data = m_data + from;
+                const unsigned char* const end = m_data + to;
+                while (data != end) {
+                    const auto& item = *reinterpret_cast<const osmium::memory::Item*>(data);
+                    if (item.type() != type) {
+                        return false;
+                    }
+                    data = item.next();
+                }
+                return true;
+            }
+
+            // Where iteration over items of type T has to start: At the
+            // beginning or, if the buffer only contains items of another
+            // type, at the end.
+            template <typename T>
+            std::size_t first_offset() const noexcept {
+                if (m_homogeneous_type == osmium::item_type::undefined ||
+                    std::remove_const<T>::type::is_compatible_to(m_homogeneous_type)) {
+                    return 0;
+                }
+                return m_committed;
+            }
+
         public:
 
             /**
@@ -268,7 +298,8 @@ namespace osmium {
 #ifndef NDEBUG
                 m_builder_count(other.m_builder_count),
 #endif
-                m_auto_grow(other.m_auto_grow) {
+                m_auto_grow(other.m_auto_grow),
+                m_homogeneous_type(other.m_homogeneous_type) {
                 other.m_data = nullptr;
                 other.m_capacity = 0;
                 other.m_written = 0;
@@ -289,6 +320,7 @@ namespace osmium {
                 m_builder_count = other.m_builder_count;
 #endif
                 m_auto_grow = other.m_auto_grow;
+                m_homogeneous_type = other.m_homogeneous_type;
                 other.m_data = nullptr;
                 other.m_capacity = 0;
                 other.m_written = 0;
@@ -393,6 +425,36 @@ namespace osmium {
                 }
             }
 
+            /**
+             * The type of all items in this buffer if it was set with
+             * set_homogeneous_type(), osmium::item_type::undefined if
+             * the items can have different types.
+             *
+             * Code iterating over the buffer can use this to avoid checking
+             * the type of each item. Typed iterators (begin<T>(),
+             * select<T>() etc.) are empty if T is not compatible with the
+             * type.
+             */
+            osmium::item_type homogeneous_type() const noexcept {
+                return m_homogeneous_type;
+            }
+
+            /**
+             * Tell the buffer that all its items (and the items in all nested
+             * buffers) are of the given type. This is usually done by the code
+             * filling the buffer, for instance the PBF parser. The type is
+             * reset if items of other types are committed to the buffer later
+             * and when the buffer is cleared.
+             *
+             * @pre All committed items must be of the given type.
+             */
+            void set_homogeneous_type(osmium::item_type type) noexcept {
+                for (Buffer* buffer = this; buffer; buffer = buffer->m_next_buffer.get()) {
+                    assert(type == osmium::item_type::undefined || buffer->all_items_of_type(type, 0, buffer->m_committed));
+                    buffer->m_homogeneous_type = type;
+                }
+            }
+
             /**
              * Does this buffer have nested buffers inside. This happens
              * when a buffer is full and auto_grow is defined as internal.
@@ -436,6 +498,10 @@ namespace osmium {
                 assert(is_aligned());
 
                 const std::size_t offset = m_committed;
+                if (m_homogeneous_type != osmium::item_type::undefined &&
+                    !all_items_of_type(m_homogeneous_type, m_committed, m_written)) {
+                    m_homogeneous_type = osmium::item_type::undefined;
+                }
                 m_committed = m_written;
                 return offset;
             }
@@ -466,6 +532,7 @@ namespace osmium {
                 const std::size_t num_used_bytes = m_committed;
                 m_written = 0;
                 m_committed = 0;
+                m_homogeneous_type = osmium::item_type::undefined;
                 return num_used_bytes;
             }
 
@@ -622,12 +689,12 @@ namespace osmium {
 
             template <typename T>
             ItemIteratorRange<T> select() {
-                return ItemIteratorRange<T>{m_data, m_data + m_committed};
+                return ItemIteratorRange<T>{m_data + first_offset<T>(), m_data + m_committed};
             }
 
             template <typename T>
             ItemIteratorRange<const T> select() const {
-                return ItemIteratorRange<const T>{m_data, m_data + m_committed};
+                return ItemIteratorRange<const T>{m_data + first_offset<T>(), m_data + m_committed};
             }
 
             /**
@@ -641,7 +708,7 @@ namespace osmium {
             template <typename T>
             t_iterator<T> begin() {
                 assert(m_data && "This must be a valid buffer");
-                return t_iterator<T>(m_data, m_data + m_committed);
+                return t_iterator<T>(m_data + first_offset<T>(), m_data + m_committed);
             }
 
             /**
@@ -718,7 +785,7 @@ namespace osmium {
             template <typename T>
             t_const_iterator<T> cbegin() const {
                 assert(m_data && "This must be a valid buffer");
-                return {m_data, m_data + m_committed};
+                return {m_data + first_offset<T>(), m_data + m_committed};
             }
 
             const_iterator cbegin() const {
@@ -785,6 +852,7 @@ namespace osmium {
                 swap(m_written, other.m_written);
                 swap(m_committed, other.m_committed);
                 swap(m_auto_grow, other.m_auto_grow);
+                swap(m_homogeneous_type, other.m_homogeneous_type);
             }
 
             /**
@@ -40,6 +40,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/item_type.hpp> // IWYU pragma: export
 #include <osmium/osm/location.hpp> // IWYU pragma: export
 #include <osmium/osm/node.hpp> // IWYU pragma: export
+#include <osmium/osm/node_batch.hpp> // IWYU pragma: export
 #include <osmium/osm/node_ref.hpp> // IWYU pragma: export
 #include <osmium/osm/node_ref_list.hpp> // IWYU pragma: export
 #include <osmium/osm/object.hpp> // IWYU pragma: export
@@ -50,6 +50,7 @@ namespace osmium {
         relation                               = 0x03,
         area                                   = 0x04,
         changeset                              = 0x05,
+        node_batch                             = 0x06,
         tag_list                               = 0x11,
         way_node_list                          = 0x12,
         relation_member_list                   = 0x13,
@@ -99,6 +100,8 @@ namespace osmium {
                 return item_type::area;
             case 'c':
                 return item_type::changeset;
+            case 'B':
+                return item_type::node_batch;
             case 'T':
                 return item_type::tag_list;
             case 'N':
@@ -131,6 +134,8 @@ namespace osmium {
                 return 'a';
             case item_type::changeset:
                 return 'c';
+            case item_type::node_batch:
+                return 'B';
             case item_type::tag_list:
                 return 'T';
             case item_type::way_node_list:
@@ -163,6 +168,8 @@ namespace osmium {
                 return "area";
             case item_type::changeset:
                 return "changeset";
+            case item_type::node_batch:
+                return "node_batch";
             case item_type::tag_list:
                 return "tag_list";
             case item_type::way_node_list:
@@ -0,0 +1,242 @@
+#ifndef OSMIUM_OSM_NODE_BATCH_HPP
+#define OSMIUM_OSM_NODE_BATCH_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/memory/item.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace osmium {
+
+    namespace builder {
+        class NodeBatchBuilder;
+    } // namespace builder
+
+    /**
+     * A batch of nodes stored column-wise. The IDs and the x and y
+     * coordinates (in the internal format used by osmium::Location) of all
+     * nodes are stored in three contiguous arrays. Tags are optional. If
+     * they are available, they are stored as a sequence of \0-terminated
+     * key and value strings and there is one offset per node into this
+     * tag data.
+     *
+     * A NodeBatch is much cheaper to create and to iterate over than the
+     * same number of osmium::Node objects. It doesn't have any metadata
+     * (version, timestamp, etc.) and can't represent deleted nodes. Use it
+     * if you only need node IDs and locations (and maybe the tags).
+     *
+     * The PBF parser can create NodeBatch items instead of osmium::Node
+     * objects for dense nodes, see osmium::io::node_batch_mode.
+     */
+    class NodeBatch : public osmium::memory::Item {
+
+        friend class osmium::builder::NodeBatchBuilder;
+
+        uint32_t m_count;
+        uint32_t m_with_tags;
+
+        NodeBatch(const uint32_t count, const bool with_tags) noexcept :
+            Item(sizeof(NodeBatch), osmium::item_type::node_batch),
+            m_count(count),
+            m_with_tags(with_tags ? 1U : 0U) {
+        }
+
+        // The number of bytes needed for the ID and coordinate arrays
+        // and the tag offsets (but not the tag data itself) including
+        // padding.
+        static std::size_t columns_size(const std::size_t count, const bool with_tags) noexcept {
+            return osmium::memory::padded_length(count * (sizeof(osmium::object_id_type) + 2 * sizeof(int32_t)) +
+                                                 (with_tags ? (count + 1) * sizeof(uint32_t) : 0));
+        }
+
+        unsigned char* column(const std::size_t offset) noexcept {
+            return data() + sizeof(NodeBatch) + offset;
+        }
+
+        const unsigned char* column(const std::size_t offset) const noexcept {
+            return data() + sizeof(NodeBatch) + offset;
+        }
+
+        osmium::object_id_type* mutable_ids() noexcept {
+            return reinterpret_cast<osmium::object_id_type*>(column(0));
+        }
+
+        int32_t* mutable_x() noexcept {
+            return reinterpret_cast<int32_t*>(column(m_count * sizeof(osmium::object_id_type)));
+        }
+
+        int32_t* mutable_y() noexcept {
+            return reinterpret_cast<int32_t*>(column(m_count * (sizeof(osmium::object_id_type) + sizeof(int32_t))));
+        }
+
+        uint32_t* mutable_tag_offsets() noexcept {
+            return reinterpret_cast<uint32_t*>(column(columns_size(m_count, false)));
+        }
+
+    public:
+
+        static constexpr osmium::item_type itemtype = osmium::item_type::node_batch;
+
+        constexpr static bool is_compatible_to(osmium::item_type t) noexcept {
+            return t == itemtype;
+        }
+
+        /// The number of nodes in this batch.
+        std::size_t size() const noexcept {
+            return m_count;
+        }
+
+        /// Is this batch empty?
+        bool empty() const noexcept {
+            return m_count == 0;
+        }
+
+        /// Does this batch contain the tags of the nodes?
+        bool has_tags() const noexcept {
+            return m_with_tags != 0;
+        }
+
+        /// Pointer to array of size() node IDs.
+        const osmium::object_id_type* ids() const noexcept {
+            return reinterpret_cast<const osmium::object_id_type*>(column(0));
+        }
+
+        /// Pointer to array of size() x coordinates (see Location::x()).
+        const int32_t* x() const noexcept {
+            return reinterpret_cast<const int32_t*>(column(m_count * sizeof(osmium::object_id_type)));
+        }
+
+        /// Pointer to array of size() y coordinates (see Location::y()).
+        const int32_t* y() const noexcept {
+            return reinterpret_cast<const int32_t*>(column(m_count * (sizeof(osmium::object_id_type) + sizeof(int32_t))));
+        }
+
+        /**
+         * Get the ID of the node with index n.
+         *
+         * @pre @code n < size() @endcode
+         */
+        osmium::object_id_type id(const std::size_t n) const noexcept {
+            assert(n < size());
+            return ids()[n];
+        }
+
+        /**
+         * Get the location of the node with index n.
+         *
+         * @pre @code n < size() @endcode
+         */
+        osmium::Location location(const std::size_t n) const noexcept {
+            assert(n < size());
+            return osmium::Location{x()[n], y()[n]};
+        }
+
+        /**
+         * Pointer to array of size() + 1 offsets into the tag data. The
+         * tags of node n are in the range from tag_data() + tag_offsets()[n]
+         * to tag_data() + tag_offsets()[n + 1].
+         *
+         * @pre @code has_tags() @endcode
+         */
+        const uint32_t* tag_offsets() const noexcept {
+            assert(has_tags());
+            return reinterpret_cast<const uint32_t*>(column(columns_size(m_count, false)));
+        }
+
+        /**
+         * Pointer to the tag data: Keys and values of all tags of all
+         * nodes, each as a \0-terminated string.
+         *
+         * @pre @code has_tags() @endcode
+         */
+        const char* tag_data() const noexcept {
+            assert(has_tags());
+            return reinterpret_cast<const char*>(column(columns_size(m_count, true)));
+        }
+
+        /**
+         * Get the number of tags of the node with index n. Returns 0 if
+         * this batch doesn't contain tags.
+         *
+         * @pre @code n < size() @endcode
+         */
+        std::size_t tag_count(const std::size_t n) const noexcept {
+            assert(n < size());
+            if (!has_tags()) {
+                return 0;
+            }
+            const char* begin = tag_data() + tag_offsets()[n];
+            const char* end = tag_data() + tag_offsets()[n + 1];
+            return static_cast<std::size_t>(std::count(begin, end, '\0')) / 2;
+        }
+
+        /**
+         * Get the value of the tag with the given key of the node with
+         * index n. Returns default_value if the node has no such tag or
+         * if this batch doesn't contain tags.
+         *
+         * @pre @code n < size() && key != nullptr @endcode
+         */
+        const char* get_value_by_key(const std::size_t n, const char* key, const char* default_value = nullptr) const noexcept {
+            assert(n < size());
+            assert(key);
+            if (!has_tags()) {
+                return default_value;
+            }
+            const char* it = tag_data() + tag_offsets()[n];
+            const char* end = tag_data() + tag_offsets()[n + 1];
+            while (it != end) {
+                const char* value = it + std::strlen(it) + 1;
+                if (!std::strcmp(it, key)) {
+                    return value;
+                }
+                it = value + std::strlen(value) + 1;
+            }
+            return default_value;
+        }
+
+    }; // class NodeBatch
+
+    static_assert(sizeof(NodeBatch) % osmium::memory::align_bytes == 0, "Class osmium::NodeBatch has wrong size to be aligned properly!");
+
+} // namespace osmium
+
+#endif // OSMIUM_OSM_NODE_BATCH_HPP
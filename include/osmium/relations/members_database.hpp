@@ -46,10 +46,15 @@ DEALINGS IN THE SOFTWARE.
 #include <limits>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace osmium {
 
+    namespace thread {
+        class Pool;
+    } // namespace thread
+
     namespace relations {
 
         /**
@@ -137,6 +142,11 @@ namespace osmium {
 
             std::vector<element> m_elements{};
 
+            // Position in m_elements of the first element not smaller than
+            // the id looked up last by find_next(). Used to speed up
+            // lookups when the objects are added in order of their id.
+            std::size_t m_cursor = 0;
+
         protected:
 
             osmium::ItemStash& m_stash;
@@ -159,6 +169,52 @@ namespace osmium {
                 return make_range(std::equal_range(m_elements.cbegin(), m_elements.cend(), element{id}, compare_member_id{}));
             }
 
+            /**
+             * Like find(), but optimized for the case where the ids are
+             * looked up in ascending order (as they are when reading an
+             * ordered file). In that case this searches forward from the
+             * position of the last lookup, so lookups take amortized
+             * constant time instead of logarithmic time. For ids smaller
+             * than the last one looked up a binary search is used.
+             */
+            iterator_range<iterator> find_next(osmium::object_id_type id) {
+                const auto size = m_elements.size();
+                std::size_t first = 0;
+                std::size_t last = size;
+
+                if (m_cursor < size && m_elements[m_cursor].member_id >= id) {
+                    if (m_cursor == 0 || m_elements[m_cursor - 1].member_id < id) {
+                        // Common case: id is at cursor or not in database.
+                        first = m_cursor;
+                        last = m_cursor;
+                    } else {
+                        last = m_cursor;
+                    }
+                } else if (m_cursor < size) {
+                    // Galloping search forward from the cursor.
+                    std::size_t step = 1;
+                    first = m_cursor;
+                    while (m_cursor + step < size && m_elements[m_cursor + step].member_id < id) {
+                        first = m_cursor + step;
+                        step *= 2;
+                    }
+                    last = std::min(m_cursor + step, size);
+                } else if (size > 0 && m_elements[size - 1].member_id < id) {
+                    first = size;
+                }
+
+                const auto begin = std::lower_bound(m_elements.begin() + static_cast<std::ptrdiff_t>(first),
+                                                    m_elements.begin() + static_cast<std::ptrdiff_t>(last),
+                                                    element{id}, compare_member_id{});
+                auto end = begin;
+                while (end != m_elements.end() && end->member_id == id) {
+                    ++end;
+                }
+                m_cursor = static_cast<std::size_t>(begin - m_elements.begin());
+
+                return make_range(std::make_pair(begin, end));
+            }
+
             static typename std::iterator_traits<iterator>::difference_type count_not_removed(const iterator_range<iterator>& range) noexcept {
                 return std::count_if(range.begin(), range.end(), [](const element& elem) {
                     return !elem.is_removed();
@@ -264,6 +320,14 @@ namespace osmium {
 #endif
             }
 
+            /**
+             * Like prepare_for_lookup(), but sort using the threads in the
+             * pool. Use this for large databases.
+             *
+             * Include <osmium/relations/parallel_sort.hpp> to use this.
+             */
+            void prepare_for_lookup(osmium::thread::Pool& pool);
+
             /**
              * Remove the entry with the specified member_id and relation_id
              * from the database. If the entry doesn't exist, nothing happens.
@@ -360,11 +424,16 @@ namespace osmium {
              * @returns true if the object was actually added, false if no
              *          relation needed this object.
              * @pre You have to call prepare_for_lookup() before using this.
+             *
+             * Complexity: Amortized constant if the objects are added in
+             *             order of their ids (as they are in an ordered
+             *             file), logarithmic in the number of members
+             *             tracked otherwise.
              */
             template <typename TFunc>
             bool add(const TObject& object, TFunc&& func) {
                 assert(!m_init_phase && "Call MembersDatabase::prepare_for_lookup() before calling add().");
-                auto range = find(object.id());
+                auto range = find_next(object.id());
 
                 if (range.empty()) {
                     // No relation needs this object.
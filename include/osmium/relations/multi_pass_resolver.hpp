@@ -0,0 +1,443 @@
+#ifndef OSMIUM_RELATIONS_MULTI_PASS_RESOLVER_HPP
+#define OSMIUM_RELATIONS_MULTI_PASS_RESOLVER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/id_set.hpp>
+#include <osmium/index/multimap/sparse_file_array.hpp>
+#include <osmium/index/relations_map.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/storage/item_stash.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace relations {
+
+        /**
+         * Reads relations and all their members from a file in a fixed
+         * number of passes, also if relations are nested (like route
+         * relations in route masters in network relations).
+         *
+         * 1. All relations are read. The relations for which the filter
+         *    returns true are stored, for all relations the relation
+         *    members are added to an index. This index is used to find all
+         *    relations which are (directly or indirectly) members of the
+         *    wanted relations.
+         * 2. If there are any such member relations, the relations are
+         *    read again and those member relations are stored. (This pass
+         *    is skipped if not needed.)
+         * 3. An index from node and way ids to the ids of the relations
+         *    they are members of is built in a (temporary) file. Then the
+         *    nodes and ways are read and all members are stored. If there
+         *    are no node or way members, they are not read at all.
+         *
+         * Then the callback is called for each wanted relation. Relations
+         * are called after all of their member relations, so the results
+         * for the member relations can be used when handling the parent
+         * (relations in a cycle are called in an unspecified order).
+         *
+         * @code
+         * osmium::relations::MultiPassResolver resolver;
+         * resolver.run(file, [](const osmium::Relation& relation) {
+         *     return relation.tags().has_tag("type", "network");
+         * }, [&](const osmium::Relation& relation) {
+         *     resolver.for_each_member_recursive(relation, [](const osmium::OSMObject& object) {
+         *         ...
+         *     });
+         * });
+         * @endcode
+         *
+         * All stored objects are kept in an ItemStash. You can use stash()
+         * to configure it, for instance to spill to disk.
+         */
+        class MultiPassResolver {
+
+            using id_type = osmium::unsigned_object_id_type;
+            using handle_type = osmium::ItemStash::handle_type;
+            using handle_vector = std::vector<std::pair<id_type, handle_type>>;
+            using member_index_type = osmium::index::multimap::SparseFileArray<id_type, id_type>;
+
+            osmium::ItemStash m_stash;
+
+            handle_vector m_nodes;
+            handle_vector m_ways;
+            handle_vector m_relations;
+
+            member_index_type m_node_index;
+            member_index_type m_way_index;
+
+            // Index relation member id -> parent id and back.
+            osmium::index::RelationsMapIndexes m_relation_index{osmium::index::RelationsMapStash{}.build_indexes()};
+
+            // Ids of all relations we need (wanted and their members) in
+            // the order they are handled.
+            std::vector<id_type> m_order;
+
+            osmium::index::IdSetDense<id_type> m_wanted;
+
+            std::size_t m_passes = 0;
+
+            static void sort_handles(handle_vector& handles) {
+                std::sort(handles.begin(), handles.end(), [](const handle_vector::value_type& a, const handle_vector::value_type& b) {
+                    return a.first < b.first;
+                });
+            }
+
+            static handle_type find_handle(const handle_vector& handles, const id_type id) noexcept {
+                const auto it = std::lower_bound(handles.begin(), handles.end(), id, [](const handle_vector::value_type& a, const id_type b) {
+                    return a.first < b;
+                });
+                if (it == handles.end() || it->first != id) {
+                    return handle_type{};
+                }
+                return it->second;
+            }
+
+            static bool in_index(const member_index_type& index, const id_type id) {
+                const auto range = index.get_all(id);
+                return range.first != range.second;
+            }
+
+            // Find all relations reachable from the wanted relations and
+            // put them into m_order, members before their parents.
+            template <typename TIds>
+            void order_relations(const TIds& wanted_ids) {
+                osmium::index::IdSetDense<id_type> seen;
+                std::vector<std::pair<id_type, bool>> stack;
+
+                for (const id_type id : wanted_ids) {
+                    stack.emplace_back(id, false);
+                    while (!stack.empty()) {
+                        const auto entry = stack.back();
+                        stack.pop_back();
+                        if (entry.second) {
+                            m_order.push_back(entry.first);
+                            continue;
+                        }
+                        if (!seen.check_and_set(entry.first)) {
+                            continue;
+                        }
+                        stack.emplace_back(entry.first, true);
+                        m_relation_index.parent_to_member().for_each(entry.first, [&](const id_type member_id) {
+                            if (!seen.get(member_id)) {
+                                stack.emplace_back(member_id, false);
+                            }
+                        });
+                    }
+                }
+            }
+
+            void store_relation(const osmium::Relation& relation) {
+                m_relations.emplace_back(relation.positive_id(), m_stash.add_item(relation));
+            }
+
+            template <typename TFilter>
+            void read_relations(const osmium::io::File& file, TFilter&& filter) {
+                osmium::index::RelationsMapStash relations_map;
+                std::vector<id_type> ids;
+
+                osmium::io::Reader reader{file, osmium::osm_entity_bits::relation};
+                while (osmium::memory::Buffer buffer = reader.read()) {
+                    for (const auto& relation : buffer.select<osmium::Relation>()) {
+                        relations_map.add_members(relation);
+                        if (filter(relation)) {
+                            m_wanted.set(relation.positive_id());
+                            ids.push_back(relation.positive_id());
+                            store_relation(relation);
+                        }
+                    }
+                }
+                reader.close();
+                ++m_passes;
+
+                m_relation_index = relations_map.build_indexes();
+                order_relations(ids);
+            }
+
+            void read_member_relations(const osmium::io::File& file) {
+                osmium::index::IdSetDense<id_type> needed;
+                for (const id_type id : m_order) {
+                    if (!m_wanted.get(id)) {
+                        needed.set(id);
+                    }
+                }
+                if (needed.empty()) {
+                    return;
+                }
+
+                osmium::io::Reader reader{file, osmium::osm_entity_bits::relation};
+                while (osmium::memory::Buffer buffer = reader.read()) {
+                    for (const auto& relation : buffer.select<osmium::Relation>()) {
+                        if (needed.get(relation.positive_id())) {
+                            store_relation(relation);
+                        }
+                    }
+                }
+                reader.close();
+                ++m_passes;
+            }
+
+            void build_member_index() {
+                for (const auto& p : m_relations) {
+                    const auto& relation = m_stash.get<osmium::Relation>(p.second);
+                    for (const auto& member : relation.members()) {
+                        if (member.type() == osmium::item_type::node) {
+                            m_node_index.unsorted_set(member.positive_ref(), p.first);
+                        } else if (member.type() == osmium::item_type::way) {
+                            m_way_index.unsorted_set(member.positive_ref(), p.first);
+                        }
+                    }
+                }
+                m_node_index.sort();
+                m_way_index.sort();
+            }
+
+            void read_members(const osmium::io::File& file) {
+                osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::nothing;
+                if (m_node_index.size() > 0) {
+                    entities |= osmium::osm_entity_bits::node;
+                }
+                if (m_way_index.size() > 0) {
+                    entities |= osmium::osm_entity_bits::way;
+                }
+                if (entities == osmium::osm_entity_bits::nothing) {
+                    return;
+                }
+
+                osmium::io::Reader reader{file, entities};
+                while (osmium::memory::Buffer buffer = reader.read()) {
+                    for (const auto& item : buffer) {
+                        if (item.type() == osmium::item_type::node) {
+                            const auto& node = static_cast<const osmium::Node&>(item);
+                            if (in_index(m_node_index, node.positive_id())) {
+                                m_nodes.emplace_back(node.positive_id(), m_stash.add_item(node));
+                            }
+                        } else if (item.type() == osmium::item_type::way) {
+                            const auto& way = static_cast<const osmium::Way&>(item);
+                            if (in_index(m_way_index, way.positive_id())) {
+                                m_ways.emplace_back(way.positive_id(), m_stash.add_item(way));
+                            }
+                        }
+                    }
+                }
+                reader.close();
+                ++m_passes;
+            }
+
+            template <typename TCallback>
+            void run_callbacks(TCallback&& callback) {
+                for (const id_type id : m_order) {
+                    if (m_wanted.get(id)) {
+                        const osmium::Relation* relation = get_relation(id);
+                        if (relation) {
+                            callback(*relation);
+                        }
+                    }
+                }
+            }
+
+        public:
+
+            /**
+             * Construct a MultiPassResolver.
+             *
+             * The index from node and way ids to the relations they are
+             * members of is kept in files. If you want to keep the index
+             * you can give file descriptors of empty files opened for reading
+             * and writing. After run() these files contain the sorted list
+             * of (member id, relation id) pairs in the same format as
+             * written by dump_as_list() of the SparseFileArray multimap.
+             * By default temporary files are used.
+             *
+             * @param node_index_fd File descriptor for node member index.
+             * @param way_index_fd File descriptor for way member index.
+             */
+            explicit MultiPassResolver(int node_index_fd = -1, int way_index_fd = -1) :
+                m_node_index(node_index_fd == -1 ? member_index_type{} : member_index_type{node_index_fd}),
+                m_way_index(way_index_fd == -1 ? member_index_type{} : member_index_type{way_index_fd}) {
+            }
+
+            /**
+             * Access the stash used for all objects.
+             */
+            osmium::ItemStash& stash() noexcept {
+                return m_stash;
+            }
+
+            /**
+             * Read the file and call the callback for all relations the
+             * filter returns true for. Can only be called once.
+             *
+             * @param file The file to read. It is read two or three times.
+             * @param filter Called with each relation, should return true
+             *               if the relation is wanted.
+             * @param callback Called for each wanted relation after all
+             *                 members have been read.
+             */
+            template <typename TFilter, typename TCallback>
+            void run(const osmium::io::File& file, TFilter&& filter, TCallback&& callback) {
+                read_relations(file, std::forward<TFilter>(filter));
+                read_member_relations(file);
+                sort_handles(m_relations);
+                build_member_index();
+                read_members(file);
+                sort_handles(m_nodes);
+                sort_handles(m_ways);
+                run_callbacks(std::forward<TCallback>(callback));
+            }
+
+            /**
+             * The number of passes over the input file used by run().
+             */
+            std::size_t passes() const noexcept {
+                return m_passes;
+            }
+
+            /**
+             * Get a node that is a member of any of the wanted relations
+             * (directly or indirectly). Returns nullptr if the node wasn't
+             * found.
+             */
+            const osmium::Node* get_node(const osmium::object_id_type id) const {
+                const auto handle = find_handle(m_nodes, static_cast<id_type>(std::abs(id)));
+                return handle.valid() ? &m_stash.get<osmium::Node>(handle) : nullptr;
+            }
+
+            /**
+             * Get a way that is a member of any of the wanted relations
+             * (directly or indirectly). Returns nullptr if the way wasn't
+             * found.
+             */
+            const osmium::Way* get_way(const osmium::object_id_type id) const {
+                const auto handle = find_handle(m_ways, static_cast<id_type>(std::abs(id)));
+                return handle.valid() ? &m_stash.get<osmium::Way>(handle) : nullptr;
+            }
+
+            /**
+             * Get a wanted relation or a relation that is a member of any
+             * of the wanted relations (directly or indirectly). Returns
+             * nullptr if the relation wasn't found.
+             */
+            const osmium::Relation* get_relation(const osmium::object_id_type id) const {
+                const auto handle = find_handle(m_relations, static_cast<id_type>(std::abs(id)));
+                return handle.valid() ? &m_stash.get<osmium::Relation>(handle) : nullptr;
+            }
+
+            /**
+             * Call func with the ids of all relations the node or way with
+             * the specified id is a direct member of. Only relations read
+             * in run() are considered.
+             */
+            template <typename TFunc>
+            void for_each_parent(const osmium::item_type type, const osmium::object_id_type id, TFunc&& func) const {
+                const auto member_id = static_cast<id_type>(std::abs(id));
+                if (type == osmium::item_type::relation) {
+                    m_relation_index.member_to_parent().for_each(member_id, std::forward<TFunc>(func));
+                    return;
+                }
+                const auto& index = type == osmium::item_type::node ? m_node_index : m_way_index;
+                const auto range = index.get_all(member_id);
+                for (auto it = range.first; it != range.second; ++it) {
+                    func(it->second);
+                }
+            }
+
+            /**
+             * Call func with all nodes and ways that are members of the
+             * relation or, recursively, of any of its member relations.
+             * Every relation is visited only once, so cycles are no
+             * problem. Members not found in the file are skipped. Nodes
+             * and ways which are members of several of those relations
+             * are reported several times.
+             */
+            template <typename TFunc>
+            void for_each_member_recursive(const osmium::Relation& relation, TFunc&& func) const {
+                // Usually only a few relations are reached from one
+                // relation, a small set is much cheaper to create here
+                // than a dense one.
+                osmium::index::IdSetSmall<id_type> seen;
+                std::vector<const osmium::Relation*> stack;
+                seen.set(relation.positive_id());
+                stack.push_back(&relation);
+
+                while (!stack.empty()) {
+                    const osmium::Relation* current = stack.back();
+                    stack.pop_back();
+                    for (const auto& member : current->members()) {
+                        switch (member.type()) {
+                            case osmium::item_type::node:
+                                if (const osmium::Node* node = get_node(member.ref())) {
+                                    func(*node);
+                                }
+                                break;
+                            case osmium::item_type::way:
+                                if (const osmium::Way* way = get_way(member.ref())) {
+                                    func(*way);
+                                }
+                                break;
+                            case osmium::item_type::relation:
+                                if (!seen.get(member.positive_ref())) {
+                                    seen.set(member.positive_ref());
+                                    if (const osmium::Relation* child = get_relation(member.ref())) {
+                                        stack.push_back(child);
+                                    }
+                                }
+                                break;
+                            default:
+                                break;
+                        }
+                    }
+                }
+            }
+
+        }; // class MultiPassResolver
+
+    } // namespace relations
+
+} // namespace osmium
+
+#endif // OSMIUM_RELATIONS_MULTI_PASS_RESOLVER_HPP
@@ -0,0 +1,68 @@
+#ifndef OSMIUM_RELATIONS_PARALLEL_SORT_HPP
+#define OSMIUM_RELATIONS_PARALLEL_SORT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Include this file to use the prepare_for_lookup() functions taking an
+ * osmium::thread::Pool of the members databases and relations managers.
+ *
+ * @attention If you include this file, you'll need to enable
+ *            multithreading.
+ */
+
+#include <osmium/relations/members_database.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/thread/sort.hpp>
+
+#include <cassert>
+
+namespace osmium {
+
+    namespace relations {
+
+        inline void MembersDatabaseCommon::prepare_for_lookup(osmium::thread::Pool& pool) {
+            assert(m_init_phase && "Can not call MembersDatabase::prepare_for_lookup() twice.");
+            osmium::thread::parallel_sort(pool, m_elements.begin(), m_elements.end());
+#ifndef NDEBUG
+            m_init_phase = false;
+#endif
+        }
+
+    } // namespace relations
+
+} // namespace osmium
+
+#endif // OSMIUM_RELATIONS_PARALLEL_SORT_HPP
@@ -59,6 +59,10 @@ DEALINGS IN THE SOFTWARE.
 
 namespace osmium {
 
+    namespace thread {
+        class Pool;
+    } // namespace thread
+
     namespace relations {
 
         /**
@@ -97,6 +101,15 @@ namespace osmium {
                 m_member_relations_db(m_stash, m_relations_db) {
             }
 
+            /**
+             * Access the ItemStash used to store relations and members.
+             * Use this to configure the stash, for instance with
+             * ItemStash::spill_to_file().
+             */
+            osmium::ItemStash& stash() noexcept {
+                return m_stash;
+            }
+
             /// Access the internal RelationsDatabase.
             osmium::relations::RelationsDatabase& relations_database() noexcept {
                 return m_relations_db;
@@ -242,6 +255,18 @@ namespace osmium {
                 m_member_relations_db.prepare_for_lookup();
             }
 
+            /**
+             * Like prepare_for_lookup(), but sort the members databases
+             * using the threads in the pool.
+             *
+             * Include <osmium/relations/parallel_sort.hpp> to use this.
+             */
+            void prepare_for_lookup(osmium::thread::Pool& pool) {
+                m_member_nodes_db.prepare_for_lookup(pool);
+                m_member_ways_db.prepare_for_lookup(pool);
+                m_member_relations_db.prepare_for_lookup(pool);
+            }
+
             /**
              * Return the memory used by different components of the manager.
              */
@@ -442,6 +467,17 @@ namespace osmium {
             void after_relation(const osmium::Relation& /*relation*/) const noexcept {
             }
 
+            /**
+             * This method is called from flush_output() before the output
+             * buffer is flushed. Use it to add any data still pending in
+             * the derived class to the output buffer.
+             *
+             * Overwrite this method in a derived class if you are interested
+             * in this.
+             */
+            void before_flush() const noexcept {
+            }
+
             TManager& derived() noexcept {
                 return *static_cast<TManager*>(this);
             }
@@ -560,6 +596,15 @@ namespace osmium {
                 relations_database().for_each_relation(std::forward<TFunc>(func));
             }
 
+            /**
+             * Flush the output buffer. Calls before_flush() in the derived
+             * class first so it can add any pending data.
+             */
+            void flush_output() {
+                derived().before_flush();
+                RelationsManagerBase::flush_output();
+            }
+
         }; // class RelationsManager
 
     } // namespace relations
@@ -33,12 +33,20 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/io/detail/read_write.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/memory/item.hpp>
+#include <osmium/util/memory_mapping.hpp>
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <limits>
+#include <memory>
 #include <ostream>
 #include <vector>
 
@@ -51,8 +59,21 @@ namespace osmium {
 
     /**
      * Class for storing OSM data in memory. Any osmium::memory::Item can be
-     * added to the stash and it will be copied into its internal Buffer. To
-     * access the item again, an opaque handle is used.
+     * added to the stash and it will be copied into its internal storage.
+     * To access the item again, an opaque handle is used.
+     *
+     * The items are stored in segments of a fixed size. New items are
+     * always added to the current segment. When most items in an older
+     * segment have been removed, the remaining items are moved to the
+     * current segment and the old segment is freed. This is done for one
+     * segment at a time while adding new items, so there are no long pauses
+     * for garbage collection. If all items in a segment are removed, the
+     * segment is freed immediately.
+     *
+     * The stash can be configured with spill_to_file() to put new segments
+     * into a memory mapped file once it gets too large. From then on the
+     * operating system decides which parts of the data ("hot" pages) are
+     * kept in memory and which are written out to disk.
      */
     class ItemStash {
 
@@ -113,102 +134,440 @@ namespace osmium {
 
         }; // class handle_type
 
+        enum : std::size_t {
+            default_segment_size = 1024UL * 1024UL
+        };
+
     private:
 
-        enum {
-            initial_buffer_size = 1024UL * 1024UL
+        // Segment sizes are rounded up to a multiple of this, so that
+        // segments in a file can be memory mapped.
+        enum : std::size_t {
+            segment_alignment = 64UL * 1024UL
+        };
+
+        // Each item in a segment is preceded by the (index of) its handle.
+        using record_header_type = uint64_t;
+
+        enum : std::size_t {
+            record_header_size = sizeof(record_header_type)
         };
 
-        enum {
-            removed_item_offset = std::numeric_limits<std::size_t>::max()
+        // The index entries contain the segment number in the upper bits
+        // and the offset in the segment in the lower bits.
+        enum : unsigned {
+            offset_bits = 40U
         };
 
-        osmium::memory::Buffer m_buffer;
-        std::vector<std::size_t> m_index;
+        static constexpr const uint64_t removed_item_entry = std::numeric_limits<uint64_t>::max();
+
+        // A segment is evacuated when less than 1/evacuate_ratio of the
+        // space used in it is taken up by live items.
+        enum : std::size_t {
+            evacuate_ratio = 4
+        };
+
+        class segment {
+
+            osmium::util::MemoryMapping m_mapping;
+            std::size_t m_file_offset;
+            std::size_t m_used = 0;
+            std::size_t m_live_bytes = 0;
+            std::size_t m_removed_items = 0;
+
+        public:
+
+            bool queued = false;
+
+            // Create a segment in memory (if fd == -1) or in a file.
+            segment(std::size_t size, int fd, std::size_t file_offset) :
+                m_mapping(size,
+                          fd == -1 ? osmium::util::MemoryMapping::mapping_mode::write_private
+                                   : osmium::util::MemoryMapping::mapping_mode::write_shared,
+                          fd,
+                          static_cast<off_t>(file_offset)),
+                m_file_offset(file_offset) {
+            }
+
+            bool in_file() const noexcept {
+                return m_mapping.fd() != -1;
+            }
+
+            std::size_t file_offset() const noexcept {
+                return m_file_offset;
+            }
+
+            unsigned char* data() const noexcept {
+                return m_mapping.get_addr<unsigned char>();
+            }
+
+            std::size_t capacity() const noexcept {
+                return m_mapping.size();
+            }
+
+            std::size_t used() const noexcept {
+                return m_used;
+            }
+
+            std::size_t live_bytes() const noexcept {
+                return m_live_bytes;
+            }
+
+            std::size_t removed_items() const noexcept {
+                return m_removed_items;
+            }
+
+            bool sparse() const noexcept {
+                return m_live_bytes * evacuate_ratio < m_used;
+            }
+
+            bool fits(std::size_t size) const noexcept {
+                return capacity() - m_used >= size;
+            }
+
+            std::size_t append(record_header_type index, const osmium::memory::Item& item) {
+                const std::size_t offset = m_used;
+                std::memcpy(data() + offset, &index, record_header_size);
+                std::memcpy(data() + offset + record_header_size, item.data(), item.byte_size());
+                const std::size_t size = record_header_size + item.padded_size();
+                m_used += size;
+                m_live_bytes += size;
+                return offset;
+            }
+
+            void mark_removed(std::size_t size) noexcept {
+                assert(m_live_bytes >= size);
+                m_live_bytes -= size;
+                ++m_removed_items;
+            }
+
+            void clear() noexcept {
+                m_used = 0;
+                m_live_bytes = 0;
+                m_removed_items = 0;
+                queued = false;
+            }
+
+            // Remove all removed items by moving the other items to the
+            // front. Calls func(index, new_offset) for all live items.
+            template <typename TFunc>
+            void compact(TFunc&& func) {
+                std::size_t write = 0;
+                std::size_t read = 0;
+                while (read < m_used) {
+                    const auto& item = *reinterpret_cast<const osmium::memory::Item*>(data() + read + record_header_size);
+                    const std::size_t size = record_header_size + item.padded_size();
+                    if (!item.removed()) {
+                        if (read != write) {
+                            std::memmove(data() + write, data() + read, size);
+                        }
+                        record_header_type index = 0;
+                        std::memcpy(&index, data() + write, record_header_size);
+                        func(index, write);
+                        write += size;
+                    }
+                    read += size;
+                }
+                m_used = write;
+                m_live_bytes = write;
+                m_removed_items = 0;
+            }
+
+            // Call func(index, item) for all live items.
+            template <typename TFunc>
+            void for_each_live_item(TFunc&& func) const {
+                std::size_t read = 0;
+                while (read < m_used) {
+                    const auto& item = *reinterpret_cast<const osmium::memory::Item*>(data() + read + record_header_size);
+                    if (!item.removed()) {
+                        record_header_type index = 0;
+                        std::memcpy(&index, data() + read, record_header_size);
+                        func(index, item);
+                    }
+                    read += record_header_size + item.padded_size();
+                }
+            }
+
+        }; // class segment
+
+        // File used for segments after the stash spilled to disk.
+        class spill_file {
+
+            int m_fd;
+            std::size_t m_size = 0;
+            std::vector<std::pair<std::size_t, std::size_t>> m_free{};
+
+        public:
+
+            explicit spill_file(int fd) noexcept :
+                m_fd(fd) {
+            }
+
+            spill_file(const spill_file&) = delete;
+            spill_file& operator=(const spill_file&) = delete;
+
+            spill_file(spill_file&&) = delete;
+            spill_file& operator=(spill_file&&) = delete;
+
+            ~spill_file() noexcept {
+                try {
+                    osmium::io::detail::reliable_close(m_fd);
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            int fd() const noexcept {
+                return m_fd;
+            }
+
+            std::size_t size() const noexcept {
+                return m_size;
+            }
+
+            // Get offset in file for a segment of the given size.
+            std::size_t allocate(std::size_t size) {
+                const auto it = std::find_if(m_free.begin(), m_free.end(), [size](const std::pair<std::size_t, std::size_t>& range) {
+                    return range.second == size;
+                });
+                if (it != m_free.end()) {
+                    const std::size_t offset = it->first;
+                    m_free.erase(it);
+                    return offset;
+                }
+                const std::size_t offset = m_size;
+                m_size += size;
+                return offset;
+            }
+
+            void release(std::size_t offset, std::size_t size) {
+                m_free.emplace_back(offset, size);
+            }
+
+        }; // class spill_file
+
+        std::vector<std::unique_ptr<segment>> m_segments;
+        std::vector<std::size_t> m_free_slots;
+        std::deque<std::size_t> m_evacuation_queue;
+        std::unique_ptr<segment> m_spare_segment;
+        std::vector<uint64_t> m_index;
+        std::size_t m_current = std::numeric_limits<std::size_t>::max();
+        std::size_t m_segment_size;
+        std::size_t m_memory_in_segments = 0;
         std::size_t m_count_items = 0;
         std::size_t m_count_removed = 0;
+        std::size_t m_spill_limit = 0;
+        std::unique_ptr<spill_file> m_spill_file;
 #ifdef OSMIUM_ITEM_STORAGE_GC_DEBUG
         int64_t m_gc_time = 0;
 #endif
 
-        class cleanup_helper {
+        static uint64_t make_entry(std::size_t segment_num, std::size_t offset) noexcept {
+            return (static_cast<uint64_t>(segment_num) << offset_bits) | static_cast<uint64_t>(offset);
+        }
 
-            std::vector<std::size_t>& m_index;
-            std::size_t m_pos = 0;
+        static std::size_t entry_segment(uint64_t entry) noexcept {
+            return static_cast<std::size_t>(entry >> offset_bits);
+        }
 
-        public:
+        static std::size_t entry_offset(uint64_t entry) noexcept {
+            return static_cast<std::size_t>(entry & ((1ULL << offset_bits) - 1));
+        }
 
-            explicit cleanup_helper(std::vector<std::size_t>& index) :
-                m_index(index) {
-            }
+        uint64_t get_entry(handle_type handle) const noexcept {
+            assert(handle.valid() && "handle must be valid");
+            assert(handle.value <= m_index.size());
+            const auto entry = m_index[handle.value - 1];
+            assert(entry != removed_item_entry);
+            assert(entry_segment(entry) < m_segments.size() && m_segments[entry_segment(entry)]);
+            assert(entry_offset(entry) < m_segments[entry_segment(entry)]->used());
+            return entry;
+        }
 
-            void moving_in_buffer(std::size_t old_offset, std::size_t new_offset) {
-                while (m_index[m_pos] != old_offset) {
-                    ++m_pos;
-                    assert(m_pos < m_index.size());
+        bool has_current() const noexcept {
+            return m_current < m_segments.size();
+        }
+
+        std::unique_ptr<segment> create_segment(std::size_t size) {
+            if (m_spill_limit > 0 && m_memory_in_segments + size > m_spill_limit) {
+                if (!m_spill_file) {
+                    m_spill_file.reset(new spill_file{osmium::detail::create_tmp_file()});
+                }
+                const std::size_t offset = m_spill_file->allocate(size);
+                try {
+                    return std::unique_ptr<segment>{new segment{size, m_spill_file->fd(), offset}};
+                } catch (...) {
+                    m_spill_file->release(offset, size);
+                    throw;
                 }
-                m_index[m_pos] = new_offset;
-                ++m_pos;
             }
 
-        }; // cleanup_helper
+            if (m_spare_segment && m_spare_segment->capacity() == size) {
+                m_memory_in_segments += size;
+                return std::move(m_spare_segment);
+            }
 
-        std::size_t& get_item_offset_ref(handle_type handle) noexcept {
-            assert(handle.valid() && "handle must be valid");
-            assert(handle.value <= m_index.size());
-            auto& offset = m_index[handle.value - 1];
-            assert(offset != removed_item_offset);
-            assert(offset < m_buffer.committed());
-            return offset;
+            std::unique_ptr<segment> seg{new segment{size, -1, 0}};
+            m_memory_in_segments += size;
+            return seg;
         }
 
-        std::size_t get_item_offset(handle_type handle) const noexcept {
-            assert(handle.valid() && "handle must be valid");
-            assert(handle.value <= m_index.size());
-            const auto& offset = m_index[handle.value - 1];
-            assert(offset != removed_item_offset);
-            assert(offset < m_buffer.committed());
-            return offset;
+        void release_segment(std::size_t segment_num) {
+            std::unique_ptr<segment> seg{std::move(m_segments[segment_num])};
+            assert(seg);
+            m_count_removed -= seg->removed_items();
+            m_free_slots.push_back(segment_num);
+
+            if (seg->in_file()) {
+                m_spill_file->release(seg->file_offset(), seg->capacity());
+                return;
+            }
+
+            m_memory_in_segments -= seg->capacity();
+            if (seg->capacity() == m_segment_size && !m_spare_segment) {
+                seg->clear();
+                m_spare_segment = std::move(seg);
+            }
+        }
+
+        void queue_for_evacuation(std::size_t segment_num) {
+            segment& seg = *m_segments[segment_num];
+            if (!seg.queued && seg.sparse()) {
+                seg.queued = true;
+                m_evacuation_queue.push_back(segment_num);
+            }
+        }
+
+        // Open a new current segment with space for at least size bytes.
+        void new_current_segment(std::size_t size) {
+            const std::size_t segment_size = std::max(m_segment_size, (size + segment_alignment - 1) / segment_alignment * segment_alignment);
+            std::unique_ptr<segment> seg = create_segment(segment_size);
+
+            std::size_t segment_num = 0;
+            if (m_free_slots.empty()) {
+                segment_num = m_segments.size();
+                m_segments.push_back(std::move(seg));
+            } else {
+                segment_num = m_free_slots.back();
+                m_free_slots.pop_back();
+                m_segments[segment_num] = std::move(seg);
+            }
+
+            const std::size_t old_current = m_current;
+            m_current = segment_num;
+
+            if (old_current < m_segments.size() && m_segments[old_current]) {
+                if (m_segments[old_current]->live_bytes() == 0) {
+                    release_segment(old_current);
+                } else {
+                    queue_for_evacuation(old_current);
+                }
+            }
         }
 
-        // This function decides whether it makes sense to garbage collect the
-        // database. The values here are the result of some experimentation
-        // with real data. We need to balance the memory use with the time
-        // spent on garbage collecting. We don't need to garbage collect if
-        // there is enough space in the buffer anyway (*4). On the other hand,
-        // if there aren't enough removed objects we would just call the
-        // garbage collection again and again, then it is better to let the
-        // buffer grow (*3). The checks (*1) and (*2) make sure there is
-        // minimum and maximum for the number of removed objects.
-        bool should_gc() const noexcept {
-            if (m_count_removed < 10UL * 1000UL) { // *1
-                return false;
-            }
-            if (m_count_removed > 5UL * 1000UL * 1000UL) { // *2
-                return true;
-            }
-            if (m_count_removed * 5UL < m_count_items) { // *3
-                return false;
-            }
-            return m_buffer.capacity() - m_buffer.committed() < 10UL * 1024UL; // *4
+        // Add item to the current segment and return index entry.
+        uint64_t append(record_header_type index, const osmium::memory::Item& item) {
+            const std::size_t size = record_header_size + item.padded_size();
+            if (!has_current() || !m_segments[m_current]->fits(size)) {
+                new_current_segment(size);
+            }
+            return make_entry(m_current, m_segments[m_current]->append(index, item));
+        }
+
+        // Move all live items from a segment to the current segment and
+        // release the segment.
+        void evacuate(std::size_t segment_num) {
+            assert(segment_num != m_current);
+            const segment& seg = *m_segments[segment_num];
+            seg.for_each_live_item([&](record_header_type index, const osmium::memory::Item& item) {
+                m_index[index] = append(index, item);
+            });
+            release_segment(segment_num);
+        }
+
+        // Evacuate the next segment in the queue, if any.
+        void evacuate_next() {
+            while (!m_evacuation_queue.empty()) {
+                const std::size_t segment_num = m_evacuation_queue.front();
+                m_evacuation_queue.pop_front();
+                if (segment_num < m_segments.size() && m_segments[segment_num] &&
+                    m_segments[segment_num]->queued && segment_num != m_current) {
+                    m_segments[segment_num]->queued = false;
+                    evacuate(segment_num);
+                    return;
+                }
+            }
         }
 
     public:
 
-        ItemStash() :
-            m_buffer(initial_buffer_size, osmium::memory::Buffer::auto_grow::yes) {
+        /**
+         * Construct an ItemStash.
+         *
+         * @param segment_size Size of the segments the items are stored
+         *                     in. Items larger than this get a segment of
+         *                     their own.
+         */
+        explicit ItemStash(std::size_t segment_size = default_segment_size) :
+            m_segment_size((std::max(segment_size, static_cast<std::size_t>(segment_alignment)) + segment_alignment - 1) / segment_alignment * segment_alignment) {
+        }
+
+        /**
+         * Configure this stash to put its data into a memory mapped file
+         * when it needs more than memory_limit bytes. From then on all new
+         * segments are created in the file. Segments already in memory
+         * stay there until they are freed, which happens when the items in
+         * them are removed or moved to the current segment. Pages of the
+         * file are kept in memory by the operating system as long as there
+         * is enough memory, otherwise the pages not used recently are
+         * written to the file and dropped from memory.
+         *
+         * Handles stay valid when the data is moved into the file, but,
+         * as with all calls to add_item(), references to items are
+         * invalidated.
+         *
+         * @param memory_limit Use the file when the stash needs more than
+         *                     this many bytes. Use 0 to disable spilling
+         *                     (the default).
+         * @param fd File descriptor of a file opened for reading and
+         *           writing. Any content of the file will be overwritten.
+         *           The stash duplicates this descriptor in this call, so
+         *           you can close yours afterwards. If this is -1 (the
+         *           default), an anonymous temporary file is created when
+         *           it is needed. If the stash has already spilled, it
+         *           keeps using its current file.
+         * @throws std::system_error If the descriptor can't be duplicated.
+         */
+        void spill_to_file(std::size_t memory_limit, int fd = -1) {
+            m_spill_limit = memory_limit;
+            if (spilled()) {
+                return;
+            }
+            m_spill_file.reset(fd == -1 ? nullptr : new spill_file{osmium::io::detail::reliable_dup(fd)});
+        }
+
+        /**
+         * Has this stash put any data into a file?
+         *
+         * Complexity: Constant.
+         */
+        bool spilled() const noexcept {
+            return m_spill_file && m_spill_file->size() > 0;
         }
 
         /**
          * Return an estimate of the number of bytes currently used by this
-         * ItemStash instance.
+         * ItemStash instance. Segments in a memory mapped file are not
+         * included.
          *
          * Complexity: Constant.
          */
         std::size_t used_memory() const noexcept {
             return sizeof(ItemStash) +
-                   m_buffer.capacity() +
-                   m_index.capacity() * sizeof(std::size_t);
+                   m_memory_in_segments +
+                   (m_spare_segment ? m_spare_segment->capacity() : 0) +
+                   m_segments.capacity() * sizeof(std::unique_ptr<segment>) +
+                   m_index.capacity() * sizeof(uint64_t);
         }
 
         /**
@@ -231,13 +590,30 @@ namespace osmium {
             return m_count_removed;
         }
 
+        /**
+         * The number of segments currently used.
+         *
+         * Complexity: Constant.
+         */
+        std::size_t num_segments() const noexcept {
+            return m_segments.size() - m_free_slots.size();
+        }
+
         /**
          * Clear all items from the stash. This will not necessarily release
          * any memory. All handles are invalidated.
          */
         void clear() {
-            m_buffer.clear();
+            for (std::size_t n = 0; n < m_segments.size(); ++n) {
+                if (m_segments[n]) {
+                    release_segment(n);
+                }
+            }
+            m_segments.clear();
+            m_free_slots.clear();
+            m_evacuation_queue.clear();
             m_index.clear();
+            m_current = std::numeric_limits<std::size_t>::max();
             m_count_items = 0;
             m_count_removed = 0;
         }
@@ -246,17 +622,17 @@ namespace osmium {
          * Add an item to the stash. This will invalidate any pointers and
          * references into the stash, but handles are still valid.
          *
+         * This might move the items of (at most) one segment, in which
+         * most items were removed, to the current segment.
+         *
          * Complexity: Amortized constant.
          */
         handle_type add_item(const osmium::memory::Item& item) {
-            if (should_gc()) {
-                garbage_collect();
-            }
+            evacuate_next();
             ++m_count_items;
-            const auto offset = m_buffer.committed();
-            m_buffer.add_item(item);
-            m_buffer.commit();
-            m_index.push_back(offset);
+            const auto index = m_index.size();
+            m_index.push_back(0);
+            m_index.back() = append(index, item);
             return handle_type{m_index.size()};
         }
 
@@ -272,7 +648,8 @@ namespace osmium {
          *      item.
          */
         osmium::memory::Item& get_item(handle_type handle) const {
-            return m_buffer.get<osmium::memory::Item>(get_item_offset(handle));
+            const auto entry = get_entry(handle);
+            return *reinterpret_cast<osmium::memory::Item*>(m_segments[entry_segment(entry)]->data() + entry_offset(entry) + record_header_size);
         }
 
         /**
@@ -297,22 +674,45 @@ namespace osmium {
 
         /**
          * Garbage collect the memory used by the ItemStash. This will free up
-         * memory for adding new items. No memory is actually returned to the
-         * OS. Usually you do not need to call this, because add_item() will
-         * call it for you as necessary.
+         * memory for adding new items. Segments with removed items are
+         * compacted and the memory of freed segments is returned to the OS.
+         * Usually you do not need to call this, because add_item() will
+         * move items out of mostly empty segments as necessary.
          *
          * Complexity: Linear in size() + count_removed().
          */
         void garbage_collect() {
 #ifdef OSMIUM_ITEM_STORAGE_GC_DEBUG
-            std::cerr << "GC items=" << m_count_items << " removed=" << m_count_removed << " buffer.committed=" << m_buffer.committed() << " buffer.capacity=" << m_buffer.capacity() << "\n";
+            std::cerr << "GC items=" << m_count_items << " removed=" << m_count_removed << " segments=" << num_segments() << "\n";
             using clock = std::chrono::high_resolution_clock;
             std::chrono::time_point<clock> start = clock::now();
 #endif
 
-            m_count_removed = 0;
-            cleanup_helper helper{m_index};
-            m_buffer.purge_removed(&helper);
+            m_evacuation_queue.clear();
+            for (std::size_t n = 0; n < m_segments.size(); ++n) {
+                if (!m_segments[n] || n == m_current || m_segments[n]->removed_items() == 0) {
+                    continue;
+                }
+                m_segments[n]->queued = false;
+                if (m_segments[n]->live_bytes() == 0) {
+                    release_segment(n);
+                } else if (m_segments[n]->sparse()) {
+                    evacuate(n);
+                } else {
+                    m_count_removed -= m_segments[n]->removed_items();
+                    m_segments[n]->compact([this, n](record_header_type index, std::size_t offset) {
+                        m_index[index] = make_entry(n, offset);
+                    });
+                }
+            }
+
+            if (has_current() && m_segments[m_current]->removed_items() > 0) {
+                const std::size_t current = m_current;
+                m_count_removed -= m_segments[current]->removed_items();
+                m_segments[current]->compact([this, current](record_header_type index, std::size_t offset) {
+                    m_index[index] = make_entry(current, offset);
+                });
+            }
 
 #ifdef OSMIUM_ITEM_STORAGE_GC_DEBUG
             std::chrono::time_point<clock> stop = clock::now();
@@ -325,8 +725,8 @@ namespace osmium {
 
         /**
          * Remove an item from the stash. The item will be marked as removed
-         * and the handle will be invalidated. No memory will actually be
-         * freed.
+         * and the handle will be invalidated. If this was the last item in
+         * a segment (other than the current one) the segment is freed.
          *
          * Complexity: Constant.
          *
@@ -336,13 +736,23 @@ namespace osmium {
          *      item.
          */
         void remove_item(handle_type handle) {
-            auto& offset = get_item_offset_ref(handle);
-            auto& item = m_buffer.get<osmium::memory::Item>(offset);
+            const auto entry = get_entry(handle);
+            const std::size_t segment_num = entry_segment(entry);
+            auto& item = get_item(handle);
             assert(!item.removed() && "can not call remove_item() on already removed item");
             item.set_removed(true);
-            offset = removed_item_offset;
+            m_segments[segment_num]->mark_removed(record_header_size + item.padded_size());
+            m_index[handle.value - 1] = removed_item_entry;
             --m_count_items;
             ++m_count_removed;
+
+            if (segment_num != m_current) {
+                if (m_segments[segment_num]->live_bytes() == 0) {
+                    release_segment(segment_num);
+                } else {
+                    queue_for_evacuation(segment_num);
+                }
+            }
         }
 
     }; // class ItemStash
@@ -124,8 +124,21 @@ namespace osmium {
          *          matched, the default result.
          */
         TResult operator()(const osmium::Tag& tag) const noexcept {
+            return operator()(tag.key(), tag.value());
+        }
+
+        /**
+         * Matching function. Check the specified key and value against the
+         * rules.
+         *
+         * @param key The tag key.
+         * @param value The tag value.
+         * @returns The result of the matching rule, or, if none of the rules
+         *          matched, the default result.
+         */
+        TResult operator()(const char* key, const char* value) const noexcept {
             for (const auto& rule : m_rules) {
-                if (rule.second(tag)) {
+                if (rule.second(key, value)) {
                     return rule.first;
                 }
             }
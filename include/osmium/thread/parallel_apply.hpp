@@ -0,0 +1,270 @@
+#ifndef OSMIUM_THREAD_PARALLEL_APPLY_HPP
+#define OSMIUM_THREAD_PARALLEL_APPLY_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/visitor.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace thread {
+
+        namespace detail {
+
+            // Wait for all futures before rethrowing any exception, because
+            // the tasks still reference data owned by the caller.
+            template <typename T>
+            void wait_for_all(std::deque<std::future<T>>& futures) {
+                for (auto& future : futures) {
+                    if (future.valid()) {
+                        future.wait();
+                    }
+                }
+            }
+
+            /**
+             * Read all buffers from the source and run a task created by
+             * make_task for each buffer on the pool. At most twice as many
+             * tasks as there are threads in the pool are in flight at any
+             * time. The results of the tasks are given to the deliver
+             * function in the order the buffers were read.
+             */
+            template <typename TSource, typename TMakeTask, typename TDeliver>
+            void run_buffer_tasks(TSource& source, Pool& pool, TMakeTask&& make_task, TDeliver&& deliver) {
+                using future_type = decltype(pool.submit(make_task(osmium::memory::Buffer{})));
+
+                const auto max_pending = static_cast<std::size_t>(pool.num_threads()) * 2;
+                std::deque<future_type> futures;
+
+                try {
+                    while (osmium::memory::Buffer buffer = source.read()) {
+                        if (futures.size() >= max_pending) {
+                            deliver(futures.front());
+                            futures.pop_front();
+                        }
+                        futures.push_back(pool.submit(make_task(std::move(buffer))));
+                    }
+                    while (!futures.empty()) {
+                        deliver(futures.front());
+                        futures.pop_front();
+                    }
+                } catch (...) {
+                    wait_for_all(futures);
+                    throw;
+                }
+            }
+
+            template <typename THandler>
+            class handler_stash {
+
+                std::vector<THandler> m_handlers;
+                std::vector<THandler*> m_free;
+                std::mutex m_mutex;
+
+            public:
+
+                handler_stash(const THandler& prototype, std::size_t count) :
+                    m_handlers(count, prototype) {
+                    for (auto& handler : m_handlers) {
+                        m_free.push_back(&handler);
+                    }
+                }
+
+                THandler* acquire() {
+                    const std::lock_guard<std::mutex> lock{m_mutex};
+                    assert(!m_free.empty());
+                    THandler* handler = m_free.back();
+                    m_free.pop_back();
+                    return handler;
+                }
+
+                void release(THandler* handler) {
+                    const std::lock_guard<std::mutex> lock{m_mutex};
+                    m_free.push_back(handler);
+                }
+
+                std::vector<THandler>& handlers() noexcept {
+                    return m_handlers;
+                }
+
+            }; // class handler_stash
+
+            template <typename THandler>
+            class apply_task {
+
+                handler_stash<THandler>* m_stash;
+                osmium::memory::Buffer m_buffer;
+
+            public:
+
+                apply_task(handler_stash<THandler>* stash, osmium::memory::Buffer&& buffer) :
+                    m_stash(stash),
+                    m_buffer(std::move(buffer)) {
+                }
+
+                void operator()() {
+                    THandler* handler = m_stash->acquire();
+                    try {
+                        // Not using osmium::apply() here, because that
+                        // would call flush() on the handler.
+                        for (auto it = m_buffer.cbegin(); it != m_buffer.cend(); ++it) {
+                            osmium::apply_item(*it, *handler);
+                        }
+                    } catch (...) {
+                        m_stash->release(handler);
+                        throw;
+                    }
+                    m_stash->release(handler);
+                }
+
+            }; // class apply_task
+
+            template <typename TFunc>
+            class transform_task {
+
+                const TFunc* m_func;
+                osmium::memory::Buffer m_buffer;
+
+            public:
+
+                transform_task(const TFunc* func, osmium::memory::Buffer&& buffer) :
+                    m_func(func),
+                    m_buffer(std::move(buffer)) {
+                }
+
+                osmium::memory::Buffer operator()() {
+                    return (*m_func)(m_buffer);
+                }
+
+            }; // class transform_task
+
+        } // namespace detail
+
+        /**
+         * Read all buffers from the source (usually an osmium::io::Reader)
+         * and apply copies of the handler to them using the threads of the
+         * pool. There is one copy of the handler for each thread in the
+         * pool, each copy is only used by one thread at a time, so the
+         * handler doesn't need to be thread-safe. But the buffers are
+         * handed to the copies in no particular order, so this is only
+         * useful for handlers which don't depend on the order of the
+         * objects, for instance handlers counting or filtering objects.
+         *
+         * After all buffers are handled, the flush() function is called on
+         * all copies of the handler and then the reduce function with each
+         * of the copies to combine their results. Both happen in the
+         * calling thread.
+         *
+         * @code
+         * CountHandler handler;
+         * osmium::thread::parallel_apply(reader, pool, handler, [&](CountHandler& h) {
+         *     handler.count += h.count;
+         * });
+         * @endcode
+         *
+         * Do not call this from a task running in the same pool.
+         *
+         * @param source Source of buffers with a read() function.
+         * @param pool The thread pool to use.
+         * @param prototype Handler which is copied for each thread.
+         * @param reduce Function called with each handler at the end.
+         */
+        template <typename TSource, typename THandler, typename TReduce>
+        void parallel_apply(TSource& source, Pool& pool, const THandler& prototype, TReduce&& reduce) {
+            detail::handler_stash<THandler> stash{prototype, static_cast<std::size_t>(pool.num_threads())};
+
+            detail::run_buffer_tasks(source, pool, [&stash](osmium::memory::Buffer&& buffer) {
+                return detail::apply_task<THandler>{&stash, std::move(buffer)};
+            }, [](std::future<void>& future) {
+                future.get();
+            });
+
+            for (auto& handler : stash.handlers()) {
+                handler.flush();
+                reduce(handler);
+            }
+        }
+
+        /**
+         * Read all buffers from the source (usually an osmium::io::Reader)
+         * and call the function with each buffer using the threads of the
+         * pool. The function must return a new buffer, these are given to
+         * the output function in the same order as the input buffers were
+         * read. The output function is called in the calling thread.
+         *
+         * The function is called from several threads at the same time,
+         * so it must be thread-safe. Usually it creates a handler writing
+         * into the output buffer and applies it to the input buffer.
+         *
+         * @code
+         * osmium::thread::parallel_transform(reader, pool, [](const osmium::memory::Buffer& input) {
+         *     osmium::memory::Buffer output{input.committed()};
+         *     ...
+         *     return output;
+         * }, [&](osmium::memory::Buffer&& buffer) {
+         *     writer(std::move(buffer));
+         * });
+         * @endcode
+         *
+         * Do not call this from a task running in the same pool.
+         *
+         * @param source Source of buffers with a read() function.
+         * @param pool The thread pool to use.
+         * @param func Function transforming an input buffer into an output
+         *             buffer.
+         * @param output Function called with all output buffers in order.
+         */
+        template <typename TSource, typename TFunc, typename TOutput>
+        void parallel_transform(TSource& source, Pool& pool, const TFunc& func, TOutput&& output) {
+            detail::run_buffer_tasks(source, pool, [&func](osmium::memory::Buffer&& buffer) {
+                return detail::transform_task<TFunc>{&func, std::move(buffer)};
+            }, [&output](std::future<osmium::memory::Buffer>& future) {
+                output(future.get());
+            });
+        }
+
+    } // namespace thread
+
+} // namespace osmium
+
+#endif // OSMIUM_THREAD_PARALLEL_APPLY_HPP
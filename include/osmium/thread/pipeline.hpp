@@ -0,0 +1,433 @@
+#ifndef OSMIUM_THREAD_PIPELINE_HPP
+#define OSMIUM_THREAD_PIPELINE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/thread/queue.hpp>
+#include <osmium/thread/util.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace thread {
+
+        /**
+         * Statistics for one stage of a Pipeline.
+         */
+        struct pipeline_stage_stats {
+
+            /// Name of the stage ("source" and "sink" for the ends).
+            std::string name;
+
+            /// Number of buffers handled by this stage.
+            std::size_t buffers = 0;
+
+            /// Number of bytes in the buffers handled by this stage.
+            std::size_t bytes = 0;
+
+            /// Time spent in the stage function (summed over all threads).
+            std::chrono::nanoseconds busy{0};
+
+            /**
+             * Time the stage was blocked because the queue to the next
+             * stage was full (ie. the next stage is slower).
+             */
+            std::chrono::nanoseconds blocked{0};
+
+        }; // struct pipeline_stage_stats
+
+        /**
+         * A pipeline of stages working on buffers of OSM data. Data is read
+         * from a source (usually an osmium::io::Reader), handed through
+         * all the stages and then to a sink (usually an
+         * osmium::io::Writer). Each stage is a function turning an input
+         * buffer into an output buffer, for instance a filter.
+         *
+         * Stages with a parallelism larger than 1 run their function on
+         * the threads of a pool, so the function must be thread-safe.
+         * Other stages run in a thread of their own and see the buffers
+         * one after the other. In both cases the order of the buffers is
+         * kept.
+         *
+         * Between stages there are bounded queues. If a stage is slower
+         * than the stages before it, those will block when the queue is
+         * full, so the amount of data in memory is limited.
+         *
+         * @code
+         * osmium::thread::Pipeline pipeline{pool};
+         * pipeline.add_stage("filter", 8, [](osmium::memory::Buffer&& buffer) {
+         *     osmium::memory::Buffer output{buffer.committed()};
+         *     ...
+         *     return output;
+         * });
+         * pipeline.run([&]() {
+         *     return reader.read();
+         * }, [&](osmium::memory::Buffer&& buffer) {
+         *     writer(std::move(buffer));
+         * });
+         * @endcode
+         */
+        class Pipeline {
+
+        public:
+
+            using stage_function = std::function<osmium::memory::Buffer(osmium::memory::Buffer&&)>;
+
+        private:
+
+            struct stage_counters {
+
+                std::string name;
+                std::atomic<std::size_t> buffers{0};
+                std::atomic<std::size_t> bytes{0};
+                std::atomic<int64_t> busy{0};
+                std::atomic<int64_t> blocked{0};
+
+                explicit stage_counters(std::string stage_name) :
+                    name(std::move(stage_name)) {
+                }
+
+                void add_busy(std::chrono::steady_clock::time_point start) noexcept {
+                    busy += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                }
+
+                void add_blocked(std::chrono::steady_clock::time_point start) noexcept {
+                    blocked += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                }
+
+                pipeline_stage_stats stats() const {
+                    pipeline_stage_stats s;
+                    s.name = name;
+                    s.buffers = buffers;
+                    s.bytes = bytes;
+                    s.busy = std::chrono::nanoseconds{busy.load()};
+                    s.blocked = std::chrono::nanoseconds{blocked.load()};
+                    return s;
+                }
+
+            }; // struct stage_counters
+
+            struct stage {
+
+                stage_counters counters;
+                stage_function func;
+                int parallelism;
+
+                stage(std::string name, int stage_parallelism, stage_function&& function) :
+                    counters(std::move(name)),
+                    func(std::move(function)),
+                    parallelism(stage_parallelism) {
+                }
+
+                osmium::memory::Buffer operator()(osmium::memory::Buffer&& buffer) {
+                    const auto start = std::chrono::steady_clock::now();
+                    ++counters.buffers;
+                    counters.bytes += buffer.committed();
+                    osmium::memory::Buffer result{func(std::move(buffer))};
+                    counters.add_busy(start);
+                    return result;
+                }
+
+            }; // struct stage
+
+            // Items in the queues between stages. The last item only marks
+            // the end of the data.
+            struct item {
+                std::future<osmium::memory::Buffer> future;
+                bool last = false;
+            };
+
+            using queue_type = Queue<item>;
+
+            class stage_task {
+
+                stage* m_stage;
+                osmium::memory::Buffer m_buffer;
+
+            public:
+
+                stage_task(stage* s, osmium::memory::Buffer&& buffer) :
+                    m_stage(s),
+                    m_buffer(std::move(buffer)) {
+                }
+
+                osmium::memory::Buffer operator()() {
+                    return (*m_stage)(std::move(m_buffer));
+                }
+
+            }; // class stage_task
+
+            Pool& m_pool;
+            std::vector<std::unique_ptr<stage>> m_stages;
+            stage_counters m_source_counters{"source"};
+            stage_counters m_sink_counters{"sink"};
+            std::size_t m_queue_size;
+            std::atomic<bool> m_cancelled{false};
+
+            static item make_item(osmium::memory::Buffer&& buffer) {
+                std::promise<osmium::memory::Buffer> promise;
+                item i;
+                i.future = promise.get_future();
+                promise.set_value(std::move(buffer));
+                return i;
+            }
+
+            static item make_item(std::exception_ptr exception) {
+                std::promise<osmium::memory::Buffer> promise;
+                item i;
+                i.future = promise.get_future();
+                promise.set_exception(std::move(exception));
+                return i;
+            }
+
+            static item last_item() {
+                item i;
+                i.last = true;
+                return i;
+            }
+
+            static void push(queue_type& queue, item&& i, stage_counters& counters) {
+                const auto start = std::chrono::steady_clock::now();
+                queue.push(std::move(i));
+                counters.add_blocked(start);
+            }
+
+            template <typename TSource>
+            void run_source(TSource& source, queue_type& out) {
+                osmium::thread::set_thread_name("_osmium_pipe");
+                try {
+                    while (!m_cancelled) {
+                        const auto start = std::chrono::steady_clock::now();
+                        osmium::memory::Buffer buffer{source()};
+                        m_source_counters.add_busy(start);
+                        if (!buffer) {
+                            break;
+                        }
+                        ++m_source_counters.buffers;
+                        m_source_counters.bytes += buffer.committed();
+                        push(out, make_item(std::move(buffer)), m_source_counters);
+                    }
+                } catch (...) {
+                    out.push(make_item(std::current_exception()));
+                }
+                out.push(last_item());
+            }
+
+            // Each stage has a thread taking the buffers from the input
+            // queue and either handling them itself or handing them to the
+            // pool. After an error or if the pipeline is cancelled, the
+            // input is still read until the end, so all tasks in the pool
+            // are finished when the last item reaches the sink.
+            void run_stage(stage& s, queue_type& in, queue_type& out) {
+                osmium::thread::set_thread_name("_osmium_pipe");
+                bool failed = false;
+                while (true) {
+                    item i;
+                    in.wait_and_pop(i);
+                    if (i.last) {
+                        out.push(last_item());
+                        return;
+                    }
+                    if (failed || m_cancelled) {
+                        i.future.wait();
+                        continue;
+                    }
+
+                    osmium::memory::Buffer buffer;
+                    try {
+                        buffer = i.future.get();
+                    } catch (...) {
+                        out.push(make_item(std::current_exception()));
+                        failed = true;
+                        continue;
+                    }
+
+                    if (!buffer) {
+                        continue;
+                    }
+
+                    if (s.parallelism > 1) {
+                        item result;
+                        result.future = m_pool.submit(stage_task{&s, std::move(buffer)});
+                        push(out, std::move(result), s.counters);
+                        continue;
+                    }
+
+                    try {
+                        push(out, make_item(s(std::move(buffer))), s.counters);
+                    } catch (...) {
+                        out.push(make_item(std::current_exception()));
+                        failed = true;
+                    }
+                }
+            }
+
+            std::size_t queue_size(const stage& s) const noexcept {
+                return s.parallelism > 1 ? static_cast<std::size_t>(s.parallelism) * 2 : m_queue_size;
+            }
+
+        public:
+
+            /**
+             * Construct a pipeline.
+             *
+             * @param pool The thread pool used for parallel stages.
+             * @param queue_size The size of the queues after the source and
+             *                   after stages running in a single thread.
+             *                   Queues after parallel stages can hold twice
+             *                   as many buffers as the parallelism of the
+             *                   stage.
+             */
+            explicit Pipeline(Pool& pool, std::size_t queue_size = 4) :
+                m_pool(pool),
+                m_queue_size(queue_size) {
+            }
+
+            /**
+             * Add a stage to the end of the pipeline.
+             *
+             * @param name Name of the stage used in stats().
+             * @param parallelism The maximum number of buffers handled at the
+             *                    same time. If this is larger than 1, the
+             *                    function is called from threads in the
+             *                    pool and must be thread-safe. Using more
+             *                    than the number of threads in the pool
+             *                    doesn't make sense.
+             * @param func Function taking an input buffer and returning the
+             *             output buffer (which can be the same buffer).
+             *             Invalid output buffers are dropped.
+             */
+            void add_stage(std::string name, int parallelism, stage_function func) {
+                m_stages.emplace_back(new stage{std::move(name), parallelism, std::move(func)});
+            }
+
+            /**
+             * Run the pipeline until the source doesn't return any more
+             * data. The sink is called in the calling thread in the order
+             * the buffers were read from the source.
+             *
+             * If the source, any stage, or the sink throws an exception, the
+             * pipeline is stopped and the exception rethrown from here.
+             *
+             * Do not call this from a task running in the pool.
+             *
+             * @param source Function returning buffers. If it returns an
+             *               invalid buffer, there is no more data.
+             * @param sink Function called with each output buffer.
+             */
+            template <typename TSource, typename TSink>
+            void run(TSource&& source, TSink&& sink) {
+                m_cancelled = false;
+
+                std::vector<std::unique_ptr<queue_type>> queues;
+                queues.emplace_back(new queue_type{m_queue_size, "pipeline_source"});
+                for (const auto& s : m_stages) {
+                    queues.emplace_back(new queue_type{queue_size(*s), "pipeline_" + s->counters.name});
+                }
+
+                std::exception_ptr exception;
+                {
+                    std::vector<thread_handler> threads;
+                    threads.emplace_back(&Pipeline::run_source<typename std::remove_reference<TSource>::type>, this, std::ref(source), std::ref(*queues.front()));
+                    for (std::size_t n = 0; n < m_stages.size(); ++n) {
+                        threads.emplace_back(&Pipeline::run_stage, this, std::ref(*m_stages[n]), std::ref(*queues[n]), std::ref(*queues[n + 1]));
+                    }
+
+                    queue_type& in = *queues.back();
+                    while (true) {
+                        item i;
+                        in.wait_and_pop(i);
+                        if (i.last) {
+                            break;
+                        }
+                        if (exception) {
+                            i.future.wait();
+                            continue;
+                        }
+                        try {
+                            osmium::memory::Buffer buffer{i.future.get()};
+                            if (buffer) {
+                                const auto start = std::chrono::steady_clock::now();
+                                ++m_sink_counters.buffers;
+                                m_sink_counters.bytes += buffer.committed();
+                                sink(std::move(buffer));
+                                m_sink_counters.add_busy(start);
+                            }
+                        } catch (...) {
+                            exception = std::current_exception();
+                            m_cancelled = true;
+                        }
+                    }
+                } // wait for threads
+
+                if (exception) {
+                    std::rethrow_exception(exception);
+                }
+            }
+
+            /**
+             * Get statistics for all stages, the first entry is for the
+             * source, the last for the sink. Can be called while the
+             * pipeline is running.
+             */
+            std::vector<pipeline_stage_stats> stats() const {
+                std::vector<pipeline_stage_stats> result;
+                result.push_back(m_source_counters.stats());
+                for (const auto& s : m_stages) {
+                    result.push_back(s->counters.stats());
+                }
+                result.push_back(m_sink_counters.stats());
+                return result;
+            }
+
+        }; // class Pipeline
+
+    } // namespace thread
+
+} // namespace osmium
+
+#endif // OSMIUM_THREAD_PIPELINE_HPP
@@ -34,12 +34,18 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/thread/function_wrapper.hpp>
-#include <osmium/thread/queue.hpp>
+#include <osmium/thread/stats.hpp>
 #include <osmium/thread/util.hpp>
 #include <osmium/util/config.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
+#include <deque>
 #include <future>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <type_traits>
 #include <utility>
@@ -57,7 +63,7 @@ namespace osmium {
             // Maximum number of allowed pool threads (just to keep the user
             // from setting something silly).
             enum {
-                max_pool_threads = 32
+                max_pool_threads = 256
             };
 
             inline int get_pool_size(int num_threads, int user_setting, unsigned hardware_concurrency) {
@@ -85,7 +91,13 @@ namespace osmium {
         } // namespace detail
 
         /**
-         *  Thread pool.
+         * Thread pool.
+         *
+         * Each worker thread has its own queue of tasks. Tasks submitted
+         * from outside the pool are distributed round-robin over those
+         * queues, tasks submitted from a worker thread go into the queue
+         * of that worker. A worker with an empty queue takes (steals) tasks
+         * from the other queues, and sleeps if there is no work at all.
          */
         class Pool {
 
@@ -119,24 +131,131 @@ namespace osmium {
 
             }; // class thread_joiner
 
-            osmium::thread::Queue<function_wrapper> m_work_queue;
+            struct worker_queue {
+                std::mutex mutex;
+                std::deque<function_wrapper> tasks;
+            };
+
+            std::vector<std::unique_ptr<worker_queue>> m_queues;
+
+            // Maximum number of queued tasks before submit() blocks.
+            const std::size_t m_max_queue_size;
+
+            // Number of tasks queued and not yet taken by a worker. This is
+            // incremented before a task is added to a queue, so it can be
+            // larger than the actual number of queued tasks for a moment.
+            std::atomic<std::size_t> m_pending{0};
+
+            std::atomic<std::size_t> m_next_queue{0};
+
+            // Used for sleeping workers and blocked submitters.
+            std::mutex m_mutex;
+            std::condition_variable m_work_available;
+            std::condition_variable m_space_available;
+            std::atomic<int> m_sleeping_workers{0};
+            std::atomic<int> m_waiting_submitters{0};
+            std::atomic<bool> m_shutdown{false};
+
+            detail::atomic_duration_histogram m_task_times;
+
+            // These must be last, so the threads are joined before the
+            // queues are destructed.
             std::vector<std::thread> m_threads{};
             thread_joiner m_joiner;
             int m_num_threads;
 
-            void worker_thread() {
+            // The pool and queue index of the worker running in this thread.
+            static std::pair<const Pool*, std::size_t>& current_worker() noexcept {
+                static thread_local std::pair<const Pool*, std::size_t> worker{nullptr, 0};
+                return worker;
+            }
+
+            bool try_pop(std::size_t index, function_wrapper& task) {
+                worker_queue& queue = *m_queues[index];
+                const std::lock_guard<std::mutex> lock{queue.mutex};
+                if (queue.tasks.empty()) {
+                    return false;
+                }
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                return true;
+            }
+
+            bool get_task(std::size_t index, function_wrapper& task) {
+                const auto num_queues = m_queues.size();
+                for (std::size_t n = 0; n < num_queues; ++n) {
+                    if (try_pop((index + n) % num_queues, task)) {
+                        --m_pending;
+                        if (m_waiting_submitters > 0) {
+                            const std::lock_guard<std::mutex> lock{m_mutex};
+                            m_space_available.notify_one();
+                        }
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            void worker_thread(std::size_t index) {
                 osmium::thread::set_thread_name("_osmium_worker");
+                current_worker() = std::make_pair(this, index);
                 while (true) {
                     function_wrapper task;
-                    m_work_queue.wait_and_pop(task);
-                    if (task && task()) {
-                        // The called tasks returns true only when the
-                        // worker thread should shut down.
+                    if (get_task(index, task)) {
+                        const auto start = std::chrono::steady_clock::now();
+                        task();
+                        m_task_times.add(std::chrono::steady_clock::now() - start);
+                        continue;
+                    }
+
+                    if (m_pending > 0) {
+                        // Some task is about to be added to a queue.
+                        std::this_thread::yield();
+                        continue;
+                    }
+
+                    std::unique_lock<std::mutex> lock{m_mutex};
+                    ++m_sleeping_workers;
+                    m_work_available.wait(lock, [this] {
+                        return m_pending > 0 || m_shutdown;
+                    });
+                    --m_sleeping_workers;
+                    if (m_pending == 0 && m_shutdown) {
                         return;
                     }
                 }
             }
 
+            void add_task(function_wrapper&& task) {
+                std::size_t index = 0;
+                const auto& worker = current_worker();
+                if (worker.first == this) {
+                    index = worker.second;
+                } else {
+                    if (m_max_queue_size > 0 && m_pending >= m_max_queue_size) {
+                        std::unique_lock<std::mutex> lock{m_mutex};
+                        ++m_waiting_submitters;
+                        m_space_available.wait(lock, [this] {
+                            return m_pending < m_max_queue_size || m_shutdown;
+                        });
+                        --m_waiting_submitters;
+                    }
+                    index = m_next_queue++ % m_queues.size();
+                }
+
+                ++m_pending;
+                {
+                    worker_queue& queue = *m_queues[index];
+                    const std::lock_guard<std::mutex> lock{queue.mutex};
+                    queue.tasks.push_back(std::move(task));
+                }
+
+                if (m_sleeping_workers > 0) {
+                    const std::lock_guard<std::mutex> lock{m_mutex};
+                    m_work_available.notify_one();
+                }
+            }
+
         public:
 
             enum {
@@ -160,16 +279,22 @@ namespace osmium {
              * In all cases the minimum number of threads in the pool is 1.
              *
              * If max_queue_size is 0, the queue size is read from
-             * the environment variable OSMIUM_MAX_WORK_QUEUE_SIZE.
+             * the environment variable OSMIUM_MAX_WORK_QUEUE_SIZE. If
+             * that many tasks are queued, submit() will block (unless it
+             * is called from a task running in the pool).
              */
             explicit Pool(int num_threads = default_num_threads, std::size_t max_queue_size = default_queue_size) :
-                m_work_queue(max_queue_size > 0 ? max_queue_size : detail::get_work_queue_size(), "work"),
+                m_max_queue_size(max_queue_size > 0 ? max_queue_size : detail::get_work_queue_size()),
                 m_joiner(m_threads),
                 m_num_threads(detail::get_pool_size(num_threads, osmium::config::get_pool_threads(), std::thread::hardware_concurrency())) {
 
+                for (int i = 0; i < m_num_threads; ++i) {
+                    m_queues.emplace_back(new worker_queue{});
+                }
+
                 try {
                     for (int i = 0; i < m_num_threads; ++i) {
-                        m_threads.emplace_back(&Pool::worker_thread, this);
+                        m_threads.emplace_back(&Pool::worker_thread, this, static_cast<std::size_t>(i));
                     }
                 } catch (...) {
                     shutdown_all_workers();
@@ -188,11 +313,15 @@ namespace osmium {
                 return pool;
             }
 
+            /**
+             * Tell all worker threads to shut down after all tasks already
+             * queued are done.
+             */
             void shutdown_all_workers() {
-                for (int i = 0; i < m_num_threads; ++i) {
-                    // The special function wrapper makes a worker shut down.
-                    m_work_queue.push(function_wrapper{0});
-                }
+                const std::lock_guard<std::mutex> lock{m_mutex};
+                m_shutdown = true;
+                m_work_available.notify_all();
+                m_space_available.notify_all();
             }
 
             Pool(const Pool&) = delete;
@@ -209,12 +338,28 @@ namespace osmium {
                 return m_num_threads;
             }
 
+            /// The number of tasks queued and not yet started.
             std::size_t queue_size() const {
-                return m_work_queue.size();
+                return m_pending;
             }
 
             bool queue_empty() const {
-                return m_work_queue.empty();
+                return m_pending == 0;
+            }
+
+            /**
+             * Get statistics about this pool, including a histogram of the
+             * execution times of all tasks run so far. This can be called
+             * from any thread at any time.
+             */
+            pool_stats stats() const {
+                pool_stats result;
+                result.num_threads = m_num_threads;
+                result.queue_size = queue_size();
+                result.task_times = m_task_times.histogram();
+                result.tasks = result.task_times.total();
+                result.busy = m_task_times.sum();
+                return result;
             }
 
 #if defined(__cpp_lib_is_invocable) && __cpp_lib_is_invocable >= 201703
@@ -232,7 +377,7 @@ namespace osmium {
             std::future<submit_func_result_type<TFunction>> submit(TFunction&& func) {
                 std::packaged_task<submit_func_result_type<TFunction>()> task{std::forward<TFunction>(func)};
                 std::future<submit_func_result_type<TFunction>> future_result{task.get_future()};
-                m_work_queue.push(std::move(task));
+                add_task(function_wrapper{std::move(task)});
 
                 return future_result;
             }
@@ -33,13 +33,18 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/thread/stats.hpp>
+
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <string>
+#include <thread>
 #include <utility> // IWYU pragma: keep
 
 #ifdef OSMIUM_DEBUG_QUEUE_SIZE
@@ -51,51 +56,383 @@ namespace osmium {
     namespace thread {
 
         /**
-         *  A thread-safe queue.
+         * The implementation used for a Queue.
+         */
+        enum class queue_kind {
+
+            /// std::queue protected by a mutex. Allows any number of
+            /// producers and consumers. This is the default.
+            locked = 0,
+
+            /// Lock-free ring buffer for exactly one producer thread and
+            /// one consumer thread.
+            spsc = 1,
+
+            /// Lock-free ring buffer for any number of producers and
+            /// consumers.
+            mpmc = 2
+
+        }; // enum class queue_kind
+
+        namespace detail {
+
+            // Used to keep data written by producers and consumers on
+            // different cache lines.
+            enum : std::size_t {
+                cache_line_size = 64
+            };
+
+            /**
+             * Bounded lock-free ring buffer for a single producer and a
+             * single consumer thread.
+             */
+            template <typename T>
+            class spsc_ring_buffer {
+
+                const std::size_t m_capacity;
+                std::unique_ptr<T[]> m_slots;
+
+                // Number of elements popped so far. Only written by the
+                // consumer.
+                std::atomic<std::size_t> m_head{0};
+
+                char m_padding[cache_line_size - sizeof(std::atomic<std::size_t>)];
+
+                // Number of elements pushed so far. Only written by the
+                // producer.
+                std::atomic<std::size_t> m_tail{0};
+
+            public:
+
+                explicit spsc_ring_buffer(std::size_t capacity) :
+                    m_capacity(capacity),
+                    m_slots(new T[capacity]) {
+                }
+
+                /// Move value into the buffer unless it is full.
+                bool try_push(T& value) {
+                    const auto tail = m_tail.load(std::memory_order_relaxed);
+                    if (tail - m_head.load(std::memory_order_acquire) >= m_capacity) {
+                        return false;
+                    }
+                    m_slots[tail % m_capacity] = std::move(value);
+                    m_tail.store(tail + 1, std::memory_order_release);
+                    return true;
+                }
+
+                bool try_pop(T& value) {
+                    const auto head = m_head.load(std::memory_order_relaxed);
+                    if (head == m_tail.load(std::memory_order_acquire)) {
+                        return false;
+                    }
+                    value = std::move(m_slots[head % m_capacity]);
+                    m_head.store(head + 1, std::memory_order_release);
+                    return true;
+                }
+
+                std::size_t size() const noexcept {
+                    const auto head = m_head.load(std::memory_order_acquire);
+                    return m_tail.load(std::memory_order_acquire) - head;
+                }
+
+                bool empty() const noexcept {
+                    return size() == 0;
+                }
+
+                bool full() const noexcept {
+                    return size() >= m_capacity;
+                }
+
+            }; // class spsc_ring_buffer
+
+            /**
+             * Bounded lock-free ring buffer for any number of producer and
+             * consumer threads. Every slot has a sequence number telling
+             * producers and consumers whether it is their turn to use it
+             * (see Dmitry Vyukov's "Bounded MPMC queue").
+             */
+            template <typename T>
+            class mpmc_ring_buffer {
+
+                struct slot {
+                    std::atomic<std::size_t> sequence;
+                    T value;
+                };
+
+                const std::size_t m_capacity;
+                std::unique_ptr<slot[]> m_slots;
+
+                std::atomic<std::size_t> m_head{0};
+
+                char m_padding[cache_line_size - sizeof(std::atomic<std::size_t>)];
+
+                std::atomic<std::size_t> m_tail{0};
+
+            public:
+
+                explicit mpmc_ring_buffer(std::size_t capacity) :
+                    m_capacity(capacity),
+                    m_slots(new slot[capacity]) {
+                    for (std::size_t i = 0; i < capacity; ++i) {
+                        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+                    }
+                }
+
+                /// Move value into the buffer unless it is full.
+                bool try_push(T& value) {
+                    auto tail = m_tail.load(std::memory_order_relaxed);
+                    while (true) {
+                        slot& s = m_slots[tail % m_capacity];
+                        const auto sequence = s.sequence.load(std::memory_order_acquire);
+                        if (sequence == tail) {
+                            if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+                                s.value = std::move(value);
+                                s.sequence.store(tail + 1, std::memory_order_release);
+                                return true;
+                            }
+                        } else if (sequence < tail) {
+                            return false; // full
+                        } else {
+                            tail = m_tail.load(std::memory_order_relaxed);
+                        }
+                    }
+                }
+
+                bool try_pop(T& value) {
+                    auto head = m_head.load(std::memory_order_relaxed);
+                    while (true) {
+                        slot& s = m_slots[head % m_capacity];
+                        const auto sequence = s.sequence.load(std::memory_order_acquire);
+                        if (sequence == head + 1) {
+                            if (m_head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed)) {
+                                value = std::move(s.value);
+                                s.sequence.store(head + m_capacity, std::memory_order_release);
+                                return true;
+                            }
+                        } else if (sequence < head + 1) {
+                            return false; // empty
+                        } else {
+                            head = m_head.load(std::memory_order_relaxed);
+                        }
+                    }
+                }
+
+                std::size_t size() const noexcept {
+                    const auto head = m_head.load(std::memory_order_acquire);
+                    const auto tail = m_tail.load(std::memory_order_acquire);
+                    return tail > head ? tail - head : 0;
+                }
+
+                bool empty() const noexcept {
+                    const auto head = m_head.load(std::memory_order_acquire);
+                    return m_slots[head % m_capacity].sequence.load(std::memory_order_acquire) < head + 1;
+                }
+
+                bool full() const noexcept {
+                    const auto tail = m_tail.load(std::memory_order_acquire);
+                    return m_slots[tail % m_capacity].sequence.load(std::memory_order_acquire) < tail;
+                }
+
+            }; // class mpmc_ring_buffer
+
+        } // namespace detail
+
+        /**
+         * A thread-safe queue.
+         *
+         * By default this is a std::queue protected by a mutex. If the
+         * queue has a maximum size, it can instead use a lock-free ring
+         * buffer (see queue_kind). Threads blocked on such a queue first
+         * spin for a while and then sleep until they are woken up by the
+         * other side. How long they spin adapts to how often spinning
+         * was successful before.
          */
         template <typename T>
         class Queue {
 
+            // Limits for the number of times a thread retries before
+            // it goes to sleep.
+            enum : unsigned {
+                min_spin = 16,
+                max_spin = 4096,
+                num_yield = 16
+            };
+
             /// Maximum size of this queue. If the queue is full pushing to
             /// the queue will block.
             const std::size_t m_max_size;
 
-            /// Name of this queue (for debugging only).
+            /// Name of this queue (for debugging and statistics).
             const std::string m_name;
 
+            const queue_kind m_kind;
+
             mutable std::mutex m_mutex;
 
             std::queue<T> m_queue;
 
+            std::unique_ptr<detail::spsc_ring_buffer<T>> m_spsc;
+            std::unique_ptr<detail::mpmc_ring_buffer<T>> m_mpmc;
+
             /// Used to signal consumers when data is available in the queue.
             std::condition_variable m_data_available;
 
             /// Used to signal producers when queue is not full.
             std::condition_variable m_space_available;
 
+            /// Number of threads sleeping on m_data_available (ring
+            /// buffers only).
+            std::atomic<int> m_waiting_consumers{0};
+
+            /// Number of threads sleeping on m_space_available (ring
+            /// buffers only).
+            std::atomic<int> m_waiting_producers{0};
+
+            /// Current number of retries before a thread goes to sleep.
+            std::atomic<unsigned> m_spin_limit{min_spin};
+
             std::atomic<bool> m_in_use{true};
 
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
             /// The largest size the queue has been so far.
-            std::size_t m_largest_size;
+            std::atomic<std::size_t> m_largest_size{0};
 
-            /// The number of times push() was called on the queue.
-            std::atomic<int> m_push_counter;
+            /// The number of elements pushed to the queue.
+            std::atomic<uint64_t> m_push_counter{0};
 
             /// The number of times the queue was full and a thread pushing
             /// to the queue was blocked.
-            std::atomic<int> m_full_counter;
+            std::atomic<uint64_t> m_full_counter{0};
+
+            /// Nanoseconds threads were blocked in push().
+            std::atomic<int64_t> m_push_blocked{0};
+
+            /// The number of elements popped from the queue.
+            std::atomic<uint64_t> m_pop_counter{0};
+
+            /// The number of times the queue was empty when a thread tried
+            /// to pop from it.
+            std::atomic<uint64_t> m_empty_counter{0};
+
+            /// Nanoseconds threads were blocked in wait_and_pop().
+            std::atomic<int64_t> m_pop_blocked{0};
+
+            static void increment(std::atomic<uint64_t>& counter) noexcept {
+                counter.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            void pushed(std::size_t size) noexcept {
+                increment(m_push_counter);
+                if (m_largest_size.load(std::memory_order_relaxed) < size) {
+                    m_largest_size.store(size, std::memory_order_relaxed);
+                }
+            }
+
+            bool ring_try_push(T& value) {
+                return m_spsc ? m_spsc->try_push(value) : m_mpmc->try_push(value);
+            }
+
+            bool ring_try_pop(T& value) {
+                return m_spsc ? m_spsc->try_pop(value) : m_mpmc->try_pop(value);
+            }
+
+            std::size_t ring_size() const noexcept {
+                return m_spsc ? m_spsc->size() : m_mpmc->size();
+            }
+
+            bool ring_full() const noexcept {
+                return m_spsc ? m_spsc->full() : m_mpmc->full();
+            }
+
+            bool ring_empty() const noexcept {
+                return m_spsc ? m_spsc->empty() : m_mpmc->empty();
+            }
+
+            // The read-modify-write operations on the waiting counters
+            // order the change of the ring buffer before the check for
+            // sleeping threads, so no wakeup can get lost.
+            void wake_up(std::atomic<int>& waiting, std::condition_variable& condition) {
+                if (waiting.fetch_add(0) > 0) {
+                    const std::lock_guard<std::mutex> lock{m_mutex};
+                    condition.notify_one();
+                }
+            }
+
+            template <typename TPredicate>
+            void sleep_until(std::atomic<int>& waiting, std::condition_variable& condition, TPredicate&& predicate) {
+                std::unique_lock<std::mutex> lock{m_mutex};
+                ++waiting;
+                condition.wait(lock, std::forward<TPredicate>(predicate));
+                --waiting;
+            }
 
             /**
-             * The number of times wait_and_pop(with_timeout)() was called
-             * on the queue.
+             * Call func until it returns true, first spinning, then
+             * yielding and finally sleeping on the condition until the
+             * predicate is true. Returns false if the queue was shut down.
              */
-            std::atomic<int> m_pop_counter;
+            template <typename TFunction, typename TPredicate>
+            bool spin_then_sleep(TFunction&& func, std::atomic<int>& waiting, std::condition_variable& condition, TPredicate&& predicate) {
+                unsigned count = 0;
+                const unsigned spin_limit = m_spin_limit.load(std::memory_order_relaxed);
+                while (m_in_use) {
+                    if (func()) {
+                        if (count > 0 && count <= spin_limit && spin_limit < max_spin) {
+                            m_spin_limit.store(spin_limit * 2, std::memory_order_relaxed);
+                        }
+                        return true;
+                    }
+                    ++count;
+                    if (count <= spin_limit) {
+                        continue;
+                    }
+                    if (count <= spin_limit + num_yield) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    if (spin_limit > min_spin) {
+                        m_spin_limit.store(spin_limit / 2, std::memory_order_relaxed);
+                    }
+                    sleep_until(waiting, condition, predicate);
+                    count = 0;
+                }
+                return false;
+            }
 
-            /// The number of times the queue was full and a thread pushing
-            /// to the queue was blocked.
-            std::atomic<int> m_empty_counter;
-#endif
+            void ring_push(T& value) {
+                if (ring_try_push(value)) {
+                    pushed(ring_size());
+                    wake_up(m_waiting_consumers, m_data_available);
+                    return;
+                }
+                increment(m_full_counter);
+                const auto start = std::chrono::steady_clock::now();
+                const bool done = spin_then_sleep([this, &value] { return ring_try_push(value); },
+                                                  m_waiting_producers, m_space_available,
+                                                  [this] { return !m_in_use || !ring_full(); });
+                m_push_blocked.fetch_add(detail::nanoseconds_since(start), std::memory_order_relaxed);
+                if (done) {
+                    pushed(ring_size());
+                    wake_up(m_waiting_consumers, m_data_available);
+                }
+            }
+
+            void ring_wait_and_pop(T& value) {
+                if (ring_try_pop(value)) {
+                    increment(m_pop_counter);
+                    wake_up(m_waiting_producers, m_space_available);
+                    return;
+                }
+                increment(m_empty_counter);
+                const auto start = std::chrono::steady_clock::now();
+                const bool done = spin_then_sleep([this, &value] { return ring_try_pop(value); },
+                                                  m_waiting_consumers, m_data_available,
+                                                  [this] { return !m_in_use || !ring_empty(); });
+                m_pop_blocked.fetch_add(detail::nanoseconds_since(start), std::memory_order_relaxed);
+                if (done) {
+                    increment(m_pop_counter);
+                    wake_up(m_waiting_producers, m_space_available);
+                }
+            }
 
         public:
 
@@ -104,21 +441,22 @@ namespace osmium {
              *
              * @param max_size Maximum number of elements in the queue. Set to
              *                 0 for an unlimited size.
-             * @param name Optional name for this queue. (Used for debugging.)
+             * @param name Optional name for this queue. (Used for debugging
+             *             and in stats().)
+             * @param kind Implementation used for this queue. The ring
+             *             buffers need a maximum size, without one the
+             *             locked implementation is always used. If you use
+             *             queue_kind::spsc, only one thread may push and
+             *             only one thread may pop (shutdown() can be
+             *             called from any thread).
              */
-            explicit Queue(std::size_t max_size = 0, std::string name = "") :
+            explicit Queue(std::size_t max_size = 0, std::string name = "", queue_kind kind = queue_kind::locked) :
                 m_max_size(max_size),
                 m_name(std::move(name)),
-                m_queue()
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
-                ,
-                m_largest_size(0),
-                m_push_counter(0),
-                m_full_counter(0),
-                m_pop_counter(0),
-                m_empty_counter(0)
-#endif
-            {
+                m_kind(max_size == 0 ? queue_kind::locked : kind),
+                m_queue(),
+                m_spsc(m_kind == queue_kind::spsc ? new detail::spsc_ring_buffer<T>{max_size} : nullptr),
+                m_mpmc(m_kind == queue_kind::mpmc ? new detail::mpmc_ring_buffer<T>{max_size} : nullptr) {
             }
 
             Queue(const Queue&) = delete;
@@ -142,6 +480,11 @@ namespace osmium {
             ~Queue() = default;
 #endif
 
+            /// The implementation used by this queue.
+            queue_kind kind() const noexcept {
+                return m_kind;
+            }
+
             /**
              * Push an element onto the queue. If the queue has a max size,
              * this call will block if the queue is full.
@@ -150,48 +493,50 @@ namespace osmium {
                 if (!m_in_use) {
                     return;
                 }
-                constexpr const std::chrono::milliseconds max_wait{10};
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
-                ++m_push_counter;
-#endif
-                if (m_max_size) {
-                    while (size() >= m_max_size) {
-                        std::unique_lock<std::mutex> lock{m_mutex};
-                        m_space_available.wait_for(lock, max_wait, [this] {
-                            return m_queue.size() < m_max_size;
-                        });
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
-                        ++m_full_counter;
-#endif
+                if (m_kind != queue_kind::locked) {
+                    ring_push(value);
+                    return;
+                }
+
+                std::unique_lock<std::mutex> lock{m_mutex};
+                if (m_max_size && m_queue.size() >= m_max_size) {
+                    increment(m_full_counter);
+                    const auto start = std::chrono::steady_clock::now();
+                    m_space_available.wait(lock, [this] {
+                        return !m_in_use || m_queue.size() < m_max_size;
+                    });
+                    m_push_blocked.fetch_add(detail::nanoseconds_since(start), std::memory_order_relaxed);
+                    if (!m_in_use) {
+                        return;
                     }
                 }
-                const std::lock_guard<std::mutex> lock{m_mutex};
                 m_queue.push(std::move(value));
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
-                if (m_largest_size < m_queue.size()) {
-                    m_largest_size = m_queue.size();
-                }
-#endif
+                pushed(m_queue.size());
                 m_data_available.notify_one();
             }
 
             void wait_and_pop(T& value) {
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
-                ++m_pop_counter;
-#endif
+                if (m_kind != queue_kind::locked) {
+                    if (m_in_use) {
+                        ring_wait_and_pop(value);
+                    }
+                    return;
+                }
+
                 std::unique_lock<std::mutex> lock{m_mutex};
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
                 if (m_queue.empty()) {
-                    ++m_empty_counter;
+                    increment(m_empty_counter);
+                    const auto start = std::chrono::steady_clock::now();
+                    m_data_available.wait(lock, [this] {
+                        return !m_in_use || !m_queue.empty();
+                    });
+                    m_pop_blocked.fetch_add(detail::nanoseconds_since(start), std::memory_order_relaxed);
                 }
-#endif
-                m_data_available.wait(lock, [this] {
-                    return !m_in_use || !m_queue.empty();
-                });
                 if (!m_queue.empty()) {
                     value = std::move(m_queue.front());
                     m_queue.pop();
                     lock.unlock();
+                    increment(m_pop_counter);
                     if (m_max_size) {
                         m_space_available.notify_one();
                     }
@@ -199,20 +544,26 @@ namespace osmium {
             }
 
             bool try_pop(T& value) {
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
-                ++m_pop_counter;
-#endif
+                if (m_kind != queue_kind::locked) {
+                    if (m_in_use && ring_try_pop(value)) {
+                        increment(m_pop_counter);
+                        wake_up(m_waiting_producers, m_space_available);
+                        return true;
+                    }
+                    increment(m_empty_counter);
+                    return false;
+                }
+
                 {
                     const std::lock_guard<std::mutex> lock{m_mutex};
                     if (m_queue.empty()) {
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
-                        ++m_empty_counter;
-#endif
+                        increment(m_empty_counter);
                         return false;
                     }
                     value = std::move(m_queue.front());
                     m_queue.pop();
                 }
+                increment(m_pop_counter);
                 if (m_max_size) {
                     m_space_available.notify_one();
                 }
@@ -220,11 +571,17 @@ namespace osmium {
             }
 
             bool empty() const {
+                if (m_kind != queue_kind::locked) {
+                    return !m_in_use || ring_empty();
+                }
                 const std::lock_guard<std::mutex> lock{m_mutex};
                 return m_queue.empty();
             }
 
             std::size_t size() const {
+                if (m_kind != queue_kind::locked) {
+                    return m_in_use ? ring_size() : 0;
+                }
                 const std::lock_guard<std::mutex> lock{m_mutex};
                 return m_queue.size();
             }
@@ -233,6 +590,34 @@ namespace osmium {
                 return m_in_use;
             }
 
+            /**
+             * Get statistics about this queue. This can be called from any
+             * thread at any time. The counters are updated independently,
+             * so they might not be exactly consistent with each other while
+             * the queue is in use.
+             */
+            queue_stats stats() const {
+                queue_stats result;
+                result.name = m_name;
+                result.max_size = m_max_size;
+                result.size = size();
+                result.largest_size = m_largest_size.load(std::memory_order_relaxed);
+                result.pushed = m_push_counter.load(std::memory_order_relaxed);
+                result.full = m_full_counter.load(std::memory_order_relaxed);
+                result.push_blocked = std::chrono::nanoseconds{m_push_blocked.load(std::memory_order_relaxed)};
+                result.popped = m_pop_counter.load(std::memory_order_relaxed);
+                result.empty = m_empty_counter.load(std::memory_order_relaxed);
+                result.pop_blocked = std::chrono::nanoseconds{m_pop_blocked.load(std::memory_order_relaxed)};
+                return result;
+            }
+
+            /**
+             * Shut down the queue. Threads blocked in push() or
+             * wait_and_pop() return, after that nothing goes in or out.
+             * Elements still in a ring buffer are not destructed before
+             * the queue is destructed, because only the consumer may take
+             * them out.
+             */
             void shutdown() {
                 m_in_use = false;
                 const std::lock_guard<std::mutex> lock{m_mutex};
@@ -240,6 +625,7 @@ namespace osmium {
                     m_queue.pop();
                 }
                 m_data_available.notify_all();
+                m_space_available.notify_all();
             }
 
         }; // class Queue
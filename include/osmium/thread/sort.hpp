@@ -0,0 +1,275 @@
+#ifndef OSMIUM_THREAD_SORT_HPP
+#define OSMIUM_THREAD_SORT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/util/memory_mapping.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace thread {
+
+        namespace detail {
+
+            enum : std::size_t {
+                // Ranges smaller than this are sorted with std::sort in
+                // the calling thread.
+                parallel_sort_min_size = 64UL * 1024UL
+            };
+
+            inline void wait_for_all(std::vector<std::future<void>>& futures) {
+                // Wait for all tasks before rethrowing any exception,
+                // because the tasks still reference the data.
+                for (auto& future : futures) {
+                    future.wait();
+                }
+                for (auto& future : futures) {
+                    future.get();
+                }
+                futures.clear();
+            }
+
+            /**
+             * Merge the sorted ranges [a_first, a_last) and [b_first, b_last)
+             * into out. The work is split into num_parts tasks by cutting
+             * the first range into equal parts and finding the matching
+             * split points in the second range with a binary search.
+             */
+            template <typename TInIterator, typename TOutIterator, typename TCompare>
+            void parallel_merge(Pool& pool, std::vector<std::future<void>>& futures,
+                                TInIterator a_first, TInIterator a_last,
+                                TInIterator b_first, TInIterator b_last,
+                                TOutIterator out, TCompare comp, std::size_t num_parts) {
+                const auto a_size = static_cast<std::size_t>(std::distance(a_first, a_last));
+                if (a_size < num_parts) {
+                    num_parts = 1;
+                }
+
+                auto a_begin = a_first;
+                auto b_begin = b_first;
+                for (std::size_t part = 1; part <= num_parts; ++part) {
+                    auto a_end = a_last;
+                    auto b_end = b_last;
+                    if (part != num_parts) {
+                        a_end = a_first + static_cast<std::ptrdiff_t>(a_size * part / num_parts);
+                        b_end = std::lower_bound(b_begin, b_last, *a_end, comp);
+                    }
+                    const auto out_begin = out + (a_begin - a_first) + (b_begin - b_first);
+                    futures.push_back(pool.submit([a_begin, a_end, b_begin, b_end, out_begin, comp]() {
+                        std::merge(a_begin, a_end, b_begin, b_end, out_begin, comp);
+                    }));
+                    a_begin = a_end;
+                    b_begin = b_end;
+                }
+            }
+
+            /**
+             * One round of merging neighbouring sorted runs from src to dst.
+             * The bounds are updated to describe the runs in dst.
+             */
+            template <typename TInIterator, typename TOutIterator, typename TCompare>
+            void merge_round(Pool& pool, TInIterator src, TOutIterator dst, std::vector<std::size_t>& bounds, TCompare comp) {
+                std::vector<std::future<void>> futures;
+                std::vector<std::size_t> new_bounds;
+
+                const std::size_t num_runs = bounds.size() - 1;
+                const std::size_t num_pairs = num_runs / 2;
+                const std::size_t parts_per_pair = std::max<std::size_t>(1, static_cast<std::size_t>(pool.num_threads()) / num_pairs);
+
+                new_bounds.push_back(0);
+                for (std::size_t i = 0; i + 1 < num_runs; i += 2) {
+                    const auto begin  = static_cast<std::ptrdiff_t>(bounds[i]);
+                    const auto middle = static_cast<std::ptrdiff_t>(bounds[i + 1]);
+                    const auto end    = static_cast<std::ptrdiff_t>(bounds[i + 2]);
+                    parallel_merge(pool, futures,
+                                   src + begin, src + middle,
+                                   src + middle, src + end,
+                                   dst + begin, comp, parts_per_pair);
+                    new_bounds.push_back(bounds[i + 2]);
+                }
+
+                if (num_runs % 2 == 1) {
+                    const auto begin = static_cast<std::ptrdiff_t>(bounds[num_runs - 1]);
+                    const auto end = static_cast<std::ptrdiff_t>(bounds[num_runs]);
+                    futures.push_back(pool.submit([src, dst, begin, end]() {
+                        std::copy(src + begin, src + end, dst + begin);
+                    }));
+                    new_bounds.push_back(bounds[num_runs]);
+                }
+
+                wait_for_all(futures);
+                bounds = std::move(new_bounds);
+            }
+
+            template <typename TIterator, typename TBufferIterator, typename TCompare>
+            void parallel_sort_impl(Pool& pool, TIterator first, TIterator last, TBufferIterator buffer, TCompare comp) {
+                const auto size = static_cast<std::size_t>(std::distance(first, last));
+                const auto num_runs = std::min(static_cast<std::size_t>(pool.num_threads()), size);
+
+                std::vector<std::size_t> bounds;
+                std::vector<std::future<void>> futures;
+                bounds.push_back(0);
+                for (std::size_t i = 1; i <= num_runs; ++i) {
+                    bounds.push_back(size * i / num_runs);
+                    const auto begin = first + static_cast<std::ptrdiff_t>(bounds[i - 1]);
+                    const auto end = first + static_cast<std::ptrdiff_t>(bounds[i]);
+                    futures.push_back(pool.submit([begin, end, comp]() {
+                        std::sort(begin, end, comp);
+                    }));
+                }
+                wait_for_all(futures);
+
+                // Merge runs back and forth between the data and the buffer.
+                bool in_buffer = false;
+                while (bounds.size() > 2) {
+                    if (in_buffer) {
+                        merge_round(pool, buffer, first, bounds, comp);
+                    } else {
+                        merge_round(pool, first, buffer, bounds, comp);
+                    }
+                    in_buffer = !in_buffer;
+                }
+
+                if (in_buffer) {
+                    for (std::size_t i = 0; i < num_runs; ++i) {
+                        const auto begin = static_cast<std::ptrdiff_t>(size * i / num_runs);
+                        const auto end = static_cast<std::ptrdiff_t>(size * (i + 1) / num_runs);
+                        futures.push_back(pool.submit([buffer, first, begin, end]() {
+                            std::copy(buffer + begin, buffer + end, first + begin);
+                        }));
+                    }
+                    wait_for_all(futures);
+                }
+            }
+
+        } // namespace detail
+
+        /**
+         * Sort the range [first, last) using the threads in the pool. The
+         * range is cut into one part per thread, those parts are sorted in
+         * parallel and then merged in parallel. Small ranges are sorted
+         * with std::sort in the calling thread.
+         *
+         * This needs a temporary buffer as large as the data. The buffer
+         * is an anonymous memory mapping, so the value type of the range
+         * must be trivially copyable.
+         *
+         * Do not call this from a task running in the same pool, it waits
+         * for tasks it submits to the pool.
+         *
+         * @param pool The thread pool to use.
+         * @param first Start of range to sort.
+         * @param last End of range to sort.
+         * @param comp Comparison function.
+         */
+        template <typename TIterator, typename TCompare>
+        void parallel_sort(Pool& pool, TIterator first, TIterator last, TCompare comp) {
+            using value_type = typename std::iterator_traits<TIterator>::value_type;
+
+            const auto size = static_cast<std::size_t>(std::distance(first, last));
+            if (size < detail::parallel_sort_min_size || pool.num_threads() < 2) {
+                std::sort(first, last, comp);
+                return;
+            }
+
+            osmium::TypedMemoryMapping<value_type> buffer{size};
+            detail::parallel_sort_impl(pool, first, last, buffer.begin(), comp);
+        }
+
+        template <typename TIterator>
+        void parallel_sort(Pool& pool, TIterator first, TIterator last) {
+            using value_type = typename std::iterator_traits<TIterator>::value_type;
+            parallel_sort(pool, first, last, std::less<value_type>{});
+        }
+
+        /**
+         * Sort the range [first, last) using the threads in the pool like
+         * parallel_sort(), but put the temporary buffer into a memory
+         * mapped temporary file instead of anonymous memory. Use this for
+         * very large data which is itself stored in memory mapped files,
+         * so the sort doesn't need additional main memory.
+         *
+         * @param pool The thread pool to use.
+         * @param first Start of range to sort.
+         * @param last End of range to sort.
+         * @param comp Comparison function.
+         * @throws std::system_error if the temporary file can not be
+         *         created.
+         */
+        template <typename TIterator, typename TCompare>
+        void parallel_sort_external(Pool& pool, TIterator first, TIterator last, TCompare comp) {
+            using value_type = typename std::iterator_traits<TIterator>::value_type;
+
+            const auto size = static_cast<std::size_t>(std::distance(first, last));
+            if (size < detail::parallel_sort_min_size || pool.num_threads() < 2) {
+                std::sort(first, last, comp);
+                return;
+            }
+
+            int fd = osmium::detail::create_tmp_file();
+            try {
+                osmium::TypedMemoryMapping<value_type> buffer{size, osmium::MemoryMapping::mapping_mode::write_shared, fd};
+                // The mapping stays valid after the file is closed.
+                osmium::io::detail::reliable_close(fd);
+                fd = -1;
+                detail::parallel_sort_impl(pool, first, last, buffer.begin(), comp);
+            } catch (...) {
+                if (fd >= 0) {
+                    osmium::io::detail::reliable_close(fd);
+                }
+                throw;
+            }
+        }
+
+        template <typename TIterator>
+        void parallel_sort_external(Pool& pool, TIterator first, TIterator last) {
+            using value_type = typename std::iterator_traits<TIterator>::value_type;
+            parallel_sort_external(pool, first, last, std::less<value_type>{});
+        }
+
+    } // namespace thread
+
+} // namespace osmium
+
+#endif // OSMIUM_THREAD_SORT_HPP
@@ -0,0 +1,286 @@
+#ifndef OSMIUM_THREAD_STATS_HPP
+#define OSMIUM_THREAD_STATS_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace osmium {
+
+    namespace thread {
+
+        /**
+         * Histogram of durations with buckets growing in powers of two.
+         * Bucket 0 counts durations below 1 microsecond, bucket n counts
+         * durations from 2^(n-1) up to 2^n microseconds, the last bucket
+         * counts everything longer than that.
+         */
+        class duration_histogram {
+
+        public:
+
+            enum : std::size_t {
+                num_buckets = 32
+            };
+
+        private:
+
+            std::array<uint64_t, num_buckets> m_counts{};
+
+        public:
+
+            /// The bucket a duration is counted in.
+            static std::size_t bucket(std::chrono::nanoseconds duration) noexcept {
+                auto us = static_cast<uint64_t>(duration.count()) / 1000U;
+                std::size_t n = 0;
+                while (us > 0 && n < num_buckets - 1) {
+                    us >>= 1U;
+                    ++n;
+                }
+                return n;
+            }
+
+            /**
+             * The (exclusive) upper bound of durations in the given bucket.
+             * Returns nanoseconds::max() for the last bucket.
+             */
+            static std::chrono::nanoseconds upper_bound(std::size_t n) noexcept {
+                if (n >= num_buckets - 1) {
+                    return std::chrono::nanoseconds::max();
+                }
+                return std::chrono::microseconds{1LL << n};
+            }
+
+            void add(std::size_t n, uint64_t count = 1) noexcept {
+                m_counts[n] += count;
+            }
+
+            uint64_t count(std::size_t n) const noexcept {
+                return m_counts[n];
+            }
+
+            /// The number of durations in all buckets.
+            uint64_t total() const noexcept {
+                uint64_t sum = 0;
+                for (const auto c : m_counts) {
+                    sum += c;
+                }
+                return sum;
+            }
+
+            /**
+             * The upper bound of the bucket containing the given
+             * percentile (0.0 to 1.0). Returns zero if the histogram is
+             * empty.
+             */
+            std::chrono::nanoseconds percentile(double p) const noexcept {
+                const auto all = total();
+                if (all == 0) {
+                    return std::chrono::nanoseconds{0};
+                }
+                const auto rank = static_cast<uint64_t>(p * static_cast<double>(all));
+                uint64_t sum = 0;
+                for (std::size_t n = 0; n < num_buckets; ++n) {
+                    sum += m_counts[n];
+                    if (sum > rank) {
+                        return upper_bound(n);
+                    }
+                }
+                return upper_bound(num_buckets - 1);
+            }
+
+        }; // class duration_histogram
+
+        /**
+         * Statistics of a Queue.
+         */
+        struct queue_stats {
+
+            /// Name of the queue.
+            std::string name;
+
+            /// Maximum size of the queue (0 for unlimited).
+            std::size_t max_size = 0;
+
+            /// Current number of elements in the queue.
+            std::size_t size = 0;
+
+            /// The largest number of elements in the queue so far.
+            std::size_t largest_size = 0;
+
+            /// Number of elements pushed.
+            uint64_t pushed = 0;
+
+            /// Number of times push() had to wait because the queue was full.
+            uint64_t full = 0;
+
+            /// Time spent waiting in push() (summed over all threads).
+            std::chrono::nanoseconds push_blocked{0};
+
+            /// Number of elements popped.
+            uint64_t popped = 0;
+
+            /// Number of times a pop found the queue empty.
+            uint64_t empty = 0;
+
+            /// Time spent waiting in wait_and_pop() (summed over all threads).
+            std::chrono::nanoseconds pop_blocked{0};
+
+        }; // struct queue_stats
+
+        /**
+         * Statistics of a thread Pool.
+         */
+        struct pool_stats {
+
+            /// Number of worker threads.
+            int num_threads = 0;
+
+            /// Number of tasks queued and not yet started.
+            std::size_t queue_size = 0;
+
+            /// Number of tasks run so far.
+            uint64_t tasks = 0;
+
+            /// Time spent running tasks (summed over all threads).
+            std::chrono::nanoseconds busy{0};
+
+            /// Execution times of the tasks.
+            duration_histogram task_times{};
+
+        }; // struct pool_stats
+
+        /**
+         * Amount of data that went through some stage of processing since
+         * the stage was started.
+         */
+        struct throughput_stats {
+
+            /// Number of blocks of data (buffers, blobs, ...).
+            uint64_t blocks = 0;
+
+            /// Number of bytes.
+            uint64_t bytes = 0;
+
+            /// Time since the stage was started.
+            std::chrono::nanoseconds elapsed{0};
+
+            double blocks_per_second() const noexcept {
+                return elapsed.count() > 0 ? static_cast<double>(blocks) * 1e9 / static_cast<double>(elapsed.count()) : 0.0;
+            }
+
+            double bytes_per_second() const noexcept {
+                return elapsed.count() > 0 ? static_cast<double>(bytes) * 1e9 / static_cast<double>(elapsed.count()) : 0.0;
+            }
+
+        }; // struct throughput_stats
+
+        namespace detail {
+
+            inline int64_t nanoseconds_since(std::chrono::steady_clock::time_point start) noexcept {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            }
+
+            /**
+             * Thread-safe counters behind a duration_histogram.
+             */
+            class atomic_duration_histogram {
+
+                std::array<std::atomic<uint64_t>, duration_histogram::num_buckets> m_counts;
+                std::atomic<int64_t> m_sum{0};
+
+            public:
+
+                atomic_duration_histogram() noexcept {
+                    for (auto& c : m_counts) {
+                        c.store(0, std::memory_order_relaxed);
+                    }
+                }
+
+                void add(std::chrono::nanoseconds duration) noexcept {
+                    m_counts[duration_histogram::bucket(duration)].fetch_add(1, std::memory_order_relaxed);
+                    m_sum.fetch_add(duration.count(), std::memory_order_relaxed);
+                }
+
+                std::chrono::nanoseconds sum() const noexcept {
+                    return std::chrono::nanoseconds{m_sum.load(std::memory_order_relaxed)};
+                }
+
+                duration_histogram histogram() const noexcept {
+                    duration_histogram result;
+                    for (std::size_t n = 0; n < m_counts.size(); ++n) {
+                        result.add(n, m_counts[n].load(std::memory_order_relaxed));
+                    }
+                    return result;
+                }
+
+            }; // class atomic_duration_histogram
+
+            /**
+             * Thread-safe counters behind a throughput_stats.
+             */
+            class throughput_counter {
+
+                std::chrono::steady_clock::time_point m_start = std::chrono::steady_clock::now();
+                std::atomic<uint64_t> m_blocks{0};
+                std::atomic<uint64_t> m_bytes{0};
+
+            public:
+
+                void add(std::size_t bytes) noexcept {
+                    m_blocks.fetch_add(1, std::memory_order_relaxed);
+                    m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+                }
+
+                throughput_stats stats() const noexcept {
+                    throughput_stats result;
+                    result.blocks = m_blocks.load(std::memory_order_relaxed);
+                    result.bytes = m_bytes.load(std::memory_order_relaxed);
+                    result.elapsed = std::chrono::nanoseconds{nanoseconds_since(m_start)};
+                    return result;
+                }
+
+            }; // class throughput_counter
+
+        } // namespace detail
+
+    } // namespace thread
+
+} // namespace osmium
+
+#endif // OSMIUM_THREAD_STATS_HPP
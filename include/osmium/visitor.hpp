@@ -75,6 +75,9 @@ namespace osmium {
                 case osmium::item_type::changeset:
                     handler.changeset(static_cast<ConstIfConst<TItem, osmium::Changeset>&>(item));
                     break;
+                case osmium::item_type::node_batch:
+                    handler.node_batch(static_cast<ConstIfConst<TItem, osmium::NodeBatch>&>(item));
+                    break;
                 case osmium::item_type::tag_list:
                     handler.tag_list(static_cast<ConstIfConst<TItem, osmium::TagList>&>(item));
                     break;
@@ -261,6 +264,10 @@ namespace osmium {
                 operator()(changeset);
             }
 
+            void node_batch(const osmium::NodeBatch& node_batch) const {
+                operator()(node_batch);
+            }
+
             void tag_list(const osmium::TagList& /*tag_list*/) const noexcept {
             }
 
@@ -322,6 +329,99 @@ namespace osmium {
         apply_flush(std::forward<THandlers>(handlers)...);
     }
 
+    namespace detail {
+
+        template <osmium::item_type TType>
+        using item_type_tag = std::integral_constant<osmium::item_type, TType>;
+
+        template <typename THandler, typename TNode>
+        inline void apply_object(TNode& node, THandler&& handler, item_type_tag<osmium::item_type::node> /*type*/) {
+            handler.osm_object(node);
+            handler.node(node);
+        }
+
+        template <typename THandler, typename TWay>
+        inline void apply_object(TWay& way, THandler&& handler, item_type_tag<osmium::item_type::way> /*type*/) {
+            handler.osm_object(way);
+            handler.way(way);
+        }
+
+        template <typename THandler, typename TRelation>
+        inline void apply_object(TRelation& relation, THandler&& handler, item_type_tag<osmium::item_type::relation> /*type*/) {
+            handler.osm_object(relation);
+            handler.relation(relation);
+        }
+
+        template <typename THandler, typename TArea>
+        inline void apply_object(TArea& area, THandler&& handler, item_type_tag<osmium::item_type::area> /*type*/) {
+            handler.osm_object(area);
+            handler.area(area);
+        }
+
+        template <typename THandler, typename TChangeset>
+        inline void apply_object(TChangeset& changeset, THandler&& handler, item_type_tag<osmium::item_type::changeset> /*type*/) {
+            handler.changeset(changeset);
+        }
+
+        template <typename THandler, typename TNodeBatch>
+        inline void apply_object(TNodeBatch& node_batch, THandler&& handler, item_type_tag<osmium::item_type::node_batch> /*type*/) {
+            handler.node_batch(node_batch);
+        }
+
+        // Call handlers for all objects in a buffer which only contains
+        // objects of type TObject. No type checks needed.
+        template <typename TObject, typename TData, typename... THandlers>
+        inline void apply_homogeneous(TData* data, TData* end, THandlers&&... handlers) {
+            using type = item_type_tag<std::remove_const<TObject>::type::itemtype>;
+            while (data != end) {
+                auto& object = *reinterpret_cast<TObject*>(data);
+                (void)std::initializer_list<int>{
+                    (apply_object(object, handlers, type{}), 0)...};
+                data = object.next();
+            }
+        }
+
+        template <typename TBuffer, typename... THandlers>
+        inline void apply_buffer(TBuffer& buffer, THandlers&&... handlers) {
+            using const_if_const = typename std::conditional<std::is_const<TBuffer>::value, const unsigned char, unsigned char>::type;
+            if (buffer.committed() > 0) {
+                const_if_const* data = buffer.data();
+                const_if_const* end = data + buffer.committed();
+                switch (buffer.homogeneous_type()) {
+                    case osmium::item_type::node:
+                        apply_homogeneous<ConstIfConst<TBuffer, osmium::Node>>(data, end, handlers...);
+                        break;
+                    case osmium::item_type::way:
+                        apply_homogeneous<ConstIfConst<TBuffer, osmium::Way>>(data, end, handlers...);
+                        break;
+                    case osmium::item_type::relation:
+                        apply_homogeneous<ConstIfConst<TBuffer, osmium::Relation>>(data, end, handlers...);
+                        break;
+                    case osmium::item_type::area:
+                        apply_homogeneous<ConstIfConst<TBuffer, osmium::Area>>(data, end, handlers...);
+                        break;
+                    case osmium::item_type::changeset:
+                        apply_homogeneous<ConstIfConst<TBuffer, osmium::Changeset>>(data, end, handlers...);
+                        break;
+                    case osmium::item_type::node_batch:
+                        apply_homogeneous<ConstIfConst<TBuffer, osmium::NodeBatch>>(data, end, handlers...);
+                        break;
+                    default:
+                        // OSM entities and node batches, but not other
+                        // items such as top-level tag lists.
+                        for (auto& item : buffer.template select<osmium::memory::Item>()) {
+                            if (osmium::OSMEntity::is_compatible_to(item.type()) ||
+                                item.type() == osmium::item_type::node_batch) {
+                                apply_item(item, handlers...);
+                            }
+                        }
+                }
+            }
+            apply_flush(std::forward<THandlers>(handlers)...);
+        }
+
+    } // namespace detail
+
     template <typename TIterator, typename... THandlers>
     inline void apply(TIterator it, TIterator end, THandlers&&... handlers) {
         apply_impl(it, end, detail::make_handler<THandlers>(std::forward<THandlers>(handlers))...);
@@ -334,9 +434,20 @@ namespace osmium {
         apply(begin(c), end(c), std::forward<THandlers>(handlers)...);
     }
 
+    /**
+     * Apply handlers to all objects in a buffer. If the buffer only
+     * contains objects of one type (see
+     * osmium::memory::Buffer::homogeneous_type()), the handlers are
+     * called in a tight loop without checking the type of each object.
+     */
     template <typename... THandlers>
     inline void apply(const osmium::memory::Buffer& buffer, THandlers&&... handlers) {
-        apply(buffer.cbegin(), buffer.cend(), std::forward<THandlers>(handlers)...);
+        detail::apply_buffer(buffer, detail::make_handler<THandlers>(std::forward<THandlers>(handlers))...);
+    }
+
+    template <typename... THandlers>
+    inline void apply(osmium::memory::Buffer& buffer, THandlers&&... handlers) {
+        detail::apply_buffer(buffer, detail::make_handler<THandlers>(std::forward<THandlers>(handlers))...);
     }
 
 } // namespace osmium
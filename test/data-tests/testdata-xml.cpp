@@ -103,6 +103,10 @@ static header_buffer_type parse_xml(std::string input) {
         osmium::osm_entity_bits::all,
         osmium::io::read_meta::yes,
         osmium::io::buffers_type::any,
+        osmium::io::node_batch_mode::none,
+        osmium::io::read_tags{},
+        osmium::io::read_members::yes,
+        osmium::io::object_filter{},
         false
     };
     osmium::io::detail::XMLParser parser{args};
@@ -5,6 +5,9 @@
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/area.hpp>
 
+#include <utility>
+#include <vector>
+
 using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
 
 TEST_CASE("Build area from way") {
@@ -141,3 +144,70 @@ TEST_CASE("Build area from way with ignored invalid location") {
     REQUIRE(s.invalid_locations == 1);
 }
 
+namespace {
+
+    osmium::object_id_type add_square_way(osmium::memory::Buffer& buffer, osmium::object_id_type id, double x, double y, double size) {
+        const auto node_id = id * 10;
+        osmium::builder::add_way(buffer,
+            _id(id),
+            _nodes({
+                {node_id + 1, {x, y}},
+                {node_id + 2, {x + size, y}},
+                {node_id + 3, {x + size, y + size}},
+                {node_id + 4, {x, y + size}},
+                {node_id + 1, {x, y}}
+            })
+        );
+        return id;
+    }
+
+} // anonymous namespace
+
+TEST_CASE("Build area from relation with many inner rings") {
+    // A large outer ring with a grid of holes, each with an island in it.
+    // This has enough segments so that the segment index is used.
+    const int size = 10;
+
+    osmium::memory::Buffer buffer{10240, osmium::memory::Buffer::auto_grow::yes};
+    std::vector<std::pair<osmium::object_id_type, const char*>> members;
+
+    osmium::object_id_type id = 1;
+    members.emplace_back(add_square_way(buffer, id++, 0.0, 0.0, size + 1.0), "outer");
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            members.emplace_back(add_square_way(buffer, id++, i + 0.6, j + 0.6, 0.8), "inner");
+            members.emplace_back(add_square_way(buffer, id++, i + 0.8, j + 0.8, 0.4), "outer");
+        }
+    }
+
+    std::vector<const osmium::Way*> ways;
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        ways.push_back(&way);
+    }
+
+    osmium::memory::Buffer relation_buffer{10240, osmium::memory::Buffer::auto_grow::yes};
+    {
+        osmium::builder::RelationBuilder builder{relation_buffer};
+        builder.set_id(1);
+        osmium::builder::RelationMemberListBuilder member_builder{builder};
+        for (const auto& member : members) {
+            member_builder.add_member(osmium::item_type::way, member.first, member.second);
+        }
+    }
+    relation_buffer.commit();
+
+    const osmium::area::AssemblerConfig config;
+    osmium::area::Assembler assembler{config};
+
+    osmium::memory::Buffer area_buffer{10240, osmium::memory::Buffer::auto_grow::yes};
+    REQUIRE(assembler(relation_buffer.get<osmium::Relation>(0), ways, area_buffer));
+
+    const auto& area = area_buffer.get<osmium::Area>(0);
+    REQUIRE(area.num_rings() == std::make_pair<std::size_t, std::size_t>(size * size + 1, size * size));
+
+    const auto& s = assembler.stats();
+    REQUIRE(s.from_relations == 1);
+    REQUIRE(s.outer_rings == size * size + 1);
+    REQUIRE(s.inner_rings == size * size);
+    REQUIRE(s.intersections == 0);
+}
@@ -0,0 +1,134 @@
+#include "catch.hpp"
+
+#include <osmium/area/assembler.hpp>
+#include <osmium/area/incremental_area_manager.hpp>
+#include <osmium/builder/attr.hpp>
+#include <osmium/index/map/sparse_mem_map.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/area.hpp>
+
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+using location_index_type = osmium::index::map::SparseMemMap<osmium::unsigned_object_id_type, osmium::Location>;
+using manager_type = osmium::area::IncrementalAreaManager<osmium::area::Assembler>;
+
+static void add_square(osmium::memory::Buffer& buffer, osmium::object_id_type first_id, double x, double y) {
+    osmium::builder::add_node(buffer, _id(first_id),     _location(x,       y));
+    osmium::builder::add_node(buffer, _id(first_id + 1), _location(x + 1.0, y));
+    osmium::builder::add_node(buffer, _id(first_id + 2), _location(x + 1.0, y + 1.0));
+    osmium::builder::add_node(buffer, _id(first_id + 3), _location(x,       y + 1.0));
+}
+
+static std::vector<osmium::object_id_type> area_ids(const osmium::memory::Buffer& buffer) {
+    std::vector<osmium::object_id_type> ids;
+    for (const auto& area : buffer.select<osmium::Area>()) {
+        ids.push_back(area.id());
+    }
+    return ids;
+}
+
+TEST_CASE("Incremental area manager") {
+    osmium::memory::Buffer input{1024, osmium::memory::Buffer::auto_grow::yes};
+
+    // Closed way 20 with nodes 10-13 and multipolygon relation 30 from
+    // ways 21 and 22 with nodes 14-17.
+    add_square(input, 10, 1.0, 1.0);
+    add_square(input, 14, 3.0, 1.0);
+    osmium::builder::add_way(input, _id(20), _tag("building", "yes"), _nodes({10, 11, 12, 13, 10}));
+    osmium::builder::add_way(input, _id(21), _nodes({14, 15, 16}));
+    osmium::builder::add_way(input, _id(22), _nodes({16, 17, 14}));
+    osmium::builder::add_way(input, _id(23), _tag("highway", "primary"), _nodes({10, 14}));
+    osmium::builder::add_relation(input, _id(30), _tag("type", "multipolygon"), _tag("landuse", "forest"),
+        _member(osmium::item_type::way, 21, "outer"),
+        _member(osmium::item_type::way, 22, "outer"));
+
+    location_index_type locations;
+    const osmium::area::AssemblerConfig config;
+    manager_type manager{config, locations};
+
+    for (const auto& relation : input.select<osmium::Relation>()) {
+        manager.relation(relation);
+    }
+    for (const auto& node : input.select<osmium::Node>()) {
+        manager.node(node);
+    }
+    for (const auto& way : input.select<osmium::Way>()) {
+        manager.way(way);
+    }
+
+    osmium::memory::Buffer out{1024, osmium::memory::Buffer::auto_grow::yes};
+    auto changes = manager.assemble_dirty(out);
+    REQUIRE(area_ids(out) == std::vector<osmium::object_id_type>({40, 61}));
+    REQUIRE(changes.dirty_area_ids == std::vector<osmium::object_id_type>({40, 42, 44, 61}));
+    REQUIRE(changes.incomplete_relations.empty());
+
+    SECTION("Nothing changed") {
+        out.clear();
+        changes = manager.assemble_dirty(out);
+        REQUIRE(out.committed() == 0);
+        REQUIRE(changes.dirty_area_ids.empty());
+    }
+
+    SECTION("Moved node only changes relation area") {
+        osmium::memory::Buffer diff{1024, osmium::memory::Buffer::auto_grow::yes};
+        osmium::builder::add_node(diff, _id(15), _version(2), _location(4.5, 1.0));
+        manager.apply_changes(diff);
+
+        out.clear();
+        changes = manager.assemble_dirty(out);
+        REQUIRE(area_ids(out) == std::vector<osmium::object_id_type>({61}));
+        REQUIRE(changes.dirty_area_ids == std::vector<osmium::object_id_type>({42, 61}));
+
+        const auto& area = out.get<osmium::Area>(0);
+        bool found = false;
+        for (const auto& ring : area.outer_rings()) {
+            for (const auto& node_ref : ring) {
+                if (node_ref.ref() == 15) {
+                    REQUIRE(node_ref.location() == osmium::Location(4.5, 1.0));
+                    found = true;
+                }
+            }
+        }
+        REQUIRE(found);
+    }
+
+    SECTION("Deleted way removes area") {
+        osmium::memory::Buffer diff{1024, osmium::memory::Buffer::auto_grow::yes};
+        osmium::builder::add_way(diff, _id(20), _version(2), _visible(false));
+        manager.apply_changes(diff);
+
+        out.clear();
+        changes = manager.assemble_dirty(out);
+        REQUIRE(out.committed() == 0);
+        REQUIRE(changes.dirty_area_ids == std::vector<osmium::object_id_type>({40}));
+    }
+
+    SECTION("Changed relation with unknown member way") {
+        osmium::memory::Buffer diff{1024, osmium::memory::Buffer::auto_grow::yes};
+        osmium::builder::add_relation(diff, _id(30), _version(2), _tag("type", "multipolygon"), _tag("landuse", "forest"),
+            _member(osmium::item_type::way, 21, "outer"),
+            _member(osmium::item_type::way, 22, "outer"),
+            _member(osmium::item_type::way, 23, "inner"));
+        manager.apply_changes(diff);
+
+        out.clear();
+        changes = manager.assemble_dirty(out);
+        REQUIRE(out.committed() == 0);
+        REQUIRE(changes.dirty_area_ids == std::vector<osmium::object_id_type>({61}));
+        REQUIRE(changes.incomplete_relations == std::vector<osmium::object_id_type>({30}));
+
+        // Add the missing way, now the relation can be assembled again.
+        for (const auto& way : input.select<osmium::Way>()) {
+            if (way.id() == 23) {
+                manager.way(way);
+            }
+        }
+
+        out.clear();
+        changes = manager.assemble_dirty(out);
+        REQUIRE(changes.dirty_area_ids == std::vector<osmium::object_id_type>({46, 61}));
+        REQUIRE(changes.incomplete_relations.empty());
+    }
+}
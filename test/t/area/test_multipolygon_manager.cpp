@@ -0,0 +1,124 @@
+#include "catch.hpp"
+
+#include <osmium/area/assembler.hpp>
+#include <osmium/area/multipolygon_manager.hpp>
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/visitor.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+namespace {
+
+    void add_square(osmium::memory::Buffer& buffer, osmium::object_id_type id, double x, double y, bool tagged) {
+        const auto node_id = id * 10;
+        if (tagged) {
+            osmium::builder::add_way(buffer,
+                _id(id),
+                _tag("building", "yes"),
+                _nodes({
+                    {node_id + 1, {x, y}},
+                    {node_id + 2, {x, y + 1.0}},
+                    {node_id + 3, {x + 1.0, y + 1.0}},
+                    {node_id + 4, {x + 1.0, y}},
+                    {node_id + 1, {x, y}}
+                })
+            );
+        } else {
+            osmium::builder::add_way(buffer,
+                _id(id),
+                _nodes({
+                    {node_id + 1, {x, y}},
+                    {node_id + 2, {x, y + 1.0}},
+                    {node_id + 3, {x + 1.0, y + 1.0}},
+                    {node_id + 4, {x + 1.0, y}},
+                    {node_id + 1, {x, y}}
+                })
+            );
+        }
+    }
+
+    osmium::memory::Buffer create_data() {
+        osmium::memory::Buffer buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+
+        for (osmium::object_id_type id = 1; id <= 12000; ++id) {
+            add_square(buffer, id, static_cast<double>(id % 300) - 150.0, static_cast<double>(id / 300), id % 3 != 0);
+        }
+
+        for (osmium::object_id_type id = 1; id <= 4000; ++id) {
+            osmium::builder::add_relation(buffer,
+                _id(id),
+                _tag("type", "multipolygon"),
+                _tag("landuse", "forest"),
+                _member(osmium::item_type::way, id * 3, "outer")
+            );
+        }
+
+        return buffer;
+    }
+
+    struct result {
+        std::vector<osmium::object_id_type> ids;
+        osmium::area::area_stats stats;
+    };
+
+    result assemble(const osmium::memory::Buffer& data, osmium::thread::Pool* pool, osmium::area::result_order order) {
+        const osmium::area::AssemblerConfig config;
+        osmium::area::MultipolygonManager<osmium::area::Assembler> manager{config};
+
+        for (const auto& relation : data.select<osmium::Relation>()) {
+            manager.relation(relation);
+        }
+        manager.prepare_for_lookup();
+
+        if (pool) {
+            manager.use_pool(*pool, order);
+        }
+
+        result r;
+        osmium::apply(data, manager.handler([&r](osmium::memory::Buffer&& buffer) {
+            for (const auto& area : buffer.select<osmium::Area>()) {
+                r.ids.push_back(area.id());
+            }
+        }));
+        r.stats = manager.stats();
+
+        return r;
+    }
+
+} // anonymous namespace
+
+TEST_CASE("Assemble multipolygons on thread pool") {
+    const auto data = create_data();
+    const auto serial = assemble(data, nullptr, osmium::area::result_order::ordered);
+
+    REQUIRE(serial.ids.size() == 12000);
+    REQUIRE(serial.stats.from_ways == 8000);
+    REQUIRE(serial.stats.from_relations == 4000);
+
+    osmium::thread::Pool pool{4};
+
+    SECTION("ordered") {
+        const auto parallel = assemble(data, &pool, osmium::area::result_order::ordered);
+        REQUIRE(parallel.ids == serial.ids);
+        REQUIRE(parallel.stats.from_ways == 8000);
+        REQUIRE(parallel.stats.from_relations == 4000);
+        REQUIRE(parallel.stats.nodes == serial.stats.nodes);
+    }
+
+    SECTION("unordered") {
+        auto parallel = assemble(data, &pool, osmium::area::result_order::unordered);
+        auto ids = serial.ids;
+        std::sort(ids.begin(), ids.end());
+        std::sort(parallel.ids.begin(), parallel.ids.end());
+        REQUIRE(parallel.ids == ids);
+        REQUIRE(parallel.stats.from_relations == 4000);
+    }
+}
+
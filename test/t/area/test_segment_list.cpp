@@ -0,0 +1,112 @@
+#include "catch.hpp"
+
+#include <osmium/area/detail/segment_index.hpp>
+#include <osmium/area/detail/segment_list.hpp>
+#include <osmium/area/problem_reporter.hpp>
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <random>
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+namespace {
+
+    struct IntersectionCollector : public osmium::area::ProblemReporter {
+
+        std::vector<osmium::Location> intersections;
+
+        void report_intersection(osmium::object_id_type /*way1_id*/, osmium::Location /*way1_seg_start*/, osmium::Location /*way1_seg_end*/,
+                                 osmium::object_id_type /*way2_id*/, osmium::Location /*way2_seg_start*/, osmium::Location /*way2_seg_end*/, osmium::Location intersection) override {
+            intersections.push_back(intersection);
+        }
+
+    }; // struct IntersectionCollector
+
+    const osmium::Way& create_random_way(osmium::memory::Buffer& buffer, std::size_t num_nodes) {
+        std::mt19937 gen{42}; // NOLINT(cert-msc32-c, cert-msc51-cpp)
+        std::uniform_int_distribution<int32_t> dist{0, 100000};
+
+        std::vector<osmium::NodeRef> nodes;
+        for (std::size_t n = 1; n < num_nodes; ++n) {
+            nodes.emplace_back(static_cast<osmium::object_id_type>(n), osmium::Location{dist(gen), dist(gen)});
+        }
+        nodes.push_back(nodes.front());
+
+        const auto pos = osmium::builder::add_way(buffer, _id(1), _nodes(nodes));
+        return buffer.get<osmium::Way>(pos);
+    }
+
+    // Simple implementation checking all pairs of segments.
+    std::vector<osmium::Location> brute_force_intersections(const osmium::area::detail::SegmentList& list) {
+        std::vector<osmium::Location> intersections;
+        for (std::size_t i = 0; i < list.size(); ++i) {
+            for (std::size_t j = i + 1; j < list.size(); ++j) {
+                if (!osmium::area::detail::outside_x_range(list[j], list[i]) &&
+                    osmium::area::detail::y_range_overlap(list[i], list[j])) {
+                    const osmium::Location intersection{osmium::area::detail::calculate_intersection(list[i], list[j])};
+                    if (intersection) {
+                        intersections.push_back(intersection);
+                    }
+                }
+            }
+        }
+        return intersections;
+    }
+
+} // anonymous namespace
+
+TEST_CASE("Find intersections in small and large segment lists") {
+    const std::size_t num_nodes = GENERATE(10, 100, 2000);
+
+    osmium::memory::Buffer buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+    const auto& way = create_random_way(buffer, num_nodes);
+
+    osmium::area::detail::SegmentList list{false};
+    uint64_t duplicate_nodes = 0;
+    list.extract_segments_from_way(nullptr, duplicate_nodes, way);
+    list.sort();
+    REQUIRE(list.size() == num_nodes - 1);
+
+    const auto expected = brute_force_intersections(list);
+
+    IntersectionCollector reporter;
+    REQUIRE(list.find_intersections(&reporter) == expected.size());
+    REQUIRE(reporter.intersections == expected);
+}
+
+TEST_CASE("Segment index finds segments ending right of location") {
+    osmium::memory::Buffer buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+    const auto& way = create_random_way(buffer, 1000);
+
+    osmium::area::detail::SegmentList list{false};
+    uint64_t duplicate_nodes = 0;
+    list.extract_segments_from_way(nullptr, duplicate_nodes, way);
+    list.sort();
+
+    osmium::area::detail::SegmentIndex index;
+    REQUIRE(index.empty());
+    index.build(list);
+    REQUIRE_FALSE(index.empty());
+
+    for (const std::size_t last : {0, 1, 10, 500, 998}) {
+        const int32_t x = list[last].first().location().x();
+
+        std::vector<std::size_t> expected;
+        for (std::size_t n = last + 1; n > 0; --n) {
+            if (list[n - 1].second().location().x() >= x) {
+                expected.push_back(n - 1);
+            }
+        }
+
+        std::vector<std::size_t> found;
+        index.for_each_reverse(last, x, [&found](std::size_t n) {
+            found.push_back(n);
+        });
+
+        REQUIRE(found == expected);
+    }
+}
+
@@ -127,3 +127,37 @@ TEST_CASE("apply with handler and lambda") {
     REQUIRE(y == 40000000);
 }
 
+TEST_CASE("apply on buffer with homogeneous type") {
+    const osmium::io::File file{with_data_dir("t/relations/data.osm")};
+    osmium::io::Reader reader{file, osmium::osm_entity_bits::way};
+    auto buffer = reader.read();
+    REQUIRE(buffer);
+    buffer.set_homogeneous_type(osmium::item_type::way);
+
+    int count_w = 0;
+    int count_o = 0;
+    int count_n = 0;
+
+    osmium::apply(buffer,
+        [&](const osmium::Way& /*way*/) {
+            ++count_w;
+        },
+        [&](osmium::OSMObject& /*object*/) {
+            ++count_o;
+        },
+        [&](const osmium::Node& /*node*/) {
+            ++count_n;
+        }
+    );
+
+    REQUIRE(count_w == 2);
+    REQUIRE(count_o == 2);
+    REQUIRE(count_n == 0);
+
+    count_w = 0;
+    const auto& const_buffer = buffer;
+    osmium::apply(const_buffer, [&](const osmium::Way& /*way*/) {
+        ++count_w;
+    });
+    REQUIRE(count_w == 2);
+}
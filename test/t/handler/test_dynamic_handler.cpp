@@ -112,3 +112,69 @@ TEST_CASE("Dynamic handler") {
     REQUIRE(count == 10);
 }
 
+struct Handler3 {
+
+    int& count;
+
+    explicit Handler3(int& c) :
+        count(c) {
+    }
+
+    void operator()(const osmium::Node& /*node*/) noexcept {
+        count += 3;
+    }
+
+    void operator()(const osmium::Way& /*way*/) noexcept {
+        count += 30;
+    }
+
+    void operator()(const osmium::OSMEntity& /*entity*/) noexcept {
+    }
+
+};
+
+TEST_CASE("Dynamic handler called for whole buffer") {
+    const auto buffer = fill_buffer();
+
+    osmium::handler::DynamicHandler handler;
+    handler.buffer(buffer);
+
+    int count = 0;
+    handler.set<Handler1>(count);
+    handler.buffer(buffer);
+    REQUIRE(count == 5);
+    handler.flush();
+    REQUIRE(count == 6);
+
+    count = 0;
+    handler.set<Handler3>(count);
+    handler.buffer(buffer);
+    REQUIRE(count == 33);
+}
+
+TEST_CASE("Dynamic handler together with other handlers") {
+    const auto buffer = fill_buffer();
+
+    int count1 = 0;
+    int count2 = 0;
+    osmium::handler::DynamicHandler handler;
+    handler.set<Handler1>(count1);
+    Handler2 h2{count2};
+    osmium::apply(buffer, handler, h2);
+    REQUIRE(count1 == 6);
+    REQUIRE(count2 == 10);
+}
+
+TEST_CASE("Dynamic handler on buffer with homogeneous type") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+    osmium::memory::Buffer buffer{1024UL, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_way(buffer, _id(1));
+    osmium::builder::add_way(buffer, _id(2));
+    buffer.set_homogeneous_type(osmium::item_type::way);
+
+    int count = 0;
+    osmium::handler::DynamicHandler handler;
+    handler.set<Handler3>(count);
+    osmium::apply(buffer, handler);
+    REQUIRE(count == 60);
+}
@@ -0,0 +1,110 @@
+#include "catch.hpp"
+
+#include <osmium/index/id_set.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Basic functionality of ConcurrentIdSetDense") {
+    osmium::index::ConcurrentIdSetDense<osmium::unsigned_object_id_type> s;
+
+    REQUIRE_FALSE(s.get(17));
+    REQUIRE(s.empty());
+    REQUIRE(s.size() == 0); // NOLINT(readability-container-size-empty)
+
+    REQUIRE(s.check_and_set(17));
+    REQUIRE_FALSE(s.check_and_set(17));
+    s.set(28);
+    s.set(1ULL << 38U);
+    REQUIRE(s.get(17));
+    REQUIRE(s.get(28));
+    REQUIRE(s.get(1ULL << 38U));
+    REQUIRE_FALSE(s.get(29));
+    REQUIRE_FALSE(s.empty());
+    REQUIRE(s.size() == 3);
+
+    s.unset(17);
+    REQUIRE_FALSE(s.get(17));
+    REQUIRE(s.size() == 2);
+
+    const auto ids = {28ULL, 1ULL << 38U};
+    REQUIRE(std::equal(s.begin(), s.end(), ids.begin()));
+
+    s.clear();
+    REQUIRE(s.empty());
+}
+
+TEST_CASE("ConcurrentIdSetDense with maximum Id") {
+    osmium::index::ConcurrentIdSetDense<osmium::unsigned_object_id_type> s{1000};
+
+    s.set(1000);
+    REQUIRE(s.get(1000));
+    REQUIRE_FALSE(s.get(1ULL << 40U));
+    REQUIRE_THROWS_AS(s.set(1ULL << 40U), std::out_of_range);
+}
+
+TEST_CASE("Fill ConcurrentIdSetDense from several threads") {
+    osmium::index::ConcurrentIdSetDense<osmium::unsigned_object_id_type> s;
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < 4; ++t) {
+        threads.emplace_back([&s, t]() {
+            for (osmium::unsigned_object_id_type id = t; id < 200000; id += 3) {
+                s.set(id * 1000);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(s.size() == 200000);
+    osmium::unsigned_object_id_type expected = 0;
+    for (const auto id : s) {
+        REQUIRE(id == expected);
+        expected += 1000;
+    }
+    REQUIRE(expected == 200000 * 1000);
+}
+
+TEST_CASE("Merge IdSetSmall into ConcurrentIdSetDense") {
+    osmium::index::ConcurrentIdSetDense<osmium::unsigned_object_id_type> s;
+
+    osmium::index::IdSetSmall<osmium::unsigned_object_id_type> s1;
+    s1.set(23);
+    s1.set(2);
+
+    osmium::index::IdSetSmall<osmium::unsigned_object_id_type> s2;
+    s2.set(2);
+    s2.set(1ULL << 30U);
+
+    s.merge(s1);
+    s.merge(s2);
+
+    REQUIRE(s.size() == 3);
+    const auto ids = {2ULL, 23ULL, 1ULL << 30U};
+    REQUIRE(std::equal(s.begin(), s.end(), ids.begin()));
+}
+
+TEST_CASE("ConcurrentIdSetDense with 32 bit Ids") {
+    osmium::index::ConcurrentIdSetDense<uint32_t> s;
+
+    REQUIRE(s.empty());
+
+    s.set(17);
+    s.set(std::numeric_limits<uint32_t>::max());
+    REQUIRE(s.get(17));
+    REQUIRE(s.get(std::numeric_limits<uint32_t>::max()));
+    REQUIRE(s.size() == 2);
+    REQUIRE_FALSE(s.empty());
+
+    const std::vector<uint32_t> ids = {17, std::numeric_limits<uint32_t>::max()};
+    REQUIRE(std::distance(s.begin(), s.end()) == 2);
+    REQUIRE(std::equal(s.begin(), s.end(), ids.begin()));
+}
@@ -3,6 +3,9 @@
 #include <osmium/index/id_set.hpp>
 #include <osmium/osm/types.hpp>
 
+#include <algorithm>
+#include <vector>
+
 TEST_CASE("Basic functionality of IdSetDense") {
     osmium::index::IdSetDense<osmium::unsigned_object_id_type> s;
 
@@ -252,3 +255,40 @@ TEST_CASE("Merge two IdSetSmall") {
     REQUIRE(std::equal(s1.cbegin(), s1.cend(), ids.begin()));
 }
 
+TEST_CASE("Set operations on IdSetDense") {
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> s1;
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> s2;
+
+    for (osmium::unsigned_object_id_type id = 0; id < 100000; id += 7) {
+        s1.set(id);
+    }
+    s1.set(1ULL << 32U);
+    for (osmium::unsigned_object_id_type id = 50000; id < 200000; id += 2) {
+        s2.set(id);
+    }
+    s2.set(1ULL << 34U);
+
+    std::vector<osmium::unsigned_object_id_type> expected;
+
+    SECTION("union") {
+        std::set_union(s1.begin(), s1.end(), s2.begin(), s2.end(), std::back_inserter(expected));
+        s1 |= s2;
+        REQUIRE(s1.size() == expected.size());
+        REQUIRE(std::equal(s1.begin(), s1.end(), expected.begin()));
+    }
+
+    SECTION("intersection") {
+        std::set_intersection(s1.begin(), s1.end(), s2.begin(), s2.end(), std::back_inserter(expected));
+        const auto s = s1 & s2;
+        REQUIRE(s.size() == expected.size());
+        REQUIRE(std::equal(s.begin(), s.end(), expected.begin()));
+    }
+
+    SECTION("difference") {
+        std::set_difference(s1.begin(), s1.end(), s2.begin(), s2.end(), std::back_inserter(expected));
+        const auto s = s1 - s2;
+        REQUIRE(s.size() == expected.size());
+        REQUIRE(std::equal(s.begin(), s.end(), expected.begin()));
+        REQUIRE(s.get(1ULL << 32U));
+    }
+}
@@ -0,0 +1,342 @@
+#include "catch.hpp"
+
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/index/id_set_compressed.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/util/file.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using id_set_type = osmium::index::IdSetCompressed<osmium::unsigned_object_id_type>;
+
+TEST_CASE("Basic functionality of IdSetCompressed") {
+    id_set_type s;
+
+    REQUIRE_FALSE(s.get(17));
+    REQUIRE(s.empty());
+    REQUIRE(s.size() == 0); // NOLINT(readability-container-size-empty)
+    REQUIRE(s.begin() == s.end());
+
+    REQUIRE(s.check_and_set(17));
+    REQUIRE_FALSE(s.check_and_set(17));
+    s.set(28);
+    s.set(12000000000ULL);
+    REQUIRE(s.get(17));
+    REQUIRE(s.get(28));
+    REQUIRE(s.get(12000000000ULL));
+    REQUIRE_FALSE(s.get(29));
+    REQUIRE_FALSE(s.get(12000000001ULL));
+    REQUIRE(s.size() == 3);
+
+    s.unset(17);
+    s.unset(18);
+    REQUIRE_FALSE(s.get(17));
+    REQUIRE(s.size() == 2);
+
+    const auto ids = {28ULL, 12000000000ULL};
+    REQUIRE(std::equal(s.begin(), s.end(), ids.begin()));
+
+    s.clear();
+    REQUIRE(s.empty());
+}
+
+TEST_CASE("IdSetCompressed with different container types") {
+    id_set_type s;
+    std::set<osmium::unsigned_object_id_type> ref;
+
+    // sparse block (array container)
+    for (osmium::unsigned_object_id_type id = 0; id < 65536; id += 100) {
+        s.set(id);
+        ref.insert(id);
+    }
+    // dense block (bitmap container)
+    for (osmium::unsigned_object_id_type id = 65536; id < 2 * 65536; id += 3) {
+        s.set(id);
+        ref.insert(id);
+    }
+    // clustered block (becomes run container)
+    for (osmium::unsigned_object_id_type id = 5 * 65536 + 10; id < 5 * 65536 + 20000; ++id) {
+        s.set(id);
+        ref.insert(id);
+    }
+
+    REQUIRE(s.size() == ref.size());
+    REQUIRE(std::equal(s.begin(), s.end(), ref.begin()));
+
+    const auto memory_before = s.used_memory();
+    s.optimize();
+    REQUIRE(s.used_memory() < memory_before);
+    REQUIRE(s.size() == ref.size());
+    REQUIRE(std::equal(s.begin(), s.end(), ref.begin()));
+    REQUIRE(s.get(5 * 65536 + 100));
+    REQUIRE_FALSE(s.get(5 * 65536 + 9));
+
+    // changing optimized container
+    s.unset(5 * 65536 + 100);
+    s.set(5 * 65536 + 5);
+    REQUIRE_FALSE(s.get(5 * 65536 + 100));
+    REQUIRE(s.get(5 * 65536 + 5));
+    REQUIRE(s.size() == ref.size());
+}
+
+TEST_CASE("Set operations on IdSetCompressed") {
+    id_set_type s1;
+    id_set_type s2;
+    std::set<osmium::unsigned_object_id_type> r1;
+    std::set<osmium::unsigned_object_id_type> r2;
+
+    for (osmium::unsigned_object_id_type id = 0; id < 300000; id += 7) {
+        s1.set(id);
+        r1.insert(id);
+    }
+    for (osmium::unsigned_object_id_type id = 100000; id < 500000; id += 2) {
+        s2.set(id);
+        r2.insert(id);
+    }
+    for (osmium::unsigned_object_id_type id = 1000000; id < 1000100; ++id) {
+        s2.set(id);
+        r2.insert(id);
+    }
+    s2.optimize();
+
+    std::vector<osmium::unsigned_object_id_type> expected;
+
+    SECTION("union") {
+        std::set_union(r1.begin(), r1.end(), r2.begin(), r2.end(), std::back_inserter(expected));
+        const auto result = s1 | s2;
+        REQUIRE(result.size() == expected.size());
+        REQUIRE(std::equal(result.begin(), result.end(), expected.begin()));
+    }
+
+    SECTION("intersection") {
+        std::set_intersection(r1.begin(), r1.end(), r2.begin(), r2.end(), std::back_inserter(expected));
+        const auto result = s1 & s2;
+        REQUIRE(result.size() == expected.size());
+        REQUIRE(std::equal(result.begin(), result.end(), expected.begin()));
+    }
+
+    SECTION("difference") {
+        std::set_difference(r2.begin(), r2.end(), r1.begin(), r1.end(), std::back_inserter(expected));
+        const auto result = s2 - s1;
+        REQUIRE(result.size() == expected.size());
+        REQUIRE(std::equal(result.begin(), result.end(), expected.begin()));
+    }
+}
+
+TEST_CASE("Dump and load IdSetCompressed") {
+    id_set_type s;
+    for (osmium::unsigned_object_id_type id = 0; id < 300000; id += 7) {
+        s.set(id);
+    }
+    for (osmium::unsigned_object_id_type id = 1000000; id < 1000100; ++id) {
+        s.set(id);
+    }
+    s.optimize();
+
+    const int fd = osmium::detail::create_tmp_file();
+    s.dump(fd);
+    REQUIRE(osmium::file_size(fd) > 0);
+    osmium::file_seek(fd, 0);
+
+    id_set_type s2;
+    s2.set(5);
+    s2.load(fd);
+
+    REQUIRE(s2.size() == s.size());
+    REQUIRE(std::equal(s.begin(), s.end(), s2.begin()));
+    REQUIRE_FALSE(s2.get(5));
+}
+
+TEST_CASE("Deserialize invalid IdSetCompressed data") {
+    id_set_type s;
+    REQUIRE_THROWS_AS(s.deserialize("foo"), std::runtime_error);
+
+    s.set(17);
+    auto data = s.serialize();
+    data.resize(data.size() - 1);
+    REQUIRE_THROWS_AS(s.deserialize(data), std::runtime_error);
+}
+
+namespace {
+
+    // Build serialized IdSetCompressed data by hand.
+    class serialized_set {
+
+        std::string m_data{"OSMIDSC1"};
+        uint64_t m_num_blocks = 0;
+        std::string m_blocks;
+
+        template <typename TValue>
+        static void append(std::string& out, TValue value) {
+            out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+    public:
+
+        serialized_set& block(uint64_t key, uint32_t type, uint32_t cardinality, uint32_t size) {
+            ++m_num_blocks;
+            append(m_blocks, key);
+            append(m_blocks, type);
+            append(m_blocks, cardinality);
+            append(m_blocks, size);
+            return *this;
+        }
+
+        template <typename TValue>
+        serialized_set& value(TValue value) {
+            append(m_blocks, value);
+            return *this;
+        }
+
+        std::string data(uint64_t num_blocks) const {
+            std::string out{m_data};
+            append(out, static_cast<uint32_t>(0x01020304U));
+            append(out, num_blocks);
+            return out + m_blocks;
+        }
+
+        std::string data() const {
+            return data(m_num_blocks);
+        }
+
+    }; // class serialized_set
+
+    enum : uint32_t {
+        array_type  = 0,
+        bitmap_type = 1,
+        run_type    = 2
+    };
+
+    void add_run(serialized_set& set, uint16_t start, uint16_t length) {
+        set.value(start).value(length);
+    }
+
+} // anonymous namespace
+
+TEST_CASE("Deserialize hand made IdSetCompressed data") {
+    serialized_set data;
+    data.block(0, array_type, 2, 2).value<uint16_t>(3).value<uint16_t>(7);
+    data.block(2, run_type, 5, 1);
+    add_run(data, 10, 4);
+
+    id_set_type s;
+    s.deserialize(data.data());
+    REQUIRE(s.size() == 7);
+    REQUIRE(s.get(3));
+    REQUIRE(s.get(7));
+    REQUIRE(s.get((2UL << 16U) + 10));
+    REQUIRE(s.get((2UL << 16U) + 14));
+    REQUIRE_FALSE(s.get((2UL << 16U) + 15));
+}
+
+TEST_CASE("Deserialize IdSetCompressed data with invalid runs") {
+    serialized_set data;
+
+    SECTION("run reaching past end of block") {
+        data.block(0, run_type, 0x20, 1);
+        add_run(data, 0xfff0, 0x1f);
+    }
+
+    SECTION("overlapping runs") {
+        data.block(0, run_type, 10, 2);
+        add_run(data, 10, 5);
+        add_run(data, 12, 3);
+    }
+
+    SECTION("touching runs") {
+        data.block(0, run_type, 8, 2);
+        add_run(data, 10, 5);
+        add_run(data, 16, 1);
+    }
+
+    SECTION("unsorted runs") {
+        data.block(0, run_type, 4, 2);
+        add_run(data, 100, 1);
+        add_run(data, 10, 1);
+    }
+
+    SECTION("no runs") {
+        data.block(0, run_type, 0, 0);
+    }
+
+    SECTION("too many runs") {
+        data.block(0, run_type, 0, 0xffffffffU);
+    }
+
+    id_set_type s;
+    REQUIRE_THROWS_AS(s.deserialize(data.data()), std::runtime_error);
+}
+
+TEST_CASE("Deserialize IdSetCompressed data with invalid containers") {
+    serialized_set data;
+
+    SECTION("unsorted array") {
+        data.block(0, array_type, 2, 2).value<uint16_t>(7).value<uint16_t>(3);
+    }
+
+    SECTION("duplicate values in array") {
+        data.block(0, array_type, 2, 2).value<uint16_t>(7).value<uint16_t>(7);
+    }
+
+    SECTION("empty array") {
+        data.block(0, array_type, 0, 0);
+    }
+
+    SECTION("array too large") {
+        data.block(0, array_type, 4097, 4097);
+        for (uint16_t value = 0; value < 4097; ++value) {
+            data.value(value);
+        }
+    }
+
+    SECTION("huge array size") {
+        data.block(0, array_type, 0xffffffffU, 0xffffffffU);
+    }
+
+    SECTION("wrong cardinality") {
+        data.block(0, array_type, 3, 2).value<uint16_t>(3).value<uint16_t>(7);
+    }
+
+    SECTION("bitmap with few values") {
+        data.block(0, bitmap_type, 1, 1024).value<uint64_t>(1);
+        for (int i = 1; i < 1024; ++i) {
+            data.value<uint64_t>(0);
+        }
+    }
+
+    id_set_type s;
+    REQUIRE_THROWS_AS(s.deserialize(data.data()), std::runtime_error);
+}
+
+TEST_CASE("Deserialize IdSetCompressed data with invalid blocks") {
+    serialized_set data;
+    data.block(5, array_type, 1, 1).value<uint16_t>(1);
+
+    SECTION("duplicate block key") {
+        data.block(5, array_type, 1, 1).value<uint16_t>(2);
+        id_set_type s;
+        REQUIRE_THROWS_AS(s.deserialize(data.data()), std::runtime_error);
+    }
+
+    SECTION("unsorted block keys") {
+        data.block(3, array_type, 1, 1).value<uint16_t>(2);
+        id_set_type s;
+        REQUIRE_THROWS_AS(s.deserialize(data.data()), std::runtime_error);
+    }
+
+    SECTION("block key too large") {
+        osmium::index::IdSetCompressed<uint32_t> s;
+        data.block(0x10000, array_type, 1, 1).value<uint16_t>(2);
+        REQUIRE_THROWS_AS(s.deserialize(data.data()), std::runtime_error);
+    }
+
+    SECTION("too many blocks") {
+        id_set_type s;
+        REQUIRE_THROWS_AS(s.deserialize(data.data(0xffffffffffffffffULL)), std::runtime_error);
+    }
+}
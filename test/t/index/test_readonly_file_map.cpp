@@ -0,0 +1,136 @@
+#include "catch.hpp"
+
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/index/map/dense_mem_array.hpp>
+#include <osmium/index/map/readonly_file_map.hpp>
+#include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/index/node_locations_map.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/util/file.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+
+using id_type = osmium::unsigned_object_id_type;
+using readonly_map_type = osmium::index::map::ReadOnlyFileMap<id_type, osmium::Location>;
+
+template <typename TMap>
+void fill_map(TMap& map) {
+    map.set(17, osmium::Location{1.2, 4.5});
+    map.set(3, osmium::Location{3.5, -7.2});
+    map.set(10, osmium::Location{-2.0, 1.0});
+}
+
+void check_map(const readonly_map_type& map) {
+    REQUIRE(map.get(17) == (osmium::Location{1.2, 4.5}));
+    REQUIRE(map.get(3) == (osmium::Location{3.5, -7.2}));
+    REQUIRE(map.get(10) == (osmium::Location{-2.0, 1.0}));
+
+    REQUIRE_THROWS_AS(map.get(0), osmium::not_found);
+    REQUIRE_THROWS_AS(map.get(4), osmium::not_found);
+    REQUIRE_THROWS_AS(map.get(18), osmium::not_found);
+    REQUIRE_THROWS_AS(map.get(1000), osmium::not_found);
+
+    REQUIRE(map.get_noexcept(18) == osmium::Location{});
+    REQUIRE(map.get_noexcept(1000) == osmium::Location{});
+}
+
+TEST_CASE("Write dense index file and read it back") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    osmium::index::map::DenseMemArray<id_type, osmium::Location> map;
+    fill_map(map);
+    osmium::index::map::write_index_file(map, fd, osmium::index::index_file_layout::dense);
+
+    REQUIRE(osmium::file_size(fd) == 64 + 18 * sizeof(osmium::Location));
+
+    readonly_map_type ro_map{fd};
+    REQUIRE(ro_map.layout() == osmium::index::index_file_layout::dense);
+    REQUIRE(ro_map.size() == 18);
+    check_map(ro_map);
+
+    REQUIRE_THROWS(ro_map.set(1, osmium::Location{}));
+
+    ro_map.clear();
+    REQUIRE(ro_map.size() == 0); // NOLINT(readability-container-size-empty)
+}
+
+TEST_CASE("Write sparse index file and read it back") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    osmium::index::map::SparseMemArray<id_type, osmium::Location> map;
+    fill_map(map);
+    osmium::index::map::write_index_file(map, fd, osmium::index::index_file_layout::sparse);
+
+    readonly_map_type ro_map{fd};
+    REQUIRE(ro_map.layout() == osmium::index::index_file_layout::sparse);
+    REQUIRE(ro_map.size() == 3);
+    check_map(ro_map);
+}
+
+TEST_CASE("Several read-only maps can share the same index file") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    osmium::index::map::SparseMemArray<id_type, osmium::Location> map;
+    fill_map(map);
+    osmium::index::map::write_index_file(map, fd, osmium::index::index_file_layout::sparse);
+
+    const readonly_map_type ro_map1{fd};
+    const readonly_map_type ro_map2{fd};
+    check_map(ro_map1);
+    check_map(ro_map2);
+}
+
+TEST_CASE("Opening a read-only map from a file without valid header fails") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    SECTION("empty file") {
+        REQUIRE_THROWS_AS(readonly_map_type{fd}, osmium::index_file_error);
+    }
+
+    SECTION("wrong magic") {
+        const std::string data(100, 'x');
+        osmium::io::detail::reliable_write(fd, data.data(), data.size());
+        REQUIRE_THROWS_AS(readonly_map_type{fd}, osmium::index_file_error);
+    }
+
+    SECTION("wrong value type") {
+        osmium::index::map::DenseMemArray<id_type, uint32_t> map;
+        map.set(1, 42);
+        osmium::index::map::write_index_file(map, fd, osmium::index::index_file_layout::dense);
+        REQUIRE_THROWS_AS(readonly_map_type{fd}, osmium::index_file_error);
+    }
+
+    SECTION("element count in header too large") {
+        osmium::index::map::DenseMemArray<id_type, osmium::Location> map;
+        fill_map(map);
+        osmium::index::map::write_index_file(map, fd, osmium::index::index_file_layout::dense);
+
+        // count * element_size overflows to 8
+        const uint64_t count = (1ULL << 61U) + 1;
+        osmium::file_seek(fd, offsetof(osmium::index::detail::index_file_header, count));
+        osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&count), sizeof(count));
+        REQUIRE_THROWS_AS(readonly_map_type{fd}, osmium::index_file_error);
+    }
+}
+
+TEST_CASE("Read-only index file map is available through map factory") {
+    const auto& map_factory = osmium::index::MapFactory<id_type, osmium::Location>::instance();
+    REQUIRE(map_factory.has_map_type("readonly_file_map"));
+    REQUIRE_THROWS_AS(map_factory.create_map("readonly_file_map"), osmium::map_factory_error);
+    REQUIRE_THROWS_AS(map_factory.create_map("readonly_file_map,-"), osmium::map_factory_error);
+    REQUIRE_THROWS_AS(map_factory.create_map("readonly_file_map,test-readonly-file-map-missing.idx"), std::system_error);
+
+    const int fd = osmium::io::detail::open_for_writing("test-readonly-file-map.idx", osmium::io::overwrite::allow);
+    osmium::index::map::SparseMemArray<id_type, osmium::Location> map;
+    fill_map(map);
+    osmium::index::map::write_index_file(map, fd, osmium::index::index_file_layout::sparse);
+    osmium::io::detail::reliable_close(fd);
+
+    const auto ro_map = map_factory.create_map("readonly_file_map,test-readonly-file-map.idx");
+    REQUIRE(ro_map->size() == 3);
+    REQUIRE(ro_map->get(17) == (osmium::Location{1.2, 4.5}));
+}
@@ -0,0 +1,57 @@
+#include "catch.hpp"
+
+#include <osmium/index/parallel_sort.hpp>
+#include <osmium/index/relations_map.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <future>
+#include <utility>
+#include <vector>
+
+TEST_CASE("RelationsMapStash filled in several threads") {
+    osmium::thread::Pool pool{4};
+
+    // Relation r has members r+1 and r/2.
+    const osmium::unsigned_object_id_type num_relations = 200000;
+    std::vector<osmium::index::RelationsMapStash> stashes(4);
+    std::vector<std::future<void>> futures;
+    for (std::size_t n = 0; n < stashes.size(); ++n) {
+        futures.push_back(pool.submit([&stashes, n, num_relations]() {
+            for (osmium::unsigned_object_id_type r = n + 1; r <= num_relations; r += 4) {
+                stashes[n].add(r + 1, r);
+                stashes[n].add(r / 2, r);
+            }
+        }));
+    }
+    for (auto& future : futures) {
+        future.get();
+    }
+
+    osmium::index::RelationsMapStash stash;
+    stash.merge(std::move(stashes[0]));
+    stashes.erase(stashes.begin());
+    stash.merge(stashes);
+    REQUIRE(stash.size() == 2 * num_relations);
+    REQUIRE(stashes[0].empty());
+
+    const auto index = stash.build_indexes(pool);
+    REQUIRE(index.size() == 2 * num_relations);
+
+    std::vector<osmium::unsigned_object_id_type> ids;
+    index.member_to_parent().for_each(1001, [&](osmium::unsigned_object_id_type id) {
+        ids.push_back(id);
+    });
+    REQUIRE(ids == std::vector<osmium::unsigned_object_id_type>({1000, 2002, 2003}));
+
+    ids.clear();
+    index.member_to_parent().for_each(1000, [&](osmium::unsigned_object_id_type id) {
+        ids.push_back(id);
+    });
+    REQUIRE(ids == std::vector<osmium::unsigned_object_id_type>({999, 2000, 2001}));
+
+    ids.clear();
+    index.parent_to_member().for_each(1000, [&](osmium::unsigned_object_id_type id) {
+        ids.push_back(id);
+    });
+    REQUIRE(ids == std::vector<osmium::unsigned_object_id_type>({500, 1001}));
+}
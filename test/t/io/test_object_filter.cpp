@@ -0,0 +1,112 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/object_filter.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/tags/tags_filter.hpp>
+
+#include <stdexcept>
+
+TEST_CASE("Empty object filter keeps everything") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024};
+    const auto pos = osmium::builder::add_node(buffer, _id(1));
+
+    const osmium::io::object_filter filter;
+    REQUIRE(filter.empty());
+    REQUIRE(filter(buffer.get<osmium::Node>(pos)));
+    REQUIRE(filter.id_matches(osmium::osm_entity_bits::way, 17));
+    REQUIRE(filter.location_matches(osmium::Location{}));
+    REQUIRE(filter.tags_rules(osmium::osm_entity_bits::node) == 0);
+}
+
+TEST_CASE("Object filter") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{10240};
+    const auto pos_n1 = osmium::builder::add_node(buffer, _id(1), _location(1.0, 1.0), _tag("amenity", "pub"));
+    const auto pos_n2 = osmium::builder::add_node(buffer, _id(2), _location(2.0, 2.0), _tag("amenity", "post_box"));
+    const auto pos_n3 = osmium::builder::add_node(buffer, _id(3));
+    const auto pos_w1 = osmium::builder::add_way(buffer, _id(1), _tag("highway", "primary"), _tag("name", "Main Street"));
+    const auto pos_w2 = osmium::builder::add_way(buffer, _id(2), _tag("building", "yes"));
+
+    const auto& n1 = buffer.get<osmium::Node>(pos_n1);
+    const auto& n2 = buffer.get<osmium::Node>(pos_n2);
+    const auto& n3 = buffer.get<osmium::Node>(pos_n3);
+    const auto& w1 = buffer.get<osmium::Way>(pos_w1);
+    const auto& w2 = buffer.get<osmium::Way>(pos_w2);
+
+    osmium::io::object_filter filter;
+
+    SECTION("tags") {
+        osmium::TagsFilter pubs{false};
+        pubs.add_rule(true, "amenity", "pub");
+        pubs.add_rule(true, "highway");
+        filter.tags(pubs);
+        REQUIRE_FALSE(filter.empty());
+        REQUIRE(filter.tags_rules(osmium::osm_entity_bits::node) == 1);
+        REQUIRE(filter(n1));
+        REQUIRE_FALSE(filter(n2));
+        REQUIRE_FALSE(filter(n3));
+        REQUIRE(filter(w1));
+        REQUIRE_FALSE(filter(w2));
+
+        osmium::TagsFilter names{false};
+        names.add_rule(true, "name");
+        filter.tags(names, osmium::osm_entity_bits::way);
+        REQUIRE(filter.tags_rules(osmium::osm_entity_bits::node) == 1);
+        REQUIRE(filter.tags_rules(osmium::osm_entity_bits::way) == 3);
+        REQUIRE(filter.tag_matches(3, "name", "x") == 2);
+        REQUIRE(filter(n1));
+        REQUIRE(filter(w1));
+    }
+
+    SECTION("too many tags filters") {
+        for (int i = 0; i < osmium::io::object_filter::max_tags_filters; ++i) {
+            filter.tags(osmium::TagsFilter{true});
+        }
+        REQUIRE_THROWS_AS(filter.tags(osmium::TagsFilter{true}), std::length_error);
+    }
+
+    SECTION("ids") {
+        filter.ids(osmium::osm_entity_bits::node, 2, 3);
+        REQUIRE_FALSE(filter.empty());
+        REQUIRE_FALSE(filter(n1));
+        REQUIRE(filter(n2));
+        REQUIRE(filter(n3));
+        REQUIRE(filter(w1));
+        REQUIRE(filter(w2));
+
+        filter.ids(osmium::osm_entity_bits::node | osmium::osm_entity_bits::way, 1, 1);
+        REQUIRE(filter(n1));
+        REQUIRE(filter(w1));
+        REQUIRE_FALSE(filter(w2));
+    }
+
+    SECTION("bbox") {
+        filter.bbox(osmium::Box{0.5, 0.5, 1.5, 1.5});
+        REQUIRE_FALSE(filter.empty());
+        REQUIRE(filter(n1));
+        REQUIRE_FALSE(filter(n2));
+        REQUIRE_FALSE(filter(n3));
+        REQUIRE(filter(w1));
+        REQUIRE(filter(w2));
+    }
+
+    SECTION("predicate") {
+        filter.predicate([](const osmium::OSMObject& object) {
+            return object.tags().has_key("name");
+        }, osmium::osm_entity_bits::way);
+        REQUIRE_FALSE(filter.empty());
+        REQUIRE(filter(n1));
+        REQUIRE(filter(w1));
+        REQUIRE_FALSE(filter(w2));
+
+        filter.predicate(nullptr);
+        REQUIRE(filter.empty());
+    }
+}
@@ -2,8 +2,12 @@
 
 #include "utils.hpp"
 
+#include <osmium/io/object_filter.hpp>
 #include <osmium/io/pbf_input.hpp>
 #include <osmium/io/reader.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/node_batch.hpp>
 #include <osmium/osm/object.hpp>
 
 TEST_CASE("Get supported PBF compression types") {
@@ -50,3 +54,81 @@ TEST_CASE("Read PBF file with version=-1 and changeset=-1 and DenseNodes (writte
     REQUIRE(object.version() == 0);
     REQUIRE(object.changeset() == 0);
 }
+
+TEST_CASE("Read PBF file with DenseNodes as node batches") {
+    osmium::io::Reader reader{with_data_dir("t/io/data_pbf_version-1-densenodes.osm.pbf"), osmium::io::node_batch_mode::locations};
+
+    std::size_t batches = 0;
+    while (const osmium::memory::Buffer buffer = reader.read()) {
+        REQUIRE(buffer.select<osmium::OSMObject>().empty());
+        for (const auto& batch : buffer.select<osmium::NodeBatch>()) {
+            ++batches;
+            REQUIRE(batch.size() == 1);
+            REQUIRE_FALSE(batch.has_tags());
+            REQUIRE(batch.id(0) == 2);
+            REQUIRE(batch.location(0) == osmium::Location(10.01, 50.0));
+        }
+    }
+    reader.close();
+
+    REQUIRE(batches == 1);
+}
+
+std::size_t count_nodes_with_filter(const osmium::io::object_filter& filter) {
+    std::size_t count = 0;
+    for (const char* filename : {"t/io/data_pbf_version-1.osm.pbf", "t/io/data_pbf_version-1-densenodes.osm.pbf"}) {
+        const osmium::memory::Buffer buffer = osmium::io::read_file(with_data_dir(filename), filter);
+        count += buffer.select<osmium::Node>().size();
+    }
+    return count;
+}
+
+TEST_CASE("Read PBF file with object filter") {
+    osmium::io::object_filter filter;
+
+    SECTION("id range matches") {
+        filter.ids(osmium::osm_entity_bits::node, 1, 2);
+        REQUIRE(count_nodes_with_filter(filter) == 2);
+    }
+
+    SECTION("id range doesn't match") {
+        filter.ids(osmium::osm_entity_bits::node, 3, 10);
+        REQUIRE(count_nodes_with_filter(filter) == 0);
+    }
+
+    SECTION("id range for other entity type") {
+        filter.ids(osmium::osm_entity_bits::way, 3, 10);
+        REQUIRE(count_nodes_with_filter(filter) == 2);
+    }
+
+    SECTION("bbox") {
+        filter.bbox(osmium::Box{10.0, 49.0, 11.0, 51.0});
+        REQUIRE(count_nodes_with_filter(filter) == 2);
+
+        filter.bbox(osmium::Box{10.1, 49.0, 11.0, 51.0});
+        REQUIRE(count_nodes_with_filter(filter) == 0);
+    }
+
+    SECTION("node without tags doesn't match tags filter") {
+        filter.tags(osmium::TagsFilter{true}, osmium::osm_entity_bits::node);
+        REQUIRE(count_nodes_with_filter(filter) == 0);
+    }
+
+    SECTION("predicate") {
+        filter.predicate([](const osmium::OSMObject& object) {
+            return object.id() != 2;
+        });
+        REQUIRE(count_nodes_with_filter(filter) == 0);
+    }
+}
+
+TEST_CASE("Read PBF file with DenseNodes as node batches with object filter") {
+    osmium::io::object_filter filter;
+    filter.ids(osmium::osm_entity_bits::node, 3, 10);
+    osmium::io::Reader reader{with_data_dir("t/io/data_pbf_version-1-densenodes.osm.pbf"), osmium::io::node_batch_mode::locations, filter};
+
+    while (const osmium::memory::Buffer buffer = reader.read()) {
+        REQUIRE(buffer.select<osmium::NodeBatch>().empty());
+    }
+    reader.close();
+}
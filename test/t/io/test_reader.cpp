@@ -5,7 +5,9 @@
 #include <osmium/handler.hpp>
 #include <osmium/io/any_compression.hpp>
 #include <osmium/io/any_input.hpp>
+#include <osmium/io/object_filter.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/osm/box.hpp>
 #include <osmium/visitor.hpp>
 
 #include <iterator>
@@ -378,3 +380,134 @@ TEST_CASE("Reader with single object type per buffer") {
     check_buffer_counts("t/io/data-n5w1r0", {{5, 0, 0}, {0, 1, 0}}, osmium::io::buffers_type::single);
 }
 
+TEST_CASE("Reader skipping tags of some entity types") {
+    for (const auto* suffix : {".osm", ".osm.o5m"}) {
+        const osmium::io::File file{with_data_dir((std::string{"t/io/data-n5w1r3"} + suffix).c_str())};
+        const auto buffer = osmium::io::read_file(file, osmium::io::read_tags{}.skip(osmium::osm_entity_bits::way));
+
+        for (const auto& way : buffer.select<osmium::Way>()) {
+            REQUIRE(way.tags().empty());
+            REQUIRE(way.nodes().size() == 2);
+        }
+        for (const auto& relation : buffer.select<osmium::Relation>()) {
+            REQUIRE(relation.tags().size() == 1);
+        }
+    }
+}
+
+TEST_CASE("Reader filtering tags by key") {
+    for (const auto* suffix : {".osm", ".osm.o5m"}) {
+        const osmium::io::File file{with_data_dir((std::string{"t/io/data-n5w1r3"} + suffix).c_str())};
+        const auto buffer = osmium::io::read_file(file, osmium::io::read_tags{}.filter({"type"}));
+
+        for (const auto& way : buffer.select<osmium::Way>()) {
+            REQUIRE(way.tags().empty());
+        }
+        std::vector<std::size_t> tag_counts;
+        for (const auto& relation : buffer.select<osmium::Relation>()) {
+            tag_counts.push_back(relation.tags().size());
+            if (relation.id() == 31) {
+                REQUIRE(std::string{relation.tags().get_value_by_key("type", "")} == "restriction");
+            }
+        }
+        REQUIRE(tag_counts == std::vector<std::size_t>{1, 1, 0});
+    }
+}
+
+TEST_CASE("Reader without relation members") {
+    for (const auto* suffix : {".osm", ".osm.o5m"}) {
+        const osmium::io::File file{with_data_dir((std::string{"t/io/data-n5w1r3"} + suffix).c_str())};
+        const auto buffer = osmium::io::read_file(file, osmium::io::read_members::no);
+
+        int count = 0;
+        for (const auto& relation : buffer.select<osmium::Relation>()) {
+            REQUIRE(relation.members().empty());
+            REQUIRE(relation.tags().size() == 1);
+            ++count;
+        }
+        REQUIRE(count == 3);
+    }
+}
+
+std::vector<osmium::object_id_type> read_ids_with_filter(const char* suffix, const osmium::io::object_filter& filter) {
+    const osmium::io::File file{with_data_dir((std::string{"t/io/data-n5w1r3"} + suffix).c_str())};
+    const auto buffer = osmium::io::read_file(file, filter);
+
+    std::vector<osmium::object_id_type> ids;
+    for (const auto& object : buffer.select<osmium::OSMObject>()) {
+        ids.push_back(object.id());
+    }
+    return ids;
+}
+
+TEST_CASE("Reader with object filter") {
+    osmium::io::object_filter filter;
+
+    SECTION("empty filter keeps everything") {
+        const std::vector<osmium::object_id_type> expected = {10, 11, 12, 13, 14, 20, 30, 31, 32};
+        for (const auto* suffix : {".osm", ".osm.o5m", ".osm.opl"}) {
+            REQUIRE(read_ids_with_filter(suffix, filter) == expected);
+        }
+    }
+
+    SECTION("tags filter") {
+        osmium::TagsFilter types{false};
+        types.add_rule(true, "type");
+        filter.tags(types, osmium::osm_entity_bits::relation);
+        const std::vector<osmium::object_id_type> expected = {10, 11, 12, 13, 14, 20, 30, 31};
+        for (const auto* suffix : {".osm", ".osm.o5m", ".osm.opl"}) {
+            REQUIRE(read_ids_with_filter(suffix, filter) == expected);
+        }
+    }
+
+    SECTION("all tags filters have to match") {
+        osmium::TagsFilter types{false};
+        types.add_rule(true, "type");
+        osmium::TagsFilter restrictions{false};
+        restrictions.add_rule(true, "type", "restriction");
+        filter.tags(types).tags(restrictions);
+        const std::vector<osmium::object_id_type> expected = {31};
+        for (const auto* suffix : {".osm", ".osm.o5m", ".osm.opl"}) {
+            REQUIRE(read_ids_with_filter(suffix, filter) == expected);
+        }
+    }
+
+    SECTION("tags filter sees tags after read_tags") {
+        osmium::TagsFilter highways{false};
+        highways.add_rule(true, "highway");
+        filter.tags(highways, osmium::osm_entity_bits::way);
+        for (const auto* suffix : {".osm", ".osm.o5m"}) {
+            const osmium::io::File file{with_data_dir((std::string{"t/io/data-n5w1r3"} + suffix).c_str())};
+            const auto buffer = osmium::io::read_file(file, filter, osmium::io::read_tags{}.skip(osmium::osm_entity_bits::way));
+            REQUIRE(buffer.select<osmium::Way>().empty());
+            REQUIRE(buffer.select<osmium::Node>().size() == 5);
+        }
+    }
+
+    SECTION("id ranges") {
+        filter.ids(osmium::osm_entity_bits::node, 11, 12).ids(osmium::osm_entity_bits::node, 14, 100);
+        filter.ids(osmium::osm_entity_bits::relation, 32, 32);
+        const std::vector<osmium::object_id_type> expected = {11, 12, 14, 20, 32};
+        for (const auto* suffix : {".osm", ".osm.o5m", ".osm.opl"}) {
+            REQUIRE(read_ids_with_filter(suffix, filter) == expected);
+        }
+    }
+
+    SECTION("bbox") {
+        filter.bbox(osmium::Box{1.05, 0.9, 1.25, 1.1});
+        const std::vector<osmium::object_id_type> expected = {11, 12, 20, 30, 31, 32};
+        for (const auto* suffix : {".osm", ".osm.o5m", ".osm.opl"}) {
+            REQUIRE(read_ids_with_filter(suffix, filter) == expected);
+        }
+    }
+
+    SECTION("predicate") {
+        filter.predicate([](const osmium::OSMObject& object) {
+            return object.id() % 2 == 0;
+        }, osmium::osm_entity_bits::node | osmium::osm_entity_bits::relation);
+        const std::vector<osmium::object_id_type> expected = {10, 12, 14, 20, 30, 32};
+        for (const auto* suffix : {".osm", ".osm.o5m", ".osm.opl"}) {
+            REQUIRE(read_ids_with_filter(suffix, filter) == expected);
+        }
+    }
+}
@@ -223,3 +223,41 @@ TEST_CASE("Writer with user-provided pool with outlier positive number of thread
     REQUIRE(count == count_fds());
 }
 
+TEST_CASE("Writer and Reader: Statistics") {
+    auto buffer = get_buffer();
+    const auto input_size = buffer.committed();
+    osmium::thread::Pool pool{2};
+
+    const std::string filename = "test-writer-out-stats.osm";
+    {
+        osmium::io::Writer writer{filename, osmium::io::overwrite::allow, pool};
+        writer(std::move(buffer));
+        writer.close();
+
+        const auto stats = writer.stats();
+        REQUIRE(stats.input.blocks == 1);
+        REQUIRE(stats.input.bytes == input_size);
+        REQUIRE(stats.output_queue.name == "raw_output");
+        REQUIRE(stats.output_queue.pushed == stats.output_queue.popped);
+        REQUIRE(stats.output.blocks > 0);
+        REQUIRE(stats.output.bytes > 0);
+        REQUIRE(stats.output.bytes_per_second() > 0.0);
+        REQUIRE(stats.pool.num_threads == 2);
+        REQUIRE(stats.pool.tasks > 0);
+    }
+
+    osmium::io::Reader reader{filename, pool};
+    std::size_t size = 0;
+    while (const auto read_buffer = reader.read()) {
+        size += read_buffer.committed();
+    }
+
+    const auto stats = reader.stats();
+    REQUIRE(stats.input.blocks > 0);
+    REQUIRE(stats.input.bytes > 0);
+    REQUIRE(stats.input_queue.name == "raw_input");
+    REQUIRE(stats.input_queue.pushed > stats.input.blocks);
+    REQUIRE(stats.osmdata_queue.name == "parser_results");
+    REQUIRE(stats.osmdata_queue.popped > 0);
+    REQUIRE(stats.output.bytes == size);
+}
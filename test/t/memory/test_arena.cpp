@@ -0,0 +1,83 @@
+#include "catch.hpp"
+
+#include <osmium/memory/arena.hpp>
+
+#include <cstdint>
+#include <list>
+#include <vector>
+
+TEST_CASE("Arena allocates aligned memory") {
+    osmium::memory::Arena arena{1024};
+    REQUIRE(arena.capacity() == 0);
+    REQUIRE(arena.used() == 0);
+
+    void* p1 = arena.allocate(3, 1);
+    void* p2 = arena.allocate(8, 8);
+    REQUIRE(p1 != p2);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(p2) % 8 == 0);
+    REQUIRE(arena.used() == 16);
+    REQUIRE(arena.capacity() == 1024);
+    REQUIRE(arena.num_blocks() == 1);
+}
+
+TEST_CASE("Arena adds blocks when needed and merges them on reset") {
+    osmium::memory::Arena arena{1024};
+
+    arena.allocate(1000, 8);
+    arena.allocate(1000, 8);
+    arena.allocate(5000, 8);
+    REQUIRE(arena.num_blocks() == 3);
+    REQUIRE(arena.capacity() == 1024 + 2048 + 5000);
+
+    arena.reset();
+    REQUIRE(arena.used() == 0);
+    REQUIRE(arena.num_blocks() == 1);
+    REQUIRE(arena.capacity() == 1024 + 2048 + 5000);
+
+    // Now everything fits into one block.
+    arena.allocate(1000, 8);
+    arena.allocate(1000, 8);
+    arena.allocate(5000, 8);
+    REQUIRE(arena.num_blocks() == 1);
+}
+
+TEST_CASE("Arena gives memory back if more than max_retained") {
+    osmium::memory::Arena arena{1024, 4096};
+
+    arena.allocate(10000, 8);
+    REQUIRE(arena.capacity() == 10000);
+
+    arena.reset();
+    REQUIRE(arena.capacity() == 0);
+}
+
+TEST_CASE("Use ArenaAllocator with standard containers") {
+    osmium::memory::Arena arena;
+
+    {
+        std::vector<int, osmium::memory::ArenaAllocator<int>> v{osmium::memory::ArenaAllocator<int>{&arena}};
+        for (int i = 0; i < 1000; ++i) {
+            v.push_back(i);
+        }
+        REQUIRE(v.size() == 1000);
+        REQUIRE(v[999] == 999);
+
+        std::list<int, osmium::memory::ArenaAllocator<int>> l{osmium::memory::ArenaAllocator<int>{&arena}};
+        l.push_back(1);
+        l.push_back(2);
+        REQUIRE(l.size() == 2);
+    }
+    REQUIRE(arena.used() > 1000 * sizeof(int));
+
+    arena.reset();
+    REQUIRE(arena.used() == 0);
+}
+
+TEST_CASE("ArenaAllocator without arena uses heap") {
+    std::vector<int, osmium::memory::ArenaAllocator<int>> v;
+    v.push_back(17);
+    REQUIRE(v.front() == 17);
+    REQUIRE(v.get_allocator().arena() == nullptr);
+    REQUIRE(v.get_allocator() == osmium::memory::ArenaAllocator<double>{});
+}
+
@@ -1,8 +1,10 @@
 #include "catch.hpp"
 
+#include <osmium/builder/attr.hpp>
 #include <osmium/memory/buffer.hpp>
 
 #include <array>
+#include <iterator>
 #include <stdexcept>
 
 TEST_CASE("Buffer basics") {
@@ -129,3 +131,36 @@ TEST_CASE("Create buffer from existing data with bad alignment fails") {
     REQUIRE_THROWS_AS(l4(), std::invalid_argument);
 }
 
+TEST_CASE("Buffer with homogeneous type") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+    osmium::memory::Buffer buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+    REQUIRE(buffer.homogeneous_type() == osmium::item_type::undefined);
+
+    osmium::builder::add_node(buffer, _id(1));
+    osmium::builder::add_node(buffer, _id(2));
+    buffer.set_homogeneous_type(osmium::item_type::node);
+    REQUIRE(buffer.homogeneous_type() == osmium::item_type::node);
+
+    REQUIRE(std::distance(buffer.select<osmium::Node>().cbegin(), buffer.select<osmium::Node>().cend()) == 2);
+    REQUIRE(std::distance(buffer.select<osmium::OSMObject>().cbegin(), buffer.select<osmium::OSMObject>().cend()) == 2);
+    REQUIRE(buffer.select<osmium::Way>().empty());
+    REQUIRE(buffer.cbegin<osmium::Way>() == buffer.cend<osmium::Way>());
+
+    osmium::memory::Buffer moved{std::move(buffer)};
+    REQUIRE(moved.homogeneous_type() == osmium::item_type::node);
+
+    // Adding another node keeps the type...
+    osmium::builder::add_node(moved, _id(3));
+    REQUIRE(moved.homogeneous_type() == osmium::item_type::node);
+
+    // ...adding a way resets it.
+    osmium::builder::add_way(moved, _id(4));
+    REQUIRE(moved.homogeneous_type() == osmium::item_type::undefined);
+    REQUIRE(std::distance(moved.select<osmium::Way>().cbegin(), moved.select<osmium::Way>().cend()) == 1);
+
+    moved.clear();
+    moved.set_homogeneous_type(osmium::item_type::way);
+    REQUIRE(moved.homogeneous_type() == osmium::item_type::way);
+    moved.clear();
+    REQUIRE(moved.homogeneous_type() == osmium::item_type::undefined);
+}
@@ -0,0 +1,171 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node_batch.hpp>
+#include <osmium/visitor.hpp>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+static void add_batch(osmium::memory::Buffer& buffer, bool with_tags) {
+    {
+        osmium::builder::NodeBatchBuilder builder{buffer, 3, with_tags};
+        builder.add_node(10, osmium::Location{1.0, 2.0});
+        if (with_tags) {
+            builder.add_tag("amenity", 7, "pub", 3);
+            builder.add_tag("name", 4, "Bar", 3);
+        }
+        builder.add_node(11, osmium::Location{});
+        builder.add_node(12, osmium::Location{-3.5, 4.25});
+        if (with_tags) {
+            builder.add_tag("highway", 7, "traffic_signals", 15);
+        }
+    }
+    buffer.commit();
+}
+
+TEST_CASE("Build node batch without tags") {
+    osmium::memory::Buffer buffer{1024};
+    add_batch(buffer, false);
+
+    const auto& batch = buffer.get<osmium::NodeBatch>(0);
+    REQUIRE(batch.type() == osmium::item_type::node_batch);
+    REQUIRE(batch.size() == 3);
+    REQUIRE_FALSE(batch.empty());
+    REQUIRE_FALSE(batch.has_tags());
+    REQUIRE(batch.byte_size() % osmium::memory::align_bytes == 0);
+
+    REQUIRE(batch.ids()[0] == 10);
+    REQUIRE(batch.ids()[2] == 12);
+    REQUIRE(batch.x()[0] == 10000000);
+    REQUIRE(batch.y()[0] == 20000000);
+    REQUIRE(batch.id(1) == 11);
+    REQUIRE_FALSE(batch.location(1).valid());
+    REQUIRE(batch.location(2) == osmium::Location(-3.5, 4.25));
+
+    REQUIRE(batch.tag_count(0) == 0);
+    REQUIRE(batch.get_value_by_key(0, "amenity") == nullptr);
+    REQUIRE(std::string{batch.get_value_by_key(0, "amenity", "none")} == "none");
+}
+
+TEST_CASE("Build node batch with tags") {
+    osmium::memory::Buffer buffer{1024};
+    add_batch(buffer, true);
+
+    const auto& batch = buffer.get<osmium::NodeBatch>(0);
+    REQUIRE(batch.size() == 3);
+    REQUIRE(batch.has_tags());
+    REQUIRE(batch.byte_size() % osmium::memory::align_bytes == 0);
+
+    REQUIRE(batch.tag_offsets()[0] == 0);
+    REQUIRE(batch.tag_offsets()[1] == batch.tag_offsets()[2]);
+    REQUIRE(std::strcmp(batch.tag_data(), "amenity") == 0);
+
+    REQUIRE(batch.tag_count(0) == 2);
+    REQUIRE(batch.tag_count(1) == 0);
+    REQUIRE(batch.tag_count(2) == 1);
+
+    REQUIRE(std::string{batch.get_value_by_key(0, "amenity")} == "pub");
+    REQUIRE(std::string{batch.get_value_by_key(0, "name")} == "Bar");
+    REQUIRE(batch.get_value_by_key(0, "highway") == nullptr);
+    REQUIRE(batch.get_value_by_key(1, "amenity") == nullptr);
+    REQUIRE(std::string{batch.get_value_by_key(2, "highway")} == "traffic_signals");
+    REQUIRE(batch.location(2) == osmium::Location(-3.5, 4.25));
+}
+
+TEST_CASE("Node batch with overlong tag") {
+    osmium::memory::Buffer buffer{1024};
+    osmium::builder::NodeBatchBuilder builder{buffer, 1, true};
+    builder.add_node(1, osmium::Location{});
+    const std::string value(2000, 'x');
+    REQUIRE_THROWS_AS(builder.add_tag("key", 3, value.data(), value.size()), std::length_error);
+}
+
+TEST_CASE("Node batch in growing buffer") {
+    osmium::memory::Buffer buffer{64, osmium::memory::Buffer::auto_grow::yes};
+    {
+        osmium::builder::NodeBatchBuilder builder{buffer, 100, true};
+        for (int i = 0; i < 100; ++i) {
+            builder.add_node(i, osmium::Location{i, i});
+            builder.add_tag("ref", 3, "abcdefgh", 8);
+        }
+    }
+    buffer.commit();
+
+    const auto& batch = buffer.get<osmium::NodeBatch>(0);
+    REQUIRE(batch.size() == 100);
+    REQUIRE(batch.id(99) == 99);
+    REQUIRE(batch.location(42).x() == 42);
+    REQUIRE(batch.tag_count(99) == 1);
+    REQUIRE(std::string{batch.get_value_by_key(57, "ref")} == "abcdefgh");
+}
+
+namespace {
+
+    struct BatchHandler : public osmium::handler::Handler {
+
+        int nodes = 0;
+        std::size_t batch_nodes = 0;
+        int tag_lists = 0;
+
+        void node(const osmium::Node& /*node*/) noexcept {
+            ++nodes;
+        }
+
+        void node_batch(const osmium::NodeBatch& batch) noexcept {
+            batch_nodes += batch.size();
+        }
+
+        void tag_list(const osmium::TagList& /*tag_list*/) noexcept {
+            ++tag_lists;
+        }
+
+    }; // struct BatchHandler
+
+} // anonymous namespace
+
+TEST_CASE("Apply handler to buffer with node batch") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+    add_batch(buffer, false);
+    osmium::builder::add_node(buffer, _id(20), _location(1.0, 1.0));
+    osmium::builder::add_tag_list(buffer, _tag("highway", "primary"));
+
+    REQUIRE(std::distance(buffer.select<osmium::NodeBatch>().begin(), buffer.select<osmium::NodeBatch>().end()) == 1);
+    REQUIRE(std::distance(buffer.select<osmium::OSMObject>().begin(), buffer.select<osmium::OSMObject>().end()) == 1);
+
+    BatchHandler handler;
+    osmium::apply(buffer, handler);
+    REQUIRE(handler.nodes == 1);
+    REQUIRE(handler.batch_nodes == 3);
+    REQUIRE(handler.tag_lists == 0);
+
+    std::size_t count = 0;
+    osmium::apply(buffer, [&](const osmium::NodeBatch& batch) {
+        count += batch.size();
+    });
+    REQUIRE(count == 3);
+}
+
+TEST_CASE("Buffer with only node batches is homogeneous") {
+    osmium::memory::Buffer buffer{1024};
+    buffer.set_homogeneous_type(osmium::item_type::node_batch);
+    add_batch(buffer, false);
+    add_batch(buffer, true);
+    REQUIRE(buffer.homogeneous_type() == osmium::item_type::node_batch);
+
+    BatchHandler handler;
+    osmium::apply(buffer, handler);
+    REQUIRE(handler.batch_nodes == 6);
+}
+
+TEST_CASE("Item type of node batch") {
+    REQUIRE(osmium::item_type_to_char(osmium::item_type::node_batch) == 'B');
+    REQUIRE(osmium::char_to_item_type('B') == osmium::item_type::node_batch);
+    REQUIRE(std::string{osmium::item_type_to_name(osmium::item_type::node_batch)} == "node_batch");
+}
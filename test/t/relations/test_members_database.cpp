@@ -6,6 +6,9 @@
 #include <osmium/relations/relations_database.hpp>
 #include <osmium/storage/item_stash.hpp>
 
+#include <algorithm>
+#include <vector>
+
 osmium::memory::Buffer fill_buffer() {
     using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
     osmium::memory::Buffer buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
@@ -194,3 +197,69 @@ TEST_CASE("Remove non-existing object from members database doesn't do anything"
     REQUIRE(mdb.size() == 6);
 }
 
+TEST_CASE("Add objects to member database in and out of order") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+    osmium::memory::Buffer buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
+
+    // Relation n has ways 3n and 3n + 6 as members
+    for (osmium::object_id_type n = 1; n <= 100; ++n) {
+        osmium::builder::add_relation(buffer,
+            _id(n),
+            _member(osmium::item_type::way, 3 * n, "outer"),
+            _member(osmium::item_type::way, 3 * n + 6, "outer")
+        );
+    }
+
+    std::vector<osmium::object_id_type> ids;
+    for (osmium::object_id_type id = 1; id <= 400; ++id) {
+        ids.push_back(id);
+    }
+
+    SECTION("ascending") {
+    }
+
+    SECTION("descending") {
+        std::reverse(ids.begin(), ids.end());
+    }
+
+    SECTION("mixed") {
+        std::rotate(ids.begin(), ids.begin() + 150, ids.end());
+        std::reverse(ids.begin() + 200, ids.begin() + 220);
+    }
+
+    for (const auto id : ids) {
+        osmium::builder::add_way(buffer, _id(id));
+    }
+
+    osmium::ItemStash stash;
+    osmium::relations::RelationsDatabase rdb{stash};
+    osmium::relations::MembersDatabase<osmium::Way> mdb{stash, rdb};
+
+    for (const auto& relation : buffer.select<osmium::Relation>()) {
+        auto handle = rdb.add(relation);
+        int n = 0;
+        for (const auto& member : relation.members()) {
+            mdb.track(handle, member.ref(), n);
+            ++n;
+        }
+    }
+
+    mdb.prepare_for_lookup();
+
+    int added = 0;
+    int complete = 0;
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        if (mdb.add(way, [&](osmium::relations::RelationHandle& /*rel_handle*/) {
+            ++complete;
+        })) {
+            ++added;
+            REQUIRE(way.id() % 3 == 0);
+            REQUIRE(mdb.get(way.id()));
+        }
+    }
+
+    REQUIRE(added == 102);
+    REQUIRE(complete == 100);
+    REQUIRE_FALSE(mdb.get(1));
+    REQUIRE_FALSE(mdb.get(400));
+}
@@ -0,0 +1,105 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/io/xml_input.hpp>
+#include <osmium/relations/multi_pass_resolver.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+static bool has_type(const osmium::Relation& relation, const char* type) {
+    const char* value = relation.tags()["type"];
+    return value && !std::strcmp(value, type);
+}
+
+TEST_CASE("Resolve nested relations in three passes") {
+    const osmium::io::File file{with_data_dir("t/relations/super_relations.osm")};
+
+    osmium::relations::MultiPassResolver resolver;
+
+    std::vector<osmium::object_id_type> ids;
+    std::vector<osmium::object_id_type> way_ids;
+    int nodes = 0;
+
+    resolver.run(file, [](const osmium::Relation& relation) {
+        return has_type(relation, "network");
+    }, [&](const osmium::Relation& relation) {
+        ids.push_back(relation.id());
+        resolver.for_each_member_recursive(relation, [&](const osmium::OSMObject& object) {
+            if (object.type() == osmium::item_type::way) {
+                way_ids.push_back(object.id());
+            } else {
+                ++nodes;
+            }
+        });
+    });
+
+    REQUIRE(resolver.passes() == 3);
+    REQUIRE(ids == std::vector<osmium::object_id_type>{50});
+
+    std::sort(way_ids.begin(), way_ids.end());
+    REQUIRE(way_ids == std::vector<osmium::object_id_type>{20, 21, 22, 23, 24});
+    REQUIRE(nodes == 1);
+
+    REQUIRE(resolver.get_relation(40));
+    REQUIRE(resolver.get_relation(33));
+    REQUIRE_FALSE(resolver.get_relation(34));
+    REQUIRE_FALSE(resolver.get_relation(59));
+    REQUIRE(resolver.get_way(22));
+    REQUIRE_FALSE(resolver.get_way(29));
+    REQUIRE(resolver.get_node(10));
+    REQUIRE_FALSE(resolver.get_node(11));
+
+    std::vector<osmium::unsigned_object_id_type> parents;
+    resolver.for_each_parent(osmium::item_type::way, 21, [&](osmium::unsigned_object_id_type id) {
+        parents.push_back(id);
+    });
+    REQUIRE(parents == std::vector<osmium::unsigned_object_id_type>{30});
+
+    parents.clear();
+    resolver.for_each_parent(osmium::item_type::relation, 32, [&](osmium::unsigned_object_id_type id) {
+        parents.push_back(id);
+    });
+    std::sort(parents.begin(), parents.end());
+    REQUIRE(parents == std::vector<osmium::unsigned_object_id_type>{33, 50});
+}
+
+TEST_CASE("Resolve relations with member relations first") {
+    const osmium::io::File file{with_data_dir("t/relations/super_relations.osm")};
+
+    osmium::relations::MultiPassResolver resolver;
+
+    std::vector<osmium::object_id_type> ids;
+    resolver.run(file, [](const osmium::Relation& relation) {
+        return has_type(relation, "route_master") || has_type(relation, "network") || relation.id() == 30;
+    }, [&](const osmium::Relation& relation) {
+        ids.push_back(relation.id());
+    });
+
+    REQUIRE(resolver.passes() == 3);
+    REQUIRE(ids.size() == 3);
+    const auto pos = [&](osmium::object_id_type id) {
+        return std::find(ids.begin(), ids.end(), id) - ids.begin();
+    };
+    REQUIRE(pos(30) < pos(40));
+    REQUIRE(pos(40) < pos(50));
+}
+
+TEST_CASE("Resolve relations without member relations in two passes") {
+    const osmium::io::File file{with_data_dir("t/relations/super_relations.osm")};
+
+    osmium::relations::MultiPassResolver resolver;
+
+    std::vector<osmium::object_id_type> ids;
+    resolver.run(file, [](const osmium::Relation& relation) {
+        return relation.id() == 34;
+    }, [&](const osmium::Relation& relation) {
+        ids.push_back(relation.id());
+        REQUIRE(resolver.get_way(21));
+    });
+
+    REQUIRE(resolver.passes() == 2);
+    REQUIRE(ids == std::vector<osmium::object_id_type>{34});
+}
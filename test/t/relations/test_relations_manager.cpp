@@ -4,7 +4,9 @@
 
 #include <osmium/io/xml_input.hpp>
 #include <osmium/osm/relation.hpp>
+#include <osmium/relations/parallel_sort.hpp>
 #include <osmium/relations/relations_manager.hpp>
+#include <osmium/thread/pool.hpp>
 
 #include <iterator>
 
@@ -232,6 +234,27 @@ TEST_CASE("Access members via RelationsManager") {
     REQUIRE(nullptr == manager.get_member_relation(17));
 }
 
+TEST_CASE("Prepare RelationsManager for lookup using thread pool") {
+    const osmium::io::File file{with_data_dir("t/relations/data.osm")};
+
+    TestRM manager;
+
+    osmium::io::Reader reader1{file, osmium::osm_entity_bits::relation};
+    osmium::apply(reader1, manager);
+    reader1.close();
+
+    osmium::thread::Pool pool{2};
+    manager.prepare_for_lookup(pool);
+
+    osmium::io::Reader reader2{file};
+    osmium::apply(reader2, manager.handler());
+    reader2.close();
+
+    REQUIRE(manager.count_new_rels      == 3);
+    REQUIRE(manager.count_new_members   == 5);
+    REQUIRE(manager.count_complete_rels == 2);
+}
+
 TEST_CASE("Handle duplicate members correctly") {
     const osmium::io::File file{with_data_dir("t/relations/dupl_member.osm")};
 
@@ -1,6 +1,8 @@
 #include "catch.hpp"
 
 #include <osmium/builder/attr.hpp>
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/io/detail/read_write.hpp>
 #include <osmium/storage/item_stash.hpp>
 
 #include <sstream>
@@ -159,10 +161,140 @@ TEST_CASE("Fill item stash until it garbage collects") {
     REQUIRE(stash.size() == num_items / 10);
     REQUIRE(stash.count_removed() == num_items / 10 * 9);
 
-    // trigger compaction
+    // adding an item moves the remaining items out of one segment
     stash.add_item(node);
 
+    REQUIRE(stash.size() == num_items / 10 + 1);
+    REQUIRE(stash.count_removed() > 0);
+    REQUIRE(stash.count_removed() < num_items / 10 * 9);
+
+    const auto memory_before_gc = stash.used_memory();
+    stash.garbage_collect();
+
     REQUIRE(stash.size() == num_items / 10 + 1);
     REQUIRE(stash.count_removed() == 0);
+    REQUIRE(stash.used_memory() < memory_before_gc);
+
+    for (std::size_t i = 0; i < num_items; i += 10) {
+        REQUIRE(stash.get<osmium::Node>(handles[i]).id() == node.id());
+    }
+}
+
+TEST_CASE("Item stash collects garbage incrementally") {
+    const auto buffer = generate_test_data();
+
+    osmium::ItemStash stash{64UL * 1024UL};
+
+    std::vector<osmium::ItemStash::handle_type> handles;
+    for (int round = 0; round < 200; ++round) {
+        for (const auto& item : buffer) {
+            handles.push_back(stash.add_item(item));
+        }
+    }
+
+    const auto num_segments = stash.num_segments();
+    REQUIRE(num_segments > 10);
+
+    // Removing all items in a segment frees it immediately.
+    for (std::size_t i = 0; i < handles.size() / 2; ++i) {
+        stash.remove_item(handles[i]);
+        handles[i] = osmium::ItemStash::handle_type{};
+    }
+    REQUIRE(stash.num_segments() < num_segments);
+    REQUIRE(stash.count_removed() < handles.size() / 2);
+
+    // Segments with few live items are emptied while adding new items.
+    for (std::size_t i = handles.size() / 2; i < handles.size(); ++i) {
+        if (i % 8 != 0) {
+            stash.remove_item(handles[i]);
+            handles[i] = osmium::ItemStash::handle_type{};
+        }
+    }
+    const auto count_removed = stash.count_removed();
+    REQUIRE(count_removed > 0);
+
+    for (int round = 0; round < 10; ++round) {
+        for (const auto& item : buffer) {
+            handles.push_back(stash.add_item(item));
+        }
+    }
+
+    REQUIRE(stash.count_removed() < count_removed / 2);
+    REQUIRE(stash.num_segments() < num_segments / 2);
+
+    for (std::size_t i = 0; i < handles.size(); ++i) {
+        if (handles[i].valid()) {
+            REQUIRE(stash.get<osmium::OSMObject>(handles[i]).id() == static_cast<osmium::object_id_type>(i % 180 + 1));
+        }
+    }
+}
+
+TEST_CASE("Item stash spilling to temporary file") {
+    const auto buffer = generate_test_data();
+
+    osmium::ItemStash stash;
+    stash.spill_to_file(64UL * 1024UL);
+    REQUIRE_FALSE(stash.spilled());
+
+    std::vector<osmium::ItemStash::handle_type> handles;
+    for (int round = 0; round < 100; ++round) {
+        for (const auto& item : buffer) {
+            handles.push_back(stash.add_item(item));
+        }
+    }
+
+    REQUIRE(stash.spilled());
+    REQUIRE(stash.size() == 100 * 180);
+    REQUIRE(stash.used_memory() < 1024UL * 1024UL);
+
+    osmium::object_id_type id = 1;
+    for (const auto handle : handles) {
+        REQUIRE(stash.get<osmium::OSMObject>(handle).id() == id);
+        id = id % 180 + 1;
+    }
+
+    for (std::size_t i = 0; i < handles.size(); ++i) {
+        if (i % 3 != 0) {
+            stash.remove_item(handles[i]);
+            handles[i] = osmium::ItemStash::handle_type{};
+        }
+    }
+
+    stash.garbage_collect();
+    REQUIRE(stash.spilled());
+    REQUIRE(stash.count_removed() == 0);
+
+    for (std::size_t i = 0; i < handles.size(); ++i) {
+        if (handles[i].valid()) {
+            REQUIRE(stash.get<osmium::OSMObject>(handles[i]).id() == static_cast<osmium::object_id_type>(i % 180 + 1));
+        }
+    }
+}
+
+TEST_CASE("Item stash spilling to file given by caller") {
+    const auto buffer = generate_test_data();
+
+    osmium::ItemStash stash;
+    const int fd = osmium::detail::create_tmp_file();
+    stash.spill_to_file(64UL * 1024UL, fd);
+
+    // The stash has its own duplicate of the descriptor.
+    osmium::io::detail::reliable_close(fd);
+
+    std::vector<osmium::ItemStash::handle_type> handles;
+    for (int round = 0; round < 100; ++round) {
+        for (const auto& item : buffer) {
+            handles.push_back(stash.add_item(item));
+        }
+    }
+
+    REQUIRE(stash.spilled());
+    REQUIRE(stash.size() == 100 * 180);
+
+    osmium::object_id_type id = 1;
+    for (const auto handle : handles) {
+        REQUIRE(stash.get<osmium::OSMObject>(handle).id() == id);
+        id = id % 180 + 1;
+    }
 }
 
@@ -0,0 +1,123 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/parallel_apply.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    // Looks like an osmium::io::Reader to parallel_apply().
+    class BufferSource {
+
+        std::vector<osmium::memory::Buffer> m_buffers;
+        std::size_t m_next = 0;
+
+    public:
+
+        explicit BufferSource(int num_buffers) {
+            using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+            osmium::object_id_type id = 1;
+            for (int n = 0; n < num_buffers; ++n) {
+                m_buffers.emplace_back(1024, osmium::memory::Buffer::auto_grow::yes);
+                for (int i = 0; i < 100; ++i) {
+                    osmium::builder::add_node(m_buffers.back(), _id(id++));
+                }
+                osmium::builder::add_way(m_buffers.back(), _id(n + 1));
+            }
+        }
+
+        osmium::memory::Buffer read() {
+            if (m_next == m_buffers.size()) {
+                return osmium::memory::Buffer{};
+            }
+            return std::move(m_buffers[m_next++]);
+        }
+
+    }; // class BufferSource
+
+    struct CountHandler : public osmium::handler::Handler {
+
+        osmium::object_id_type id_sum = 0;
+        int nodes = 0;
+        int ways = 0;
+        int flushed = 0;
+
+        void node(const osmium::Node& node) noexcept {
+            id_sum += node.id();
+            ++nodes;
+        }
+
+        void way(const osmium::Way& /*way*/) {
+            if (ways++ == 1000) {
+                throw std::runtime_error{"too many ways"};
+            }
+        }
+
+        void flush() noexcept {
+            ++flushed;
+        }
+
+    }; // struct CountHandler
+
+} // anonymous namespace
+
+TEST_CASE("Parallel apply with reduce") {
+    osmium::thread::Pool pool{4};
+    BufferSource source{200};
+
+    CountHandler total;
+    int num_handlers = 0;
+    osmium::thread::parallel_apply(source, pool, CountHandler{}, [&](CountHandler& handler) {
+        REQUIRE(handler.flushed == 1);
+        total.id_sum += handler.id_sum;
+        total.nodes += handler.nodes;
+        total.ways += handler.ways;
+        ++num_handlers;
+    });
+
+    REQUIRE(num_handlers == 4);
+    REQUIRE(total.nodes == 200 * 100);
+    REQUIRE(total.ways == 200);
+    REQUIRE(total.id_sum == 20000LL * 20001LL / 2);
+}
+
+TEST_CASE("Parallel apply rethrows exception from handler") {
+    osmium::thread::Pool pool{1};
+    BufferSource source{1200};
+
+    REQUIRE_THROWS_AS(osmium::thread::parallel_apply(source, pool, CountHandler{}, [](CountHandler& /*handler*/) {
+    }), std::runtime_error);
+}
+
+TEST_CASE("Parallel transform keeps order") {
+    osmium::thread::Pool pool{4};
+    BufferSource source{100};
+
+    std::vector<osmium::object_id_type> ids;
+    osmium::thread::parallel_transform(source, pool, [](const osmium::memory::Buffer& input) {
+        // Copy only the way in each buffer.
+        osmium::memory::Buffer output{1024, osmium::memory::Buffer::auto_grow::yes};
+        for (const auto& way : input.select<osmium::Way>()) {
+            output.add_item(way);
+            output.commit();
+        }
+        return output;
+    }, [&](osmium::memory::Buffer&& buffer) {
+        for (const auto& way : buffer.select<osmium::Way>()) {
+            ids.push_back(way.id());
+        }
+    });
+
+    REQUIRE(ids.size() == 100);
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        REQUIRE(ids[i] == static_cast<osmium::object_id_type>(i + 1));
+    }
+}
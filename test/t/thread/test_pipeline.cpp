@@ -0,0 +1,117 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pipeline.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+static osmium::memory::Buffer make_buffer(osmium::object_id_type id) {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+    osmium::memory::Buffer buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(buffer, _id(id));
+    osmium::builder::add_way(buffer, _id(id));
+    return buffer;
+}
+
+static osmium::memory::Buffer only_ways(osmium::memory::Buffer&& input) {
+    osmium::memory::Buffer output{1024, osmium::memory::Buffer::auto_grow::yes};
+    for (const auto& way : input.select<osmium::Way>()) {
+        output.add_item(way);
+        output.commit();
+    }
+    return output;
+}
+
+TEST_CASE("Pipeline with parallel and serial stages") {
+    osmium::thread::Pool pool{4};
+    osmium::thread::Pipeline pipeline{pool};
+
+    int serial_count = 0;
+    pipeline.add_stage("filter", 4, only_ways);
+    pipeline.add_stage("count", 1, [&serial_count](osmium::memory::Buffer&& buffer) {
+        ++serial_count;
+        if (serial_count % 10 == 0) {
+            // dropped by the pipeline
+            return osmium::memory::Buffer{};
+        }
+        return std::move(buffer);
+    });
+
+    osmium::object_id_type next_id = 1;
+    std::vector<osmium::object_id_type> ids;
+    pipeline.run([&]() {
+        if (next_id > 200) {
+            return osmium::memory::Buffer{};
+        }
+        return make_buffer(next_id++);
+    }, [&](osmium::memory::Buffer&& buffer) {
+        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+            REQUIRE(object.type() == osmium::item_type::way);
+            ids.push_back(object.id());
+        }
+    });
+
+    REQUIRE(serial_count == 200);
+    REQUIRE(ids.size() == 180);
+    for (std::size_t i = 1; i < ids.size(); ++i) {
+        REQUIRE(ids[i - 1] < ids[i]);
+        REQUIRE(ids[i] % 10 != 0);
+    }
+
+    const auto stats = pipeline.stats();
+    REQUIRE(stats.size() == 4);
+    REQUIRE(stats[0].name == "source");
+    REQUIRE(stats[0].buffers == 200);
+    REQUIRE(stats[1].name == "filter");
+    REQUIRE(stats[1].buffers == 200);
+    REQUIRE(stats[2].buffers == 200);
+    REQUIRE(stats[3].name == "sink");
+    REQUIRE(stats[3].buffers == 180);
+    REQUIRE(stats[1].bytes > stats[3].bytes);
+}
+
+TEST_CASE("Pipeline rethrows exception from stage") {
+    osmium::thread::Pool pool{2};
+    osmium::thread::Pipeline pipeline{pool};
+
+    pipeline.add_stage("filter", 2, [](osmium::memory::Buffer&& buffer) {
+        if (buffer.get<osmium::Node>(0).id() == 50) {
+            throw std::runtime_error{"error"};
+        }
+        return std::move(buffer);
+    });
+    pipeline.add_stage("copy", 1, only_ways);
+
+    osmium::object_id_type next_id = 1;
+    int count = 0;
+    REQUIRE_THROWS_AS(pipeline.run([&]() {
+        if (next_id > 1000) {
+            return osmium::memory::Buffer{};
+        }
+        return make_buffer(next_id++);
+    }, [&](osmium::memory::Buffer&& /*buffer*/) {
+        ++count;
+    }), std::runtime_error);
+
+    REQUIRE(count == 49);
+    REQUIRE(next_id < 1000);
+}
+
+TEST_CASE("Pipeline rethrows exception from sink") {
+    osmium::thread::Pool pool{2};
+    osmium::thread::Pipeline pipeline{pool};
+    pipeline.add_stage("filter", 2, only_ways);
+
+    osmium::object_id_type next_id = 1;
+    REQUIRE_THROWS_AS(pipeline.run([&]() {
+        return make_buffer(next_id++);
+    }, [&](osmium::memory::Buffer&& /*buffer*/) {
+        throw std::runtime_error{"error"};
+    }), std::runtime_error);
+}
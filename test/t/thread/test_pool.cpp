@@ -2,7 +2,11 @@
 
 #include <osmium/thread/pool.hpp>
 
+#include <atomic>
+#include <future>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 struct test_job_with_result {
     int operator()() const {
@@ -41,7 +45,7 @@ TEST_CASE("number of threads in pool") {
 
     // outliers
     REQUIRE(osmium::thread::detail::get_pool_size(-100, 0, 16) ==  1);
-    REQUIRE(osmium::thread::detail::get_pool_size(1000, 0, 16) == 32);
+    REQUIRE(osmium::thread::detail::get_pool_size(1000, 0, 16) == 256);
 
 }
 
@@ -104,3 +108,76 @@ TEST_CASE("can throw from job in user provided thread pool") {
     REQUIRE_THROWS_AS(future.get(), std::runtime_error);
 }
 
+TEST_CASE("can use more than 32 threads in thread pool") {
+    osmium::thread::Pool pool{64};
+    REQUIRE(pool.num_threads() == 64);
+
+    std::vector<std::future<int>> futures;
+    for (int i = 0; i < 1000; ++i) {
+        futures.push_back(pool.submit([i] { return i; }));
+    }
+    int sum = 0;
+    for (auto& future : futures) {
+        sum += future.get();
+    }
+    REQUIRE(sum == 499500);
+}
+
+TEST_CASE("can submit jobs from inside a job with a small queue") {
+    osmium::thread::Pool pool{2, 1};
+
+    // Jobs submitted from a worker thread never block on a full queue.
+    std::vector<std::future<std::future<int>>> futures;
+    for (int i = 0; i < 20; ++i) {
+        futures.push_back(pool.submit([&pool, i] {
+            std::future<int> inner;
+            for (int j = 0; j < 10; ++j) {
+                inner = pool.submit([i] { return i * 2; });
+            }
+            return inner;
+        }));
+    }
+    int sum = 0;
+    for (auto& future : futures) {
+        sum += future.get().get();
+    }
+    REQUIRE(sum == 380);
+}
+
+TEST_CASE("all jobs are done when thread pool is destructed") {
+    std::atomic<int> count{0};
+    {
+        osmium::thread::Pool pool{4, 2};
+        for (int i = 0; i < 500; ++i) {
+            pool.submit([&count] { ++count; });
+        }
+    }
+    REQUIRE(count == 500);
+}
+
+TEST_CASE("thread pool records execution times of tasks") {
+    osmium::thread::Pool pool{2};
+    REQUIRE(pool.stats().tasks == 0);
+
+    std::vector<std::future<int>> futures;
+    for (int i = 0; i < 10; ++i) {
+        futures.push_back(pool.submit(test_job_with_result{}));
+    }
+    for (auto& future : futures) {
+        REQUIRE(future.get() == 42);
+    }
+
+    // The task is done when its result is available, its time is
+    // recorded after that, so shut down the pool to be sure.
+    pool.shutdown_all_workers();
+    while (pool.stats().tasks < 10) {
+        std::this_thread::yield();
+    }
+
+    const auto stats = pool.stats();
+    REQUIRE(stats.num_threads == 2);
+    REQUIRE(stats.queue_size == 0);
+    REQUIRE(stats.tasks == 10);
+    REQUIRE(stats.task_times.total() == 10);
+    REQUIRE(stats.busy.count() >= 0);
+}
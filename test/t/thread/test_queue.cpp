@@ -2,6 +2,11 @@
 
 #include <osmium/thread/queue.hpp>
 
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
 TEST_CASE("Basic use of thread-safe queue") {
     osmium::thread::Queue<int> queue;
     REQUIRE(queue.empty());
@@ -45,3 +50,165 @@ TEST_CASE("When queue is shut down, nothing goes in or out") {
     queue.wait_and_pop(value);
     REQUIRE(value.empty());
 }
+
+TEST_CASE("Queue without max size always uses locked implementation") {
+    const osmium::thread::Queue<int> queue{0, "", osmium::thread::queue_kind::spsc};
+    REQUIRE(queue.kind() == osmium::thread::queue_kind::locked);
+}
+
+TEST_CASE("Ring buffer queues keep order and respect max size") {
+    const auto kind = GENERATE(osmium::thread::queue_kind::locked,
+                               osmium::thread::queue_kind::spsc,
+                               osmium::thread::queue_kind::mpmc);
+    osmium::thread::Queue<std::string> queue{3, "", kind};
+    REQUIRE(queue.kind() == kind);
+    REQUIRE(queue.empty());
+    queue.push("foo");
+    queue.push("bar");
+    queue.push("baz");
+    REQUIRE(queue.size() == 3);
+
+    std::string value;
+    REQUIRE(queue.try_pop(value));
+    REQUIRE(value == "foo");
+    queue.push("abc");
+    queue.wait_and_pop(value);
+    REQUIRE(value == "bar");
+    queue.wait_and_pop(value);
+    REQUIRE(value == "baz");
+    queue.wait_and_pop(value);
+    REQUIRE(value == "abc");
+    REQUIRE(queue.empty());
+    REQUIRE_FALSE(queue.try_pop(value));
+
+    queue.push("lost");
+    queue.shutdown();
+    REQUIRE(queue.empty());
+    REQUIRE(queue.size() == 0);
+    value.clear();
+    queue.wait_and_pop(value);
+    REQUIRE(value.empty());
+}
+
+TEST_CASE("Single producer and consumer through small queue") {
+    const auto kind = GENERATE(osmium::thread::queue_kind::locked,
+                               osmium::thread::queue_kind::spsc,
+                               osmium::thread::queue_kind::mpmc);
+    osmium::thread::Queue<int> queue{2, "", kind};
+
+    std::thread producer{[&queue] {
+        for (int i = 1; i <= 10000; ++i) {
+            queue.push(i);
+        }
+    }};
+
+    bool in_order = true;
+    for (int i = 1; i <= 10000; ++i) {
+        int value = 0;
+        queue.wait_and_pop(value);
+        if (value != i) {
+            in_order = false;
+        }
+    }
+    producer.join();
+
+    REQUIRE(in_order);
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("Multiple producers and consumers through mpmc queue") {
+    osmium::thread::Queue<int> queue{4, "", osmium::thread::queue_kind::mpmc};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < 3; ++p) {
+        threads.emplace_back([&queue] {
+            for (int i = 1; i <= 1000; ++i) {
+                queue.push(i);
+            }
+        });
+    }
+
+    std::atomic<long> sum{0};
+    for (int c = 0; c < 3; ++c) {
+        threads.emplace_back([&queue, &sum] {
+            for (int i = 0; i < 1000; ++i) {
+                int value = 0;
+                queue.wait_and_pop(value);
+                sum += value;
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(sum == 3 * 500500);
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("Shutdown wakes up threads blocked on full or empty queue") {
+    const auto kind = GENERATE(osmium::thread::queue_kind::locked,
+                               osmium::thread::queue_kind::spsc,
+                               osmium::thread::queue_kind::mpmc);
+    osmium::thread::Queue<int> full_queue{1, "", kind};
+    osmium::thread::Queue<int> empty_queue{1, "", kind};
+    full_queue.push(1);
+
+    std::thread producer{[&full_queue] {
+        full_queue.push(2);
+    }};
+    std::thread consumer{[&empty_queue] {
+        int value = 0;
+        empty_queue.wait_and_pop(value);
+    }};
+
+    full_queue.shutdown();
+    empty_queue.shutdown();
+    producer.join();
+    consumer.join();
+
+    REQUIRE_FALSE(full_queue.in_use());
+    REQUIRE_FALSE(empty_queue.in_use());
+}
+
+TEST_CASE("Queue statistics") {
+    const auto kind = GENERATE(osmium::thread::queue_kind::locked,
+                               osmium::thread::queue_kind::spsc,
+                               osmium::thread::queue_kind::mpmc);
+    osmium::thread::Queue<int> queue{2, "test", kind};
+    queue.push(1);
+    queue.push(2);
+
+    auto stats = queue.stats();
+    REQUIRE(stats.name == "test");
+    REQUIRE(stats.max_size == 2);
+    REQUIRE(stats.size == 2);
+    REQUIRE(stats.largest_size == 2);
+    REQUIRE(stats.pushed == 2);
+    REQUIRE(stats.full == 0);
+    REQUIRE(stats.popped == 0);
+
+    std::thread producer{[&queue] {
+        queue.push(3);
+    }};
+    while (queue.stats().full == 0) {
+        std::this_thread::yield();
+    }
+
+    int value = 0;
+    for (int i = 0; i < 3; ++i) {
+        queue.wait_and_pop(value);
+    }
+    producer.join();
+    REQUIRE_FALSE(queue.try_pop(value));
+
+    stats = queue.stats();
+    REQUIRE(stats.size == 0);
+    REQUIRE(stats.largest_size == 2);
+    REQUIRE(stats.pushed == 3);
+    REQUIRE(stats.full == 1);
+    REQUIRE(stats.push_blocked.count() > 0);
+    REQUIRE(stats.popped == 3);
+    REQUIRE(stats.empty >= 1);
+}
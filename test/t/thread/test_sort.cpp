@@ -0,0 +1,85 @@
+#include "catch.hpp"
+
+#include <osmium/index/multimap/sparse_file_array.hpp>
+#include <osmium/index/multimap/sparse_mem_array.hpp>
+#include <osmium/index/parallel_sort.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/thread/sort.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+static std::vector<uint64_t> random_data(std::size_t size) {
+    std::mt19937_64 gen{42}; // NOLINT(cert-msc32-c, cert-msc51-cpp)
+    std::uniform_int_distribution<uint64_t> dist{0, size / 2};
+
+    std::vector<uint64_t> data;
+    data.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data.push_back(dist(gen));
+    }
+    return data;
+}
+
+TEST_CASE("Parallel sort of small range") {
+    osmium::thread::Pool pool{4};
+
+    std::vector<uint64_t> data = {5, 3, 9, 1, 3};
+    osmium::thread::parallel_sort(pool, data.begin(), data.end());
+    REQUIRE(std::is_sorted(data.begin(), data.end()));
+}
+
+TEST_CASE("Parallel sort of large range") {
+    auto data = random_data(1000000);
+    auto expected = data;
+    std::sort(expected.begin(), expected.end());
+
+    int num_threads = GENERATE(2, 3, 4, 7);
+    osmium::thread::Pool pool{num_threads};
+
+    SECTION("in memory") {
+        osmium::thread::parallel_sort(pool, data.begin(), data.end());
+        REQUIRE(data == expected);
+    }
+
+    SECTION("with temporary file") {
+        osmium::thread::parallel_sort_external(pool, data.begin(), data.end());
+        REQUIRE(data == expected);
+    }
+
+    SECTION("with comparison function") {
+        osmium::thread::parallel_sort(pool, data.begin(), data.end(), std::greater<uint64_t>{});
+        std::reverse(expected.begin(), expected.end());
+        REQUIRE(data == expected);
+    }
+}
+
+TEST_CASE("Sort multimaps with pool") {
+    osmium::thread::Pool pool{4};
+
+    const auto data = random_data(200000);
+
+    SECTION("in memory") {
+        osmium::index::multimap::SparseMemArray<uint64_t, uint64_t> map;
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            map.unsorted_set(data[i], i + 1);
+        }
+        map.sort(pool);
+        REQUIRE(map.size() == data.size());
+        REQUIRE(std::is_sorted(map.cbegin(), map.cend()));
+    }
+
+    SECTION("in file") {
+        osmium::index::multimap::SparseFileArray<uint64_t, uint64_t> map;
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            map.unsorted_set(data[i], i + 1);
+        }
+        map.consolidate(pool);
+        REQUIRE(map.size() == data.size());
+        REQUIRE(std::is_sorted(map.cbegin(), map.cend()));
+    }
+}
@@ -0,0 +1,56 @@
+#include "catch.hpp"
+
+#include <osmium/thread/stats.hpp>
+
+#include <chrono>
+
+TEST_CASE("Buckets of duration histogram") {
+    using osmium::thread::duration_histogram;
+    REQUIRE(duration_histogram::bucket(std::chrono::nanoseconds{0}) == 0);
+    REQUIRE(duration_histogram::bucket(std::chrono::nanoseconds{999}) == 0);
+    REQUIRE(duration_histogram::bucket(std::chrono::microseconds{1}) == 1);
+    REQUIRE(duration_histogram::bucket(std::chrono::microseconds{3}) == 2);
+    REQUIRE(duration_histogram::bucket(std::chrono::microseconds{4}) == 3);
+    REQUIRE(duration_histogram::bucket(std::chrono::hours{10}) == duration_histogram::num_buckets - 1);
+
+    REQUIRE(duration_histogram::upper_bound(0) == std::chrono::microseconds{1});
+    REQUIRE(duration_histogram::upper_bound(3) == std::chrono::microseconds{8});
+    REQUIRE(duration_histogram::upper_bound(duration_histogram::num_buckets - 1) == std::chrono::nanoseconds::max());
+}
+
+TEST_CASE("Percentiles of duration histogram") {
+    osmium::thread::detail::atomic_duration_histogram counters;
+    REQUIRE(counters.histogram().total() == 0);
+    REQUIRE(counters.histogram().percentile(0.5).count() == 0);
+
+    for (int i = 0; i < 9; ++i) {
+        counters.add(std::chrono::microseconds{5});
+    }
+    counters.add(std::chrono::milliseconds{3});
+
+    const auto histogram = counters.histogram();
+    REQUIRE(histogram.total() == 10);
+    REQUIRE(histogram.count(3) == 9);
+    REQUIRE(histogram.percentile(0.5) == std::chrono::microseconds{8});
+    REQUIRE(histogram.percentile(0.95) == std::chrono::microseconds{4096});
+    REQUIRE(counters.sum() == std::chrono::microseconds{3045});
+}
+
+TEST_CASE("Throughput counter") {
+    osmium::thread::detail::throughput_counter counter;
+    counter.add(100);
+    counter.add(50);
+
+    const auto stats = counter.stats();
+    REQUIRE(stats.blocks == 2);
+    REQUIRE(stats.bytes == 150);
+    REQUIRE(stats.elapsed.count() >= 0);
+
+    osmium::thread::throughput_stats fixed;
+    fixed.blocks = 10;
+    fixed.bytes = 1000;
+    REQUIRE(fixed.bytes_per_second() == Approx(0.0));
+    fixed.elapsed = std::chrono::seconds{2};
+    REQUIRE(fixed.blocks_per_second() == Approx(5.0));
+    REQUIRE(fixed.bytes_per_second() == Approx(500.0));
+}